@@ -0,0 +1,377 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "haptic_asset.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "haptic_processor.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+static constexpr char kMagic[4] = {'G', 'C', 'H', 'A'};
+static constexpr std::size_t kHeaderBytes = 24;
+static constexpr std::size_t kEntryBytes = 32;
+
+static constexpr std::uint8_t kCompressionNone = 0;
+static constexpr std::uint8_t kCompressionZeroRle = 1;
+
+// Device codes on disk, independent of the enum's values.
+static std::uint8_t device_code(EDSDeviceType DeviceType)
+{
+	switch (DeviceType)
+	{
+		case EDSDeviceType::DualSense: return 1;
+		case EDSDeviceType::DualSenseEdge: return 2;
+		case EDSDeviceType::DualShock4: return 3;
+		default: return 0;
+	}
+}
+
+static bool device_from_code(std::uint8_t Code, EDSDeviceType& Out)
+{
+	switch (Code)
+	{
+		case 1: Out = EDSDeviceType::DualSense; return true;
+		case 2: Out = EDSDeviceType::DualSenseEdge; return true;
+		case 3: Out = EDSDeviceType::DualShock4; return true;
+		default: return false;
+	}
+}
+
+static void put_le(std::vector<std::uint8_t>& Out, std::uint64_t Value, std::size_t Bytes)
+{
+	for (std::size_t i = 0; i < Bytes; ++i)
+	{
+		Out.push_back(static_cast<std::uint8_t>(Value >> (i * 8)));
+	}
+}
+
+static std::uint64_t get_le(const std::uint8_t* In, std::size_t Bytes)
+{
+	std::uint64_t Value = 0;
+	for (std::size_t i = 0; i < Bytes; ++i)
+	{
+		Value |= static_cast<std::uint64_t>(In[i]) << (i * 8);
+	}
+	return Value;
+}
+
+static std::uint32_t fnv1a(const std::vector<std::uint8_t>& Bytes)
+{
+	std::uint32_t Hash = 2166136261u;
+	for (const std::uint8_t Byte : Bytes)
+	{
+		Hash = (Hash ^ Byte) * 16777619u;
+	}
+	return Hash;
+}
+
+// Zero-run RLE. A control byte 0x00-0x7F is followed by that many plus one literal bytes;
+// 0x80-0xFF stands for (control - 0x7F) zero bytes.
+static std::vector<std::uint8_t> compress_zero_rle(const std::vector<std::uint8_t>& In)
+{
+	std::vector<std::uint8_t> Out;
+	std::size_t i = 0;
+	while (i < In.size())
+	{
+		if (In[i] == 0)
+		{
+			std::size_t Run = 1;
+			while (Run < 128 && i + Run < In.size() && In[i + Run] == 0)
+			{
+				++Run;
+			}
+			Out.push_back(static_cast<std::uint8_t>(0x7F + Run));
+			i += Run;
+			continue;
+		}
+		// Literals until a pair of zeros, where a zero run starts to pay off.
+		std::size_t Run = 1;
+		while (Run < 128 && i + Run < In.size() && !(In[i + Run] == 0 && i + Run + 1 < In.size() && In[i + Run + 1] == 0))
+		{
+			++Run;
+		}
+		Out.push_back(static_cast<std::uint8_t>(Run - 1));
+		Out.insert(Out.end(), In.begin() + static_cast<std::ptrdiff_t>(i), In.begin() + static_cast<std::ptrdiff_t>(i + Run));
+		i += Run;
+	}
+	return Out;
+}
+
+static bool decompress_zero_rle(const std::uint8_t* In, std::size_t Size, std::size_t Expected, std::vector<std::uint8_t>& Out)
+{
+	Out.clear();
+	Out.reserve(Expected);
+	std::size_t i = 0;
+	while (i < Size)
+	{
+		const std::uint8_t Control = In[i++];
+		if (Control >= 0x80)
+		{
+			Out.insert(Out.end(), Control - 0x7Fu, 0);
+		}
+		else
+		{
+			const std::size_t Run = Control + 1u;
+			if (i + Run > Size)
+			{
+				return false;
+			}
+			Out.insert(Out.end(), In + i, In + i + Run);
+			i += Run;
+		}
+		if (Out.size() > Expected)
+		{
+			return false;
+		}
+	}
+	return Out.size() == Expected;
+}
+
+bool haptic_asset::load(const std::string& Path, std::string& Error)
+{
+	Streams.clear();
+	std::ifstream File(Path, std::ios::binary);
+	if (!File)
+	{
+		Error = "cannot open " + Path;
+		return false;
+	}
+	const std::vector<std::uint8_t> Bytes((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+
+	if (Bytes.size() < kHeaderBytes || std::memcmp(Bytes.data(), kMagic, sizeof(kMagic)) != 0)
+	{
+		Error = "not a haptic asset";
+		return false;
+	}
+	const std::uint16_t Version = static_cast<std::uint16_t>(get_le(&Bytes[4], 2));
+	const std::size_t HeaderBytes = get_le(&Bytes[6], 2);
+	const std::size_t EntryBytes = get_le(&Bytes[8], 2);
+	const std::size_t StreamCount = get_le(&Bytes[10], 2);
+	if (Version == 0 || Version > kVersion)
+	{
+		Error = "haptic asset version " + std::to_string(Version) + " is newer than this build (" + std::to_string(kVersion) + ")";
+		return false;
+	}
+	if (HeaderBytes < kHeaderBytes || EntryBytes < kEntryBytes || HeaderBytes + StreamCount * EntryBytes > Bytes.size())
+	{
+		Error = "truncated haptic asset header";
+		return false;
+	}
+	SourceSampleRate = static_cast<std::uint32_t>(get_le(&Bytes[12], 4));
+	SourceFrames = get_le(&Bytes[16], 8);
+
+	for (std::size_t s = 0; s < StreamCount; ++s)
+	{
+		const std::uint8_t* Entry = &Bytes[HeaderBytes + s * EntryBytes];
+		haptic_asset_stream Stream;
+		const std::uint8_t Transport = Entry[1];
+		if (!device_from_code(Entry[0], Stream.DeviceType) || Transport > static_cast<std::uint8_t>(haptic_asset_transport::Usb))
+		{
+			// Written by a newer converter for hardware this build does not know; not an error.
+			continue;
+		}
+		Stream.Transport = static_cast<haptic_asset_transport>(Transport);
+		const std::uint8_t Compression = Entry[2];
+		const std::uint64_t Units = get_le(Entry + 4, 4);
+		const std::uint64_t Offset = get_le(Entry + 8, 8);
+		const std::uint64_t Stored = get_le(Entry + 16, 8);
+		const std::uint32_t Checksum = static_cast<std::uint32_t>(get_le(Entry + 24, 4));
+		const std::size_t Expected = static_cast<std::size_t>(Units) * haptic_asset_stream::unit_bytes(Stream.Transport);
+		if (Offset > Bytes.size() || Stored > Bytes.size() - Offset)
+		{
+			Error = "stream " + std::to_string(s) + " lies outside the file";
+			return false;
+		}
+
+		const std::uint8_t* Payload = &Bytes[static_cast<std::size_t>(Offset)];
+		bool bDecoded = false;
+		if (Compression == kCompressionNone)
+		{
+			bDecoded = Stored == Expected;
+			Stream.Payload.assign(Payload, Payload + Stored);
+		}
+		else if (Compression == kCompressionZeroRle)
+		{
+			bDecoded = decompress_zero_rle(Payload, static_cast<std::size_t>(Stored), Expected, Stream.Payload);
+		}
+		if (!bDecoded || fnv1a(Stream.Payload) != Checksum)
+		{
+			Error = "stream " + std::to_string(s) + " is corrupt or uses an unknown compression";
+			return false;
+		}
+		Streams.push_back(std::move(Stream));
+	}
+	return true;
+}
+
+bool haptic_asset::save(const std::string& Path, bool bCompress, std::string& Error) const
+{
+	std::vector<std::uint8_t> Header;
+	Header.insert(Header.end(), std::begin(kMagic), std::end(kMagic));
+	put_le(Header, kVersion, 2);
+	put_le(Header, kHeaderBytes, 2);
+	put_le(Header, kEntryBytes, 2);
+	put_le(Header, Streams.size(), 2);
+	put_le(Header, SourceSampleRate, 4);
+	put_le(Header, SourceFrames, 8);
+
+	std::vector<std::uint8_t> Data;
+	std::size_t Offset = kHeaderBytes + Streams.size() * kEntryBytes;
+	for (std::size_t s = 0; s < Streams.size(); ++s)
+	{
+		const haptic_asset_stream& Stream = Streams[s];
+		std::vector<std::uint8_t> Stored = bCompress ? compress_zero_rle(Stream.Payload) : std::vector<std::uint8_t>();
+		const bool bCompressed = bCompress && Stored.size() < Stream.Payload.size();
+		if (!bCompressed)
+		{
+			Stored = Stream.Payload;
+		}
+
+		// Controllers that render identically (DualSense and Edge share actuators) share bytes.
+		std::size_t StreamOffset = Offset + Data.size();
+		for (std::size_t Previous = 0; Previous < s; ++Previous)
+		{
+			if (Streams[Previous].Payload == Stream.Payload)
+			{
+				StreamOffset = static_cast<std::size_t>(get_le(&Header[kHeaderBytes + Previous * kEntryBytes + 8], 8));
+				break;
+			}
+		}
+		if (StreamOffset == Offset + Data.size())
+		{
+			Data.insert(Data.end(), Stored.begin(), Stored.end());
+		}
+
+		Header.push_back(device_code(Stream.DeviceType));
+		Header.push_back(static_cast<std::uint8_t>(Stream.Transport));
+		Header.push_back(bCompressed ? kCompressionZeroRle : kCompressionNone);
+		Header.push_back(0);
+		put_le(Header, Stream.units(), 4);
+		put_le(Header, StreamOffset, 8);
+		put_le(Header, Stored.size(), 8);
+		put_le(Header, fnv1a(Stream.Payload), 4);
+		put_le(Header, 0, 4);
+	}
+
+	std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+	File.write(reinterpret_cast<const char*>(Header.data()), static_cast<std::streamsize>(Header.size()));
+	File.write(reinterpret_cast<const char*>(Data.data()), static_cast<std::streamsize>(Data.size()));
+	if (!File)
+	{
+		Error = "cannot write " + Path;
+		return false;
+	}
+	return true;
+}
+
+const haptic_asset_stream* haptic_asset::find(EDSDeviceType DeviceType, haptic_asset_transport Transport) const
+{
+	for (const haptic_asset_stream& Stream : Streams)
+	{
+		if (Stream.DeviceType == DeviceType && Stream.Transport == Transport)
+		{
+			return &Stream;
+		}
+	}
+	return nullptr;
+}
+
+haptic_asset_stream haptic_asset_render(const float* Interleaved, std::size_t Frames, std::uint32_t SampleRate, EDSDeviceType DeviceType,
+                                        haptic_asset_transport Transport)
+{
+	haptic_asset_stream Stream;
+	Stream.DeviceType = DeviceType;
+	Stream.Transport = Transport;
+	const bool bUsb = Transport == haptic_asset_transport::Usb;
+	if (SampleRate == 0 || (bUsb && SampleRate != 48000))
+	{
+		return Stream;
+	}
+
+	haptic_processor_config Config = haptic_processor_config::for_device(DeviceType);
+	Config.InputSampleRate = SampleRate;
+	auto Processor = std::make_unique<haptic_processor>(Config);
+	auto UsbRing = std::make_unique<haptic_usb_ring>();
+	auto BtRing = std::make_unique<haptic_bt_ring>();
+
+	// Small enough that one step never overflows either ring before it is drained.
+	constexpr std::size_t kStepFrames = 1024;
+	const std::size_t PaddingFrames = bUsb ? 0 : haptic_bt_packet::kFrames * (SampleRate / haptic_processor::kBtSampleRate + 1);
+	const std::vector<float> Silence(kStepFrames * 2, 0.0f);
+	haptic_usb_frame UsbFrames[kStepFrames];
+	haptic_bt_packet Packet;
+	for (std::size_t First = 0, Count = 0; First < Frames + PaddingFrames; First += Count)
+	{
+		const float* Block = First < Frames ? &Interleaved[First * 2] : Silence.data();
+		Count = std::min(kStepFrames, First < Frames ? Frames - First : Frames + PaddingFrames - First);
+		if (bUsb)
+		{
+			Processor->process_usb(Block, Count, *UsbRing);
+			const std::size_t Popped = UsbRing->pop(UsbFrames, kStepFrames);
+			for (std::size_t i = 0; i < Popped; ++i)
+			{
+				put_le(Stream.Payload, static_cast<std::uint16_t>(UsbFrames[i].Left), 2);
+				put_le(Stream.Payload, static_cast<std::uint16_t>(UsbFrames[i].Right), 2);
+			}
+		}
+		else
+		{
+			Processor->process_bt(Block, Count, *BtRing);
+			while (BtRing->try_pop(Packet))
+			{
+				Stream.Payload.insert(Stream.Payload.end(), std::begin(Packet.Data), std::end(Packet.Data));
+			}
+		}
+	}
+	return Stream;
+}
+
+haptic_asset_player::haptic_asset_player(const haptic_asset_stream& InStream)
+    : Stream(InStream)
+{
+}
+
+std::size_t haptic_asset_player::due(double ElapsedSeconds) const
+{
+	// 3000 Hz / 32 frames per packet, or 48000 frames per second.
+	const double Rate = Stream.Transport == haptic_asset_transport::Bluetooth ? 3000.0 / 32.0 : 48000.0;
+	const double Units = std::max(0.0, ElapsedSeconds) * Rate;
+	return std::min(Stream.units(), static_cast<std::size_t>(Units));
+}
+
+bool haptic_asset_player::pop_due_packet(double ElapsedSeconds, std::vector<std::uint8_t>& Packet)
+{
+	if (Stream.Transport != haptic_asset_transport::Bluetooth || Next >= due(ElapsedSeconds))
+	{
+		return false;
+	}
+	const std::uint8_t* First = &Stream.Payload[Next * haptic_bt_packet::kBytes];
+	Packet.assign(First, First + haptic_bt_packet::kBytes);
+	++Next;
+	return true;
+}
+
+std::size_t haptic_asset_player::pop_due_frames(double ElapsedSeconds, std::vector<std::int16_t>& Samples)
+{
+	Samples.clear();
+	if (Stream.Transport != haptic_asset_transport::Usb)
+	{
+		return 0;
+	}
+	const std::size_t Due = due(ElapsedSeconds);
+	if (Due <= Next)
+	{
+		return 0;
+	}
+	const std::size_t Frames = Due - Next;
+	Samples.resize(Frames * 2);
+	const std::uint8_t* In = &Stream.Payload[Next * 4];
+	for (std::size_t i = 0; i < Frames * 2; ++i)
+	{
+		Samples[i] = static_cast<std::int16_t>(get_le(In + i * 2, 2));
+	}
+	Next += Frames;
+	return Frames;
+}
+#endif
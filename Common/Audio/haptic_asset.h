@@ -0,0 +1,94 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/ECoreGamepad.h"
+#include "haptic_frames.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class haptic_asset_transport : std::uint8_t
+{
+	// haptic_bt_packet payloads, 64 bytes of int8 stereo at 3000 Hz each.
+	Bluetooth = 0,
+	// int16 stereo frames at 48 kHz, little-endian.
+	Usb = 1
+};
+
+// One pre-rendered stream: exactly what haptic_processor would have produced for this controller
+// and transport, ready for AudioHapticUpdate.
+struct haptic_asset_stream
+{
+	EDSDeviceType DeviceType = EDSDeviceType::DualSense;
+	haptic_asset_transport Transport = haptic_asset_transport::Bluetooth;
+	std::vector<std::uint8_t> Payload;
+
+	// Bluetooth packets or USB frames.
+	std::size_t units() const { return Payload.size() / unit_bytes(Transport); }
+	static std::size_t unit_bytes(haptic_asset_transport Transport) { return Transport == haptic_asset_transport::Bluetooth ? haptic_bt_packet::kBytes : sizeof(haptic_usb_frame); }
+};
+
+/**
+ * @brief Pre-rendered haptics: a versioned file of per-controller packet streams.
+ *
+ * Canned effects are resampled, filtered and quantized once by haptic-asset-converter instead of
+ * on every playback. The file is a fixed little-endian header ("GCHA", version, header and entry
+ * sizes, stream count, source rate and length) followed by one table entry per stream (device,
+ * transport, compression, unit count, offset, stored size, FNV-1a of the payload) and the
+ * payloads. Identical payloads are stored once. Streams may be zero-run-length compressed, which
+ * suits the long silences of haptic clips; the writer only keeps compression where it helps.
+ * Readers accept any version up to kVersion and skip header and entry bytes they do not know.
+ * load() decompresses and verifies everything up front so playback is plain copying.
+ */
+class haptic_asset
+{
+public:
+	static constexpr std::uint16_t kVersion = 1;
+
+	std::uint32_t SourceSampleRate = 0;
+	std::uint64_t SourceFrames = 0;
+	std::vector<haptic_asset_stream> Streams;
+
+	// False with Error set when the file is missing, corrupt or from a newer format version.
+	bool load(const std::string& Path, std::string& Error);
+	bool save(const std::string& Path, bool bCompress, std::string& Error) const;
+
+	// Stream for this controller and transport, or nullptr.
+	const haptic_asset_stream* find(EDSDeviceType DeviceType, haptic_asset_transport Transport) const;
+};
+
+// Runs Frames of interleaved stereo float at SampleRate through haptic_processor configured for
+// DeviceType, the way live playback would, and collects the result. Bluetooth is padded with
+// silence so the last partial packet and the filter tail are included. USB needs 48 kHz input;
+// other rates give an empty stream.
+haptic_asset_stream haptic_asset_render(const float* Interleaved, std::size_t Frames, std::uint32_t SampleRate, EDSDeviceType DeviceType,
+                                        haptic_asset_transport Transport);
+
+/**
+ * @brief Plays a haptic_asset_stream into AudioHapticUpdate-shaped buffers at its native rate.
+ *
+ * pop_due_packet() and pop_due_frames() hand out what became due since the start, given the
+ * elapsed time, so a worker polling every few milliseconds stays in step with the clock instead of
+ * drifting.
+ */
+class haptic_asset_player
+{
+public:
+	explicit haptic_asset_player(const haptic_asset_stream& InStream);
+
+	// Bluetooth: the next due packet into Packet (haptic_bt_packet::kBytes). False when none is due yet or the stream ended.
+	bool pop_due_packet(double ElapsedSeconds, std::vector<std::uint8_t>& Packet);
+	// USB: all frames due by ElapsedSeconds, as interleaved samples, replacing Samples. Returns frames.
+	std::size_t pop_due_frames(double ElapsedSeconds, std::vector<std::int16_t>& Samples);
+
+	bool finished() const { return Next >= Stream.units(); }
+
+private:
+	std::size_t due(double ElapsedSeconds) const;
+
+	const haptic_asset_stream& Stream;
+	std::size_t Next = 0;
+};
+#endif
@@ -0,0 +1,126 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "haptic_biquad.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAMEPAD_CORE_BIQUAD_SSE2 1
+#endif
+
+static constexpr double kPi = 3.14159265358979323846;
+
+haptic_biquad_bank::haptic_biquad_bank(const haptic_filter_preset& Preset, float SampleRate)
+    : Count(std::min(Preset.Count, haptic_filter_preset::kMaxStages))
+{
+	for (std::size_t s = 0; s < Count; ++s)
+	{
+		const haptic_filter_stage& Stage = Preset.Stages[s];
+		const double Frequency = std::clamp(static_cast<double>(Stage.Frequency), 1.0, 0.45 * SampleRate);
+		const double Omega = 2.0 * kPi * Frequency / SampleRate;
+		const double Alpha = std::sin(Omega) / (2.0 * std::max(static_cast<double>(Stage.Q), 0.1));
+		const double Cos = std::cos(Omega);
+
+		double B[3] = {};
+		switch (Stage.Kind)
+		{
+			case haptic_filter_kind::HighPass:
+				B[0] = (1.0 + Cos) / 2.0;
+				B[1] = -(1.0 + Cos);
+				B[2] = B[0];
+				break;
+			case haptic_filter_kind::LowPass:
+				B[0] = (1.0 - Cos) / 2.0;
+				B[1] = 1.0 - Cos;
+				B[2] = B[0];
+				break;
+			case haptic_filter_kind::BandPass:
+				// Constant 0 dB peak gain.
+				B[0] = Alpha;
+				B[1] = 0.0;
+				B[2] = -Alpha;
+				break;
+		}
+		const double A0 = 1.0 + Alpha;
+		const double Normalized[kCoefficientCount] = {B[0] / A0, B[1] / A0, B[2] / A0, -2.0 * Cos / A0, (1.0 - Alpha) / A0};
+		for (int c = 0; c < kCoefficientCount; ++c)
+		{
+			std::fill(std::begin(Coefficients[s][c]), std::end(Coefficients[s][c]), static_cast<float>(Normalized[c]));
+		}
+	}
+}
+
+void haptic_biquad_bank::reset()
+{
+	std::memset(State, 0, sizeof(State));
+}
+
+void haptic_biquad_bank::process(float* Interleaved, std::size_t Frames)
+{
+	if (Count == 0)
+	{
+		return;
+	}
+#if defined(GAMEPAD_CORE_BIQUAD_SSE2)
+	__m128 Z1[haptic_filter_preset::kMaxStages];
+	__m128 Z2[haptic_filter_preset::kMaxStages];
+	for (std::size_t s = 0; s < Count; ++s)
+	{
+		Z1[s] = _mm_load_ps(State[s][0]);
+		Z2[s] = _mm_load_ps(State[s][1]);
+	}
+	for (std::size_t i = 0; i < Frames; ++i)
+	{
+		// One frame, left and right, into the two low lanes. The 64-bit integer load and store
+		// have no alignment requirement and may alias the floats.
+		__m128i* Frame = reinterpret_cast<__m128i*>(Interleaved + i * 2);
+		__m128 X = _mm_castsi128_ps(_mm_loadl_epi64(Frame));
+		for (std::size_t s = 0; s < Count; ++s)
+		{
+			const float(*C)[4] = Coefficients[s];
+			const __m128 Y = _mm_add_ps(_mm_mul_ps(_mm_load_ps(C[kB0]), X), Z1[s]);
+			Z1[s] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_load_ps(C[kB1]), X), _mm_mul_ps(_mm_load_ps(C[kA1]), Y)), Z2[s]);
+			Z2[s] = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(C[kB2]), X), _mm_mul_ps(_mm_load_ps(C[kA2]), Y));
+			X = Y;
+		}
+		_mm_storel_epi64(Frame, _mm_castps_si128(X));
+	}
+	for (std::size_t s = 0; s < Count; ++s)
+	{
+		_mm_store_ps(State[s][0], Z1[s]);
+		_mm_store_ps(State[s][1], Z2[s]);
+	}
+#else
+	for (std::size_t i = 0; i < Frames; ++i)
+	{
+		for (std::size_t Channel = 0; Channel < 2; ++Channel)
+		{
+			float X = Interleaved[i * 2 + Channel];
+			for (std::size_t s = 0; s < Count; ++s)
+			{
+				const float(*C)[4] = Coefficients[s];
+				float& Z1 = State[s][0][Channel];
+				float& Z2 = State[s][1][Channel];
+				const float Y = C[kB0][0] * X + Z1;
+				Z1 = C[kB1][0] * X - C[kA1][0] * Y + Z2;
+				Z2 = C[kB2][0] * X - C[kA2][0] * Y;
+				X = Y;
+			}
+			Interleaved[i * 2 + Channel] = X;
+		}
+	}
+#endif
+}
+
+const char* haptic_biquad_bank::simd_path()
+{
+#if defined(GAMEPAD_CORE_BIQUAD_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
+#endif
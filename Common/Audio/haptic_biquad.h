@@ -0,0 +1,106 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include <cstddef>
+#include <cstdint>
+
+enum class haptic_filter_kind : std::uint8_t
+{
+	HighPass,
+	LowPass,
+	BandPass
+};
+
+// One second-order section, in Hz; the sample rate is supplied when the bank is built.
+struct haptic_filter_stage
+{
+	haptic_filter_kind Kind = haptic_filter_kind::HighPass;
+	float Frequency = 0.0f;
+	float Q = 0.70710678f;
+};
+
+/**
+ * @brief A cascade of up to kMaxStages biquads, described independently of the sample rate so the
+ * same preset can be designed for the 48 kHz USB path and the 3 kHz Bluetooth one.
+ */
+struct haptic_filter_preset
+{
+	static constexpr std::size_t kMaxStages = 4;
+
+	haptic_filter_stage Stages[kMaxStages] = {};
+	std::size_t Count = 0;
+
+	static constexpr haptic_filter_preset flat();
+	static constexpr haptic_filter_preset high_pass(float Frequency, float Q = 0.70710678f);
+	static constexpr haptic_filter_preset low_pass(float Frequency, float Q = 0.70710678f);
+	// Butterworth high-pass at Low followed by a Butterworth low-pass at High.
+	static constexpr haptic_filter_preset band_pass(float Low, float High);
+};
+
+constexpr haptic_filter_preset haptic_filter_preset::flat()
+{
+	return haptic_filter_preset();
+}
+
+constexpr haptic_filter_preset haptic_filter_preset::high_pass(float Frequency, float Q)
+{
+	haptic_filter_preset Preset;
+	Preset.Stages[0] = {haptic_filter_kind::HighPass, Frequency, Q};
+	Preset.Count = 1;
+	return Preset;
+}
+
+constexpr haptic_filter_preset haptic_filter_preset::low_pass(float Frequency, float Q)
+{
+	haptic_filter_preset Preset;
+	Preset.Stages[0] = {haptic_filter_kind::LowPass, Frequency, Q};
+	Preset.Count = 1;
+	return Preset;
+}
+
+constexpr haptic_filter_preset haptic_filter_preset::band_pass(float Low, float High)
+{
+	haptic_filter_preset Preset;
+	Preset.Stages[0] = {haptic_filter_kind::HighPass, Low, 0.70710678f};
+	Preset.Stages[1] = {haptic_filter_kind::LowPass, High, 0.70710678f};
+	Preset.Count = 2;
+	return Preset;
+}
+
+/**
+ * @brief Cascaded biquads over interleaved stereo float, processed in place.
+ *
+ * Coefficients (RBJ cookbook, designed in double) are computed once in the constructor. Each
+ * stage runs in transposed direct form II with the left and right channels in the two low lanes
+ * of one SSE register, so a frame costs one multiply-add chain per stage for both channels; a
+ * scalar loop does the same elsewhere. An empty bank returns without touching the samples.
+ * Nothing allocates.
+ */
+class haptic_biquad_bank
+{
+public:
+	haptic_biquad_bank() = default;
+	// Frequencies are clamped to [1 Hz, 0.45 * SampleRate].
+	haptic_biquad_bank(const haptic_filter_preset& Preset, float SampleRate);
+
+	void reset();
+
+	void process(float* Interleaved, std::size_t Frames);
+
+	bool empty() const { return Count == 0; }
+	std::size_t stages() const { return Count; }
+
+	// "sse2" or "scalar": the path this build uses.
+	static const char* simd_path();
+
+private:
+	// B0, B1, B2, A1, A2 (A0 normalized to 1), each broadcast to four lanes.
+	enum { kB0, kB1, kB2, kA1, kA2, kCoefficientCount };
+
+	std::size_t Count = 0;
+	alignas(16) float Coefficients[haptic_filter_preset::kMaxStages][kCoefficientCount][4] = {};
+	// Z1 and Z2 per stage; lane 0 is left, lane 1 right.
+	alignas(16) float State[haptic_filter_preset::kMaxStages][2][4] = {};
+};
+#endif
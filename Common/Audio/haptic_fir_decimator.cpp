@@ -0,0 +1,153 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "haptic_fir_decimator.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GAMEPAD_CORE_FIR_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAMEPAD_CORE_FIR_SSE2 1
+#endif
+
+// Kaiser window shape; 8 gives about 80 dB of stopband attenuation.
+static constexpr double kKaiserBeta = 8.0;
+static constexpr double kPi = 3.14159265358979323846;
+
+// Zeroth-order modified Bessel function of the first kind, by its power series.
+static double bessel_i0(double X)
+{
+	double Sum = 1.0;
+	double Term = 1.0;
+	for (int k = 1; k < 64; ++k)
+	{
+		Term *= (X / (2.0 * k)) * (X / (2.0 * k));
+		Sum += Term;
+		if (Term < Sum * 1e-12)
+		{
+			break;
+		}
+	}
+	return Sum;
+}
+
+// Taps is always a multiple of kTapsPerPhase (16), so no loop needs a remainder.
+static float dot(const float* Coefficients, const float* Samples, std::size_t Taps)
+{
+#if defined(GAMEPAD_CORE_FIR_AVX2)
+	__m256 Sum0 = _mm256_setzero_ps();
+	__m256 Sum1 = _mm256_setzero_ps();
+	for (std::size_t i = 0; i < Taps; i += 16)
+	{
+#if defined(__FMA__)
+		Sum0 = _mm256_fmadd_ps(_mm256_load_ps(Coefficients + i), _mm256_loadu_ps(Samples + i), Sum0);
+		Sum1 = _mm256_fmadd_ps(_mm256_load_ps(Coefficients + i + 8), _mm256_loadu_ps(Samples + i + 8), Sum1);
+#else
+		Sum0 = _mm256_add_ps(Sum0, _mm256_mul_ps(_mm256_load_ps(Coefficients + i), _mm256_loadu_ps(Samples + i)));
+		Sum1 = _mm256_add_ps(Sum1, _mm256_mul_ps(_mm256_load_ps(Coefficients + i + 8), _mm256_loadu_ps(Samples + i + 8)));
+#endif
+	}
+	const __m256 Sum = _mm256_add_ps(Sum0, Sum1);
+	__m128 Half = _mm_add_ps(_mm256_castps256_ps128(Sum), _mm256_extractf128_ps(Sum, 1));
+	Half = _mm_add_ps(Half, _mm_movehl_ps(Half, Half));
+	Half = _mm_add_ss(Half, _mm_shuffle_ps(Half, Half, 1));
+	return _mm_cvtss_f32(Half);
+#elif defined(GAMEPAD_CORE_FIR_SSE2)
+	// Four accumulators hide the add latency; SSE2 has no fused multiply-add.
+	__m128 Sum0 = _mm_setzero_ps();
+	__m128 Sum1 = _mm_setzero_ps();
+	__m128 Sum2 = _mm_setzero_ps();
+	__m128 Sum3 = _mm_setzero_ps();
+	for (std::size_t i = 0; i < Taps; i += 16)
+	{
+		Sum0 = _mm_add_ps(Sum0, _mm_mul_ps(_mm_load_ps(Coefficients + i), _mm_loadu_ps(Samples + i)));
+		Sum1 = _mm_add_ps(Sum1, _mm_mul_ps(_mm_load_ps(Coefficients + i + 4), _mm_loadu_ps(Samples + i + 4)));
+		Sum2 = _mm_add_ps(Sum2, _mm_mul_ps(_mm_load_ps(Coefficients + i + 8), _mm_loadu_ps(Samples + i + 8)));
+		Sum3 = _mm_add_ps(Sum3, _mm_mul_ps(_mm_load_ps(Coefficients + i + 12), _mm_loadu_ps(Samples + i + 12)));
+	}
+	__m128 Sum = _mm_add_ps(_mm_add_ps(Sum0, Sum1), _mm_add_ps(Sum2, Sum3));
+	Sum = _mm_add_ps(Sum, _mm_movehl_ps(Sum, Sum));
+	Sum = _mm_add_ss(Sum, _mm_shuffle_ps(Sum, Sum, 1));
+	return _mm_cvtss_f32(Sum);
+#else
+	float Sum[4] = {};
+	for (std::size_t i = 0; i < Taps; i += 4)
+	{
+		Sum[0] += Coefficients[i] * Samples[i];
+		Sum[1] += Coefficients[i + 1] * Samples[i + 1];
+		Sum[2] += Coefficients[i + 2] * Samples[i + 2];
+		Sum[3] += Coefficients[i + 3] * Samples[i + 3];
+	}
+	return (Sum[0] + Sum[1]) + (Sum[2] + Sum[3]);
+#endif
+}
+
+haptic_fir_decimator::haptic_fir_decimator(std::uint32_t InFactor, float Cutoff)
+    : Factor(std::clamp<std::uint32_t>(InFactor, 1, kMaxFactor))
+    , Taps(Factor * kTapsPerPhase)
+{
+	// Windowed sinc at Cutoff of the output rate, normalized to unity gain at DC.
+	const double Fc = static_cast<double>(Cutoff) / Factor;
+	const double Center = (static_cast<double>(Taps) - 1.0) / 2.0;
+	const double Normalizer = bessel_i0(kKaiserBeta);
+	double Sum = 0.0;
+	double Designed[kMaxTaps];
+	for (std::size_t n = 0; n < Taps; ++n)
+	{
+		const double X = static_cast<double>(n) - Center;
+		const double Sinc = X == 0.0 ? 2.0 * Fc : std::sin(2.0 * kPi * Fc * X) / (kPi * X);
+		const double Ratio = X / Center;
+		const double Window = bessel_i0(kKaiserBeta * std::sqrt(std::max(0.0, 1.0 - Ratio * Ratio))) / Normalizer;
+		Designed[n] = Sinc * Window;
+		Sum += Designed[n];
+	}
+	// Symmetric, so the oldest-first history lines up with the coefficients without reversing.
+	for (std::size_t n = 0; n < Taps; ++n)
+	{
+		Coefficients[n] = static_cast<float>(Designed[n] / Sum);
+	}
+}
+
+void haptic_fir_decimator::reset()
+{
+	Countdown = 1;
+	Write = 0;
+	std::fill(std::begin(HistoryLeft), std::end(HistoryLeft), 0.0f);
+	std::fill(std::begin(HistoryRight), std::end(HistoryRight), 0.0f);
+}
+
+std::size_t haptic_fir_decimator::process(const float* In, std::size_t InFrames, float* Out)
+{
+	std::size_t Written = 0;
+	for (std::size_t i = 0; i < InFrames; ++i)
+	{
+		HistoryLeft[Write] = HistoryLeft[Write + Taps] = In[i * 2];
+		HistoryRight[Write] = HistoryRight[Write + Taps] = In[i * 2 + 1];
+		Write = Write + 1 == Taps ? 0 : Write + 1;
+
+		if (--Countdown == 0)
+		{
+			// The last Taps samples, oldest first, start at Write.
+			Out[Written * 2] = dot(Coefficients, &HistoryLeft[Write], Taps);
+			Out[Written * 2 + 1] = dot(Coefficients, &HistoryRight[Write], Taps);
+			++Written;
+			Countdown = Factor;
+		}
+	}
+	return Written;
+}
+
+const char* haptic_fir_decimator::simd_path()
+{
+#if defined(GAMEPAD_CORE_FIR_AVX2)
+	return "avx2";
+#elif defined(GAMEPAD_CORE_FIR_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
+#endif
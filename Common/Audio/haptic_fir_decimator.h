@@ -0,0 +1,58 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Anti-aliased integer-factor decimator for interleaved stereo float.
+ *
+ * A Kaiser-windowed sinc low-pass of kTapsPerPhase taps per output phase, evaluated only once
+ * every Factor input frames, which is the polyphase form of filter-then-drop: no work is spent on
+ * samples that are thrown away. History is kept per channel in a mirrored buffer, so the last
+ * taps() samples are always contiguous and the dot product vectorizes without wrap handling:
+ * AVX2 when built with it (USE_AVX2), SSE2 on any x86-64, a scalar loop elsewhere. State carries
+ * across calls, so output does not depend on how the input is split. Everything is stored in the
+ * object; nothing allocates.
+ */
+class haptic_fir_decimator
+{
+public:
+	static constexpr std::uint32_t kMaxFactor = 32;
+	static constexpr std::size_t kTapsPerPhase = 16;
+	static constexpr std::size_t kMaxTaps = kMaxFactor * kTapsPerPhase;
+
+	// Cutoff is a fraction of the output rate; 0.45 keeps the haptic band and stops what would
+	// alias back into it. Factor is clamped to [1, kMaxFactor].
+	explicit haptic_fir_decimator(std::uint32_t InFactor, float Cutoff = 0.45f);
+
+	void reset();
+
+	// Output frames a call with InFrames input frames can produce at most.
+	std::size_t max_output(std::size_t InFrames) const { return InFrames / Factor + 1; }
+
+	// Filters and decimates InFrames frames into Out, which must hold max_output(InFrames) frames.
+	// Returns the number of frames written.
+	std::size_t process(const float* In, std::size_t InFrames, float* Out);
+
+	std::uint32_t factor() const { return Factor; }
+	std::size_t taps() const { return Taps; }
+	const float* coefficients() const { return Coefficients; }
+
+	// "avx2", "sse2" or "scalar": the dot product this build uses.
+	static const char* simd_path();
+
+private:
+	std::uint32_t Factor;
+	std::size_t Taps;
+	// Input frames until the next output.
+	std::uint32_t Countdown = 1;
+	std::size_t Write = 0;
+
+	alignas(32) float Coefficients[kMaxTaps] = {};
+	// Each sample is stored at Write and Write + Taps.
+	alignas(32) float HistoryLeft[kMaxTaps * 2] = {};
+	alignas(32) float HistoryRight[kMaxTaps * 2] = {};
+};
+#endif
@@ -0,0 +1,27 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "spsc_ring.h"
+#include <cstdint>
+
+// One 48 kHz stereo haptic frame for the USB audio interface.
+struct haptic_usb_frame
+{
+	std::int16_t Left = 0;
+	std::int16_t Right = 0;
+};
+
+// 32 stereo int8 frames at 3000 Hz, the payload of one Bluetooth haptics report.
+struct haptic_bt_packet
+{
+	static constexpr std::size_t kFrames = 32;
+	static constexpr std::size_t kBytes = kFrames * 2;
+
+	std::uint8_t Data[kBytes] = {};
+};
+
+// 8192 frames is ~170 ms at 48 kHz; 64 packets is ~680 ms at 3000 Hz.
+using haptic_usb_ring = spsc_ring<haptic_usb_frame, 8192>;
+using haptic_bt_ring = spsc_ring<haptic_bt_packet, 64>;
+#endif
@@ -0,0 +1,76 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "haptic_processor.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "haptic_quantize.h"
+#include <algorithm>
+#include <cstdint>
+
+static_assert(sizeof(haptic_usb_frame) == 2 * sizeof(std::int16_t), "haptic_usb_frame must be two packed int16 samples");
+
+haptic_processor::haptic_processor(const haptic_processor_config& InConfig)
+    : Config(InConfig)
+    , UsbFilter(InConfig.UsbFilter, static_cast<float>(InConfig.InputSampleRate))
+    , BtFilter(InConfig.BtFilter, static_cast<float>(kBtSampleRate))
+    , bBtDecimate(InConfig.bBtAntiAliasing && InConfig.InputSampleRate % kBtSampleRate == 0 &&
+                  InConfig.InputSampleRate / kBtSampleRate <= haptic_fir_decimator::kMaxFactor)
+    , BtDecimator(InConfig.InputSampleRate / kBtSampleRate)
+    , BtResampler(std::max(InConfig.InputSampleRate, kBtSampleRate), kBtSampleRate)
+{
+}
+
+haptic_processor_config haptic_processor_config::for_device(EDSDeviceType DeviceType)
+{
+	haptic_processor_config Result;
+	if (DeviceType == EDSDeviceType::DualSense || DeviceType == EDSDeviceType::DualSenseEdge)
+	{
+		// The voice coils barely move below ~30 Hz, where content only eats excursion and headroom,
+		// and little above 1 kHz reaches the hand.
+		Result.UsbFilter = haptic_filter_preset::band_pass(30.0f, 1000.0f);
+		Result.BtFilter = Result.UsbFilter;
+	}
+	return Result;
+}
+
+void haptic_processor::reset()
+{
+	UsbFilter.reset();
+	BtFilter.reset();
+	BtDecimator.reset();
+	BtResampler.reset();
+	BtPacketFill = 0;
+}
+
+void haptic_processor::process_usb(const float* Interleaved, std::size_t Frames, haptic_usb_ring& Out)
+{
+	for (std::size_t First = 0; First < Frames; First += kUsbChunkFrames)
+	{
+		const std::size_t Count = std::min(kUsbChunkFrames, Frames - First);
+		std::copy_n(&Interleaved[First * 2], Count * 2, UsbStage);
+		UsbFilter.process(UsbStage, Count);
+		haptic_quantize_int16(UsbStage, Count * 2, reinterpret_cast<std::int16_t*>(UsbChunk), Config.bDither ? &Dither : nullptr);
+		Out.push(UsbChunk, Count);
+	}
+}
+
+void haptic_processor::process_bt(const float* Interleaved, std::size_t Frames, haptic_bt_ring& Out)
+{
+	for (std::size_t First = 0; First < Frames; First += kBtChunkFrames)
+	{
+		const std::size_t Count = std::min(kBtChunkFrames, Frames - First);
+		const std::size_t Resampled = bBtDecimate ? BtDecimator.process(&Interleaved[First * 2], Count, BtResampled)
+		                                          : BtResampler.process(&Interleaved[First * 2], Count, BtResampled);
+		BtFilter.process(BtResampled, Resampled);
+		for (std::size_t i = 0; i < Resampled; ++i)
+		{
+			BtStage[BtPacketFill * 2] = BtResampled[i * 2];
+			BtStage[BtPacketFill * 2 + 1] = BtResampled[i * 2 + 1];
+			if (++BtPacketFill == haptic_bt_packet::kFrames)
+			{
+				haptic_quantize_int8(BtStage, haptic_bt_packet::kBytes, reinterpret_cast<std::int8_t*>(BtPacket.Data), Config.bDither ? &Dither : nullptr);
+				Out.try_push(BtPacket);
+				BtPacketFill = 0;
+			}
+		}
+	}
+}
+#endif
@@ -0,0 +1,78 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/ECoreGamepad.h"
+#include "haptic_biquad.h"
+#include "haptic_fir_decimator.h"
+#include "haptic_frames.h"
+#include "haptic_quantize.h"
+#include "haptic_resampler.h"
+#include <cstddef>
+#include <cstdint>
+
+struct haptic_processor_config
+{
+	// Biquad cascades, designed for 48 kHz (USB) and 3 kHz (Bluetooth, after downsampling). Flat by
+	// default, which costs nothing per sample.
+	haptic_filter_preset UsbFilter;
+	haptic_filter_preset BtFilter;
+	std::uint32_t InputSampleRate = 48000;
+	// Bluetooth goes through haptic_fir_decimator when the input rate is a multiple of 3000 Hz,
+	// otherwise (or when false) through the linear haptic_resampler.
+	bool bBtAntiAliasing = true;
+	// Adds +-1 LSB triangular dither before rounding to int16/int8.
+	bool bDither = false;
+
+	// Filters suited to the controller's actuators; flat for controllers without audio haptics.
+	static haptic_processor_config for_device(EDSDeviceType DeviceType);
+};
+
+/**
+ * @brief Turns interleaved stereo float audio into haptic frames, inside the audio callback.
+ *
+ * USB gets one int16 stereo frame per input frame. Bluetooth streams the input down to 3000 Hz,
+ * through haptic_fir_decimator or haptic_resampler, and emits a 32-frame int8 packet each time one
+ * fills up, so the output is continuous across callbacks whatever their size. Each path runs its
+ * haptic_biquad_bank right before quantizing. All state and scratch space is part of the object,
+ * so once constructed no call allocates, locks or blocks: output goes to the caller's spsc_ring
+ * and whatever does not fit is counted there as dropped.
+ */
+class haptic_processor
+{
+public:
+	static constexpr std::uint32_t kBtSampleRate = 3000;
+
+	explicit haptic_processor(const haptic_processor_config& InConfig = haptic_processor_config());
+
+	// Clears filter and resampler state and drops any partially filled Bluetooth packet.
+	void reset();
+
+	void process_usb(const float* Interleaved, std::size_t Frames, haptic_usb_ring& Out);
+	void process_bt(const float* Interleaved, std::size_t Frames, haptic_bt_ring& Out);
+
+	// True when Bluetooth audio is low-passed before decimation.
+	bool bt_anti_aliasing() const { return bBtDecimate; }
+
+private:
+	static constexpr std::size_t kUsbChunkFrames = 256;
+	// Input frames resampled per step. Bluetooth only downsamples, so one step's output fits BtResampled.
+	static constexpr std::size_t kBtChunkFrames = 1024;
+
+	haptic_processor_config Config;
+	haptic_dither Dither;
+
+	// Filtered samples are staged as float and quantized in one pass straight into the frames.
+	float UsbStage[kUsbChunkFrames * 2];
+	haptic_usb_frame UsbChunk[kUsbChunkFrames];
+	haptic_biquad_bank UsbFilter;
+	haptic_biquad_bank BtFilter;
+	bool bBtDecimate;
+	haptic_fir_decimator BtDecimator;
+	haptic_resampler BtResampler;
+	float BtResampled[kBtChunkFrames * 2] = {};
+	float BtStage[haptic_bt_packet::kBytes];
+	haptic_bt_packet BtPacket;
+	std::size_t BtPacketFill = 0;
+};
+#endif
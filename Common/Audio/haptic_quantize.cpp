@@ -0,0 +1,152 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "haptic_quantize.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAMEPAD_CORE_QUANTIZE_SSE2 1
+#endif
+
+haptic_dither::haptic_dither(std::uint32_t Seed)
+{
+	for (std::uint32_t& Lane : State)
+	{
+		// splitmix32-style scramble so nearby seeds give unrelated streams; xorshift needs non-zero.
+		Seed += 0x9E3779B9u;
+		std::uint32_t Mixed = (Seed ^ (Seed >> 16)) * 0x85EBCA6Bu;
+		Mixed = (Mixed ^ (Mixed >> 13)) * 0xC2B2AE35u;
+		Lane = (Mixed ^ (Mixed >> 16)) | 1u;
+	}
+}
+
+static std::uint32_t xorshift(std::uint32_t& State)
+{
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+// [0, 1) from the top 23 bits.
+static float unit_float(std::uint32_t Bits)
+{
+	return std::bit_cast<float>((Bits >> 9) | 0x3F800000u) - 1.0f;
+}
+
+// One TPDF value in (-1, 1) LSB per lane.
+static void dither_step(haptic_dither& Dither, float* Out)
+{
+	for (int Lane = 0; Lane < 4; ++Lane)
+	{
+		const float A = unit_float(xorshift(Dither.State[Lane]));
+		const float B = unit_float(xorshift(Dither.State[Lane]));
+		Out[Lane] = A - B;
+	}
+}
+
+// Reference for every path and the tail of the SIMD ones. First must be a multiple of 4 so the
+// dither lanes line up with the vector code.
+template<typename TSample>
+static void quantize_scalar(const float* In, std::size_t First, std::size_t Count, TSample* Out, haptic_dither* Dither, float Scale, int Min, int Max)
+{
+	for (std::size_t i = First; i < Count; i += 4)
+	{
+		float Noise[4] = {};
+		if (Dither)
+		{
+			dither_step(*Dither, Noise);
+		}
+		for (std::size_t Lane = 0; Lane < 4 && i + Lane < Count; ++Lane)
+		{
+			// Written so NaN fails the comparison and lands on -1, like _mm_max_ps in quantize4().
+			const float Sample = In[i + Lane];
+			const float Value = (Sample > -1.0f ? std::min(Sample, 1.0f) : -1.0f) * Scale + Noise[Lane];
+			Out[i + Lane] = static_cast<TSample>(std::clamp(static_cast<int>(std::nearbyint(Value)), Min, Max));
+		}
+	}
+}
+
+#if defined(GAMEPAD_CORE_QUANTIZE_SSE2)
+static __m128i xorshift(__m128i State)
+{
+	State = _mm_xor_si128(State, _mm_slli_epi32(State, 13));
+	State = _mm_xor_si128(State, _mm_srli_epi32(State, 17));
+	return _mm_xor_si128(State, _mm_slli_epi32(State, 5));
+}
+
+static __m128 unit_float(__m128i Bits)
+{
+	return _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(Bits, 9), _mm_set1_epi32(0x3F800000))), _mm_set1_ps(1.0f));
+}
+
+// Clamp, scale, dither and round four samples to int32.
+static __m128i quantize4(const float* In, __m128 Scale, __m128i& State, bool bDither)
+{
+	__m128 Value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(In), _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f)), Scale);
+	if (bDither)
+	{
+		State = xorshift(State);
+		const __m128 A = unit_float(State);
+		State = xorshift(State);
+		Value = _mm_add_ps(Value, _mm_sub_ps(A, unit_float(State)));
+	}
+	// Default MXCSR rounding: to nearest, ties to even, like std::nearbyint.
+	return _mm_cvtps_epi32(Value);
+}
+#endif
+
+void haptic_quantize_int8(const float* In, std::size_t Count, std::int8_t* Out, haptic_dither* Dither)
+{
+	std::size_t i = 0;
+#if defined(GAMEPAD_CORE_QUANTIZE_SSE2)
+	const __m128 Scale = _mm_set1_ps(127.0f);
+	__m128i State = Dither ? _mm_load_si128(reinterpret_cast<const __m128i*>(Dither->State)) : _mm_setzero_si128();
+	for (; i + 16 <= Count; i += 16)
+	{
+		// Separate statements: the dither state must advance in sample order.
+		const __m128i Q0 = quantize4(In + i, Scale, State, Dither);
+		const __m128i Q1 = quantize4(In + i + 4, Scale, State, Dither);
+		const __m128i Q2 = quantize4(In + i + 8, Scale, State, Dither);
+		const __m128i Q3 = quantize4(In + i + 12, Scale, State, Dither);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i), _mm_packs_epi16(_mm_packs_epi32(Q0, Q1), _mm_packs_epi32(Q2, Q3)));
+	}
+	if (Dither)
+	{
+		_mm_store_si128(reinterpret_cast<__m128i*>(Dither->State), State);
+	}
+#endif
+	quantize_scalar(In, i, Count, Out, Dither, 127.0f, -128, 127);
+}
+
+void haptic_quantize_int16(const float* In, std::size_t Count, std::int16_t* Out, haptic_dither* Dither)
+{
+	std::size_t i = 0;
+#if defined(GAMEPAD_CORE_QUANTIZE_SSE2)
+	const __m128 Scale = _mm_set1_ps(32767.0f);
+	__m128i State = Dither ? _mm_load_si128(reinterpret_cast<const __m128i*>(Dither->State)) : _mm_setzero_si128();
+	for (; i + 8 <= Count; i += 8)
+	{
+		const __m128i Q0 = quantize4(In + i, Scale, State, Dither);
+		const __m128i Q1 = quantize4(In + i + 4, Scale, State, Dither);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i), _mm_packs_epi32(Q0, Q1));
+	}
+	if (Dither)
+	{
+		_mm_store_si128(reinterpret_cast<__m128i*>(Dither->State), State);
+	}
+#endif
+	quantize_scalar(In, i, Count, Out, Dither, 32767.0f, -32768, 32767);
+}
+
+const char* haptic_quantize_simd_path()
+{
+#if defined(GAMEPAD_CORE_QUANTIZE_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
+#endif
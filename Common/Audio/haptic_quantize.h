@@ -0,0 +1,35 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief State of the TPDF dither generator: four xorshift32 streams, one per SIMD lane.
+ *
+ * Triangular dither of +-1 LSB (the difference of two uniform values) decorrelates the rounding
+ * error from the signal, which matters most for the int8 Bluetooth packets where quiet effects
+ * otherwise collapse into a few steps of buzz.
+ */
+struct haptic_dither
+{
+	explicit haptic_dither(std::uint32_t Seed = 0x9E3779B9u);
+
+	alignas(16) std::uint32_t State[4];
+};
+
+/**
+ * @brief Saturating float -> int quantizers for haptic payloads.
+ *
+ * Samples are clamped to [-1, 1] (NaN counts as -1), scaled to the full integer range, optionally dithered and
+ * rounded to nearest (ties to even). Count is a number of samples, not frames, and Out may be the
+ * payload that is sent. SSE2 on x86-64 (four samples per step, saturating packs), scalar
+ * elsewhere and for the tail; both produce identical output for the same dither state.
+ */
+void haptic_quantize_int8(const float* In, std::size_t Count, std::int8_t* Out, haptic_dither* Dither = nullptr);
+void haptic_quantize_int16(const float* In, std::size_t Count, std::int16_t* Out, haptic_dither* Dither = nullptr);
+
+// "sse2" or "scalar": the kernels this build uses.
+const char* haptic_quantize_simd_path();
+#endif
@@ -0,0 +1,55 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "haptic_resampler.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+haptic_resampler::haptic_resampler(std::uint32_t InRate, std::uint32_t OutRate)
+    : InRate(InRate ? InRate : 1)
+    , OutRate(OutRate ? OutRate : 1)
+{
+}
+
+void haptic_resampler::reset()
+{
+	Phase = 0;
+	PreviousLeft = 0.0f;
+	PreviousRight = 0.0f;
+	bPrimed = false;
+}
+
+std::size_t haptic_resampler::max_output(std::size_t InFrames) const
+{
+	return static_cast<std::size_t>((static_cast<std::uint64_t>(InFrames) * OutRate) / InRate) + 2;
+}
+
+std::size_t haptic_resampler::process(const float* In, std::size_t InFrames, float* Out)
+{
+	std::size_t Written = 0;
+	std::size_t First = 0;
+	if (!bPrimed && InFrames > 0)
+	{
+		// The first input frame is the first output frame.
+		PreviousLeft = In[0];
+		PreviousRight = In[1];
+		bPrimed = true;
+		First = 1;
+	}
+
+	const float Scale = 1.0f / static_cast<float>(OutRate);
+	for (std::size_t i = First; i < InFrames; ++i)
+	{
+		const float Left = In[i * 2];
+		const float Right = In[i * 2 + 1];
+		for (; Phase < OutRate; Phase += InRate)
+		{
+			const float Fraction = static_cast<float>(Phase) * Scale;
+			Out[Written * 2] = PreviousLeft + Fraction * (Left - PreviousLeft);
+			Out[Written * 2 + 1] = PreviousRight + Fraction * (Right - PreviousRight);
+			++Written;
+		}
+		Phase -= OutRate;
+		PreviousLeft = Left;
+		PreviousRight = Right;
+	}
+	return Written;
+}
+#endif
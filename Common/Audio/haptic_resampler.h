@@ -0,0 +1,43 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Streaming linear-interpolation resampler for interleaved stereo float.
+ *
+ * Keeps the last input frame and the position of the next output between calls, so splitting
+ * the input differently never changes the output and there is no seam at call boundaries.
+ * Positions are integers in units of 1/OutRate input frames, so the phase never drifts.
+ * Work is constant per input frame plus one interpolation per output frame.
+ */
+class haptic_resampler
+{
+public:
+	haptic_resampler(std::uint32_t InRate, std::uint32_t OutRate);
+
+	void reset();
+
+	// Output frames a call with InFrames input frames can produce at most.
+	std::size_t max_output(std::size_t InFrames) const;
+
+	// Resamples InFrames frames into Out, which must hold max_output(InFrames) frames. Returns the
+	// number of frames written.
+	std::size_t process(const float* In, std::size_t InFrames, float* Out);
+
+	std::uint32_t input_rate() const { return InRate; }
+	std::uint32_t output_rate() const { return OutRate; }
+
+private:
+	std::uint32_t InRate;
+	std::uint32_t OutRate;
+
+	// Next output sits Phase / OutRate input frames after the previous input frame.
+	std::uint64_t Phase = 0;
+	float PreviousLeft = 0.0f;
+	float PreviousRight = 0.0f;
+	bool bPrimed = false;
+};
+#endif
@@ -0,0 +1,111 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief Bounded wait-free single-producer/single-consumer ring of fixed-size items.
+ *
+ * Meant for the realtime audio callback: push never blocks, allocates or retries, it either
+ * copies the items in or reports them as dropped. Each side owns one index on its own cache
+ * line and keeps a private copy of the other side's index, so the shared lines are only
+ * touched when the cached view says the ring is full (producer) or empty (consumer).
+ * Capacity must be a power of two.
+ */
+template<typename T, std::size_t Capacity>
+class spsc_ring
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+	static_assert(std::is_trivially_copyable_v<T>, "Items are copied in and out of the ring");
+
+public:
+	static constexpr std::size_t capacity() { return Capacity; }
+
+	// Producer only. False (and counted as dropped) when the ring is full.
+	bool try_push(const T& Value)
+	{
+		return push(&Value, 1) == 1;
+	}
+
+	// Producer only. Copies as many of Items as fit and returns that count; the rest are dropped.
+	std::size_t push(const T* Items, std::size_t Count)
+	{
+		const std::size_t Write = Tail.load(std::memory_order_relaxed);
+		if (Capacity - (Write - CachedHead) < Count)
+		{
+			CachedHead = Head.load(std::memory_order_acquire);
+		}
+		const std::size_t Accepted = std::min(Count, Capacity - (Write - CachedHead));
+		for (std::size_t i = 0; i < Accepted; ++i)
+		{
+			Slots[(Write + i) & (Capacity - 1)] = Items[i];
+		}
+		if (Accepted > 0)
+		{
+			Tail.store(Write + Accepted, std::memory_order_release);
+		}
+		if (Accepted < Count)
+		{
+			Dropped.fetch_add(Count - Accepted, std::memory_order_relaxed);
+		}
+		return Accepted;
+	}
+
+	// Consumer only.
+	bool try_pop(T& OutValue)
+	{
+		return pop(&OutValue, 1) == 1;
+	}
+
+	// Consumer only. Copies up to MaxCount items into Out and returns how many.
+	std::size_t pop(T* Out, std::size_t MaxCount)
+	{
+		const std::size_t Read = Head.load(std::memory_order_relaxed);
+		if (CachedTail - Read < MaxCount)
+		{
+			CachedTail = Tail.load(std::memory_order_acquire);
+		}
+		const std::size_t Available = std::min(MaxCount, CachedTail - Read);
+		for (std::size_t i = 0; i < Available; ++i)
+		{
+			Out[i] = Slots[(Read + i) & (Capacity - 1)];
+		}
+		if (Available > 0)
+		{
+			Head.store(Read + Available, std::memory_order_release);
+		}
+		return Available;
+	}
+
+	// Consumer only. Drops everything queued so far. CachedTail moves with Head: left behind it,
+	// pop() would take the wrapped distance for a count and hand out stale slots.
+	void clear()
+	{
+		CachedTail = Tail.load(std::memory_order_acquire);
+		Head.store(CachedTail, std::memory_order_release);
+	}
+
+	std::size_t approximate_size() const
+	{
+		return Tail.load(std::memory_order_relaxed) - Head.load(std::memory_order_relaxed);
+	}
+
+	// Items rejected by push because the consumer fell behind.
+	std::uint64_t dropped() const { return Dropped.load(std::memory_order_relaxed); }
+
+private:
+	// Consumer side: Head is published, CachedTail is private.
+	alignas(64) std::atomic<std::size_t> Head{0};
+	std::size_t CachedTail = 0;
+	// Producer side: Tail is published, CachedHead is private.
+	alignas(64) std::atomic<std::size_t> Tail{0};
+	std::size_t CachedHead = 0;
+	std::atomic<std::uint64_t> Dropped{0};
+	alignas(64) T Slots[Capacity];
+};
+#endif
@@ -0,0 +1,298 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "wav_mapped_source.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static constexpr std::uint16_t kEncodingPcm = 1;
+static constexpr std::uint16_t kEncodingFloat = 3;
+static constexpr std::uint16_t kEncodingExtensible = 0xFFFE;
+
+// WAV is little-endian, as is every target this builds for.
+template<typename T>
+static T read_le(const std::uint8_t* Bytes)
+{
+	T Value;
+	std::memcpy(&Value, Bytes, sizeof(T));
+	return Value;
+}
+
+wav_mapped_source::~wav_mapped_source()
+{
+	close();
+}
+
+bool wav_mapped_source::fail(const std::string& Message)
+{
+	close();
+	Error = Message;
+	return false;
+}
+
+bool wav_mapped_source::open(const std::string& Path)
+{
+	close();
+	Error.clear();
+
+#ifdef _WIN32
+	HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		return fail("cannot open " + Path);
+	}
+	FileHandle = File;
+	LARGE_INTEGER FileSize{};
+	if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+	{
+		return fail("cannot size or empty: " + Path);
+	}
+	MappingHandle = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* View = MappingHandle ? MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!View)
+	{
+		return fail("cannot map " + Path);
+	}
+	Data = static_cast<const std::uint8_t*>(View);
+	Size = static_cast<std::size_t>(FileSize.QuadPart);
+#else
+	const int Descriptor = ::open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (Descriptor < 0)
+	{
+		return fail("cannot open " + Path);
+	}
+	struct stat Info{};
+	if (fstat(Descriptor, &Info) != 0 || Info.st_size == 0)
+	{
+		::close(Descriptor);
+		return fail("cannot size or empty: " + Path);
+	}
+	void* Mapping = mmap(nullptr, static_cast<std::size_t>(Info.st_size), PROT_READ, MAP_PRIVATE, Descriptor, 0);
+	// The mapping keeps the file referenced.
+	::close(Descriptor);
+	if (Mapping == MAP_FAILED)
+	{
+		return fail("cannot map " + Path);
+	}
+	Data = static_cast<const std::uint8_t*>(Mapping);
+	Size = static_cast<std::size_t>(Info.st_size);
+	madvise(Mapping, Size, MADV_SEQUENTIAL);
+#endif
+
+	if (!parse())
+	{
+		return false;
+	}
+	read_ahead();
+	return true;
+}
+
+void wav_mapped_source::close()
+{
+#ifdef _WIN32
+	if (Data)
+	{
+		UnmapViewOfFile(Data);
+	}
+	if (MappingHandle)
+	{
+		CloseHandle(MappingHandle);
+	}
+	if (FileHandle)
+	{
+		CloseHandle(FileHandle);
+	}
+	MappingHandle = nullptr;
+	FileHandle = nullptr;
+#else
+	if (Data)
+	{
+		munmap(const_cast<std::uint8_t*>(Data), Size);
+	}
+#endif
+	Data = nullptr;
+	Size = 0;
+	DataOffset = 0;
+	TotalFrames = 0;
+	Format = {};
+	bZeroCopy = false;
+	Position.store(0, std::memory_order_relaxed);
+	ReadAheadStart = 0;
+	ReadAheadEnd = 0;
+}
+
+bool wav_mapped_source::parse()
+{
+	if (Size < 12 || std::memcmp(Data, "RIFF", 4) != 0 || std::memcmp(Data + 8, "WAVE", 4) != 0)
+	{
+		return fail("not a RIFF/WAVE file");
+	}
+
+	bool bHaveFormat = false;
+	std::size_t DataSize = 0;
+	std::size_t Offset = 12;
+	while (Offset + 8 <= Size && DataOffset == 0)
+	{
+		const std::uint8_t* Chunk = Data + Offset;
+		const std::size_t ChunkSize = read_le<std::uint32_t>(Chunk + 4);
+		const std::size_t Available = Size - Offset - 8;
+		if (std::memcmp(Chunk, "fmt ", 4) == 0 && ChunkSize >= 16 && ChunkSize <= Available)
+		{
+			Format.Encoding = read_le<std::uint16_t>(Chunk + 8);
+			Format.Channels = read_le<std::uint16_t>(Chunk + 10);
+			Format.SampleRate = read_le<std::uint32_t>(Chunk + 12);
+			Format.BlockAlign = read_le<std::uint16_t>(Chunk + 20);
+			Format.BitsPerSample = read_le<std::uint16_t>(Chunk + 22);
+			if (Format.Encoding == kEncodingExtensible && ChunkSize >= 40)
+			{
+				// The subformat GUID starts with the plain format tag.
+				Format.Encoding = read_le<std::uint16_t>(Chunk + 32);
+			}
+			bHaveFormat = true;
+		}
+		else if (std::memcmp(Chunk, "data", 4) == 0)
+		{
+			// Streamed files may carry a placeholder size; trust the file instead.
+			DataOffset = Offset + 8;
+			DataSize = std::min(ChunkSize, Available);
+		}
+		// Chunks are padded to an even size.
+		if (ChunkSize > Available)
+		{
+			break;
+		}
+		Offset += 8 + ChunkSize + (ChunkSize & 1);
+	}
+
+	if (!bHaveFormat || DataOffset == 0)
+	{
+		return fail("missing fmt or data chunk");
+	}
+	const bool bPcm = Format.Encoding == kEncodingPcm &&
+	                  (Format.BitsPerSample == 8 || Format.BitsPerSample == 16 || Format.BitsPerSample == 24 || Format.BitsPerSample == 32);
+	const bool bFloat = Format.Encoding == kEncodingFloat && Format.BitsPerSample == 32;
+	if (!(bPcm || bFloat) || Format.Channels == 0 || Format.SampleRate == 0 ||
+	    Format.BlockAlign != Format.Channels * (Format.BitsPerSample / 8))
+	{
+		return fail("unsupported encoding " + std::to_string(Format.Encoding) + " with " + std::to_string(Format.BitsPerSample) + " bits");
+	}
+
+	TotalFrames = DataSize / Format.BlockAlign;
+	bZeroCopy = bFloat && Format.Channels == 2 && reinterpret_cast<std::uintptr_t>(Data + DataOffset) % alignof(float) == 0;
+	return true;
+}
+
+void wav_mapped_source::seek(std::uint64_t Frame)
+{
+	Position.store(std::min(Frame, TotalFrames), std::memory_order_relaxed);
+}
+
+// Sample Index of the frame at Frame as float in [-1, 1].
+template<std::uint16_t Bits, bool bFloat>
+static float sample_at(const std::uint8_t* Frame, std::size_t Index)
+{
+	const std::uint8_t* Bytes = Frame + Index * (Bits / 8);
+	if constexpr (bFloat)
+	{
+		return read_le<float>(Bytes);
+	}
+	else if constexpr (Bits == 8)
+	{
+		return (static_cast<float>(Bytes[0]) - 128.0f) * (1.0f / 128.0f);
+	}
+	else if constexpr (Bits == 16)
+	{
+		return static_cast<float>(read_le<std::int16_t>(Bytes)) * (1.0f / 32768.0f);
+	}
+	else if constexpr (Bits == 24)
+	{
+		const std::int32_t Value = static_cast<std::int32_t>(static_cast<std::uint32_t>(Bytes[0]) << 8 | static_cast<std::uint32_t>(Bytes[1]) << 16 |
+		                                                     static_cast<std::uint32_t>(Bytes[2]) << 24);
+		return static_cast<float>(Value >> 8) * (1.0f / 8388608.0f);
+	}
+	else
+	{
+		return static_cast<float>(read_le<std::int32_t>(Bytes)) * (1.0f / 2147483648.0f);
+	}
+}
+
+template<std::uint16_t Bits, bool bFloat>
+static void convert(const std::uint8_t* In, std::size_t Frames, std::size_t BlockAlign, bool bMono, float* Out)
+{
+	for (std::size_t i = 0; i < Frames; ++i, In += BlockAlign)
+	{
+		Out[i * 2] = sample_at<Bits, bFloat>(In, 0);
+		Out[i * 2 + 1] = bMono ? Out[i * 2] : sample_at<Bits, bFloat>(In, 1);
+	}
+}
+
+const float* wav_mapped_source::read_f32_stereo(float* Out, std::size_t MaxFrames, std::size_t& Frames)
+{
+	const std::uint64_t Current = Position.load(std::memory_order_relaxed);
+	Frames = static_cast<std::size_t>(std::min<std::uint64_t>(MaxFrames, TotalFrames - Current));
+	if (Frames == 0)
+	{
+		return Out;
+	}
+	Position.store(Current + Frames, std::memory_order_relaxed);
+
+	const std::uint8_t* In = Data + DataOffset + Current * Format.BlockAlign;
+	if (bZeroCopy)
+	{
+		return reinterpret_cast<const float*>(In);
+	}
+	const bool bMono = Format.Channels == 1;
+	switch (Format.Encoding == kEncodingFloat ? 0 : Format.BitsPerSample)
+	{
+		case 0: convert<32, true>(In, Frames, Format.BlockAlign, bMono, Out); break;
+		case 8: convert<8, false>(In, Frames, Format.BlockAlign, bMono, Out); break;
+		case 16: convert<16, false>(In, Frames, Format.BlockAlign, bMono, Out); break;
+		case 24: convert<24, false>(In, Frames, Format.BlockAlign, bMono, Out); break;
+		default: convert<32, false>(In, Frames, Format.BlockAlign, bMono, Out); break;
+	}
+	return Out;
+}
+
+void wav_mapped_source::read_ahead()
+{
+	if (!Data)
+	{
+		return;
+	}
+	const std::size_t Current = DataOffset + static_cast<std::size_t>(position()) * Format.BlockAlign;
+	// Nothing to do while the play position is in the first half of the window already hinted.
+	if (Current >= ReadAheadStart && Current + kReadAheadBytes / 2 < ReadAheadEnd)
+	{
+		return;
+	}
+	const std::size_t End = std::min(Size, Current + kReadAheadBytes);
+	if (Current >= End)
+	{
+		return;
+	}
+#ifdef _WIN32
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+	WIN32_MEMORY_RANGE_ENTRY Range{const_cast<std::uint8_t*>(Data + Current), End - Current};
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &Range, 0);
+#endif
+#else
+	// madvise wants a page-aligned start; the mapping itself is page-aligned.
+	static const std::size_t PageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	const std::size_t Start = Current / PageSize * PageSize;
+	madvise(const_cast<std::uint8_t*>(Data + Start), End - Start, MADV_WILLNEED);
+#endif
+	ReadAheadStart = Current;
+	ReadAheadEnd = End;
+}
+#endif
@@ -0,0 +1,90 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct wav_format
+{
+	// 1 = integer PCM, 3 = IEEE float; WAVE_FORMAT_EXTENSIBLE is resolved to its subformat.
+	std::uint16_t Encoding = 0;
+	std::uint16_t Channels = 0;
+	std::uint32_t SampleRate = 0;
+	std::uint16_t BitsPerSample = 0;
+	// Bytes per frame, all channels.
+	std::uint16_t BlockAlign = 0;
+};
+
+/**
+ * @brief A PCM or float WAV file mapped into memory and played from the mapping.
+ *
+ * open() maps the file and parses the RIFF header, so the length is known without decoding
+ * anything. read_f32_stereo() hands out frames from the mapping itself when the file is already
+ * 32-bit float stereo and converts into the caller's buffer otherwise (16/24/32-bit integer,
+ * mono or more channels, of which the first two are kept); it does no I/O beyond page faults and
+ * never allocates, so it can run in the audio callback. There is no resampling: callers compare
+ * format().SampleRate with the device rate. read_ahead() asks the kernel to fetch the next
+ * kReadAheadBytes past the play position and is meant for a non-realtime thread; the whole
+ * mapping is also marked sequential. One thread reads, any one other may call read_ahead().
+ */
+class wav_mapped_source
+{
+public:
+	static constexpr std::size_t kReadAheadBytes = 1024 * 1024;
+
+	wav_mapped_source() = default;
+	~wav_mapped_source();
+
+	wav_mapped_source(const wav_mapped_source&) = delete;
+	wav_mapped_source& operator=(const wav_mapped_source&) = delete;
+
+	// False with error() set when the file cannot be mapped or is not a WAV this can play.
+	bool open(const std::string& Path);
+	void close();
+
+	bool is_open() const { return Data != nullptr; }
+	const std::string& error() const { return Error; }
+	const wav_format& format() const { return Format; }
+	// From the data chunk size, clipped to what the file actually holds.
+	std::uint64_t total_frames() const { return TotalFrames; }
+	double duration_seconds() const { return Format.SampleRate ? static_cast<double>(TotalFrames) / Format.SampleRate : 0.0; }
+	// True when read_f32_stereo() can return frames without converting them.
+	bool is_zero_copy() const { return bZeroCopy; }
+
+	std::uint64_t position() const { return Position.load(std::memory_order_relaxed); }
+	void seek(std::uint64_t Frame);
+
+	// Up to MaxFrames interleaved float stereo frames at the play position, which then advances.
+	// Returns a pointer into the mapping, or Out after converting into it (Out must hold
+	// MaxFrames stereo frames). Frames is set to the count, 0 at the end of the data.
+	const float* read_f32_stereo(float* Out, std::size_t MaxFrames, std::size_t& Frames);
+
+	// Hints the kernel to read the window after the play position; cheap when nothing moved.
+	void read_ahead();
+
+private:
+	bool fail(const std::string& Message);
+	bool parse();
+
+	std::string Error;
+	wav_format Format;
+	const std::uint8_t* Data = nullptr;
+	std::size_t Size = 0;
+	std::size_t DataOffset = 0;
+	std::uint64_t TotalFrames = 0;
+	bool bZeroCopy = false;
+
+	std::atomic<std::uint64_t> Position{0};
+	// Last window passed to read_ahead(), in bytes from the start of the file.
+	std::size_t ReadAheadStart = 0;
+	std::size_t ReadAheadEnd = 0;
+
+#ifdef _WIN32
+	void* FileHandle = nullptr;
+	void* MappingHandle = nullptr;
+#endif
+};
+#endif
@@ -0,0 +1,164 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "linux_audio_context.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#if defined(__unix__) && GAMEPAD_CORE_HAS_AUDIO
+#include "linux_audio_topology.h"
+#include "linux_hotplug_monitor.h"
+#include <chrono>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+// On Linux, the audio device name might vary (e.g., "DualSense Wireless Controller Analog Stereo").
+static bool is_controller_name(const std::string& Name)
+{
+	return Name.find("DualSense") != std::string::npos ||
+	       Name.find("Wireless Controller") != std::string::npos ||
+	       Name.find("Sony") != std::string::npos;
+}
+
+linux_audio_context& linux_audio_context::Get()
+{
+	static linux_audio_context Instance;
+	return Instance;
+}
+
+linux_audio_context::~linux_audio_context()
+{
+	if (bContextReady)
+	{
+		ma_context_uninit(&Context);
+	}
+}
+
+bool linux_audio_context::ensure_context()
+{
+	if (bContextReady || bContextFailed)
+	{
+		return bContextReady;
+	}
+
+	const auto Start = Clock::now();
+	bContextReady = ma_context_init(nullptr, 0, nullptr, &Context) == MA_SUCCESS;
+	// No backend now means none for the whole run: do not pay for the attempt per controller.
+	bContextFailed = !bContextReady;
+	ContextInits.fetch_add(1, std::memory_order_relaxed);
+	BackendTimeUs.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - Start).count(), std::memory_order_relaxed);
+	return bContextReady;
+}
+
+void linux_audio_context::refresh_if_stale()
+{
+	const linux_hotplug_monitor& Monitor = linux_hotplug_monitor::Get();
+	const std::uint64_t Generation = Monitor.sound_generation();
+	if (!bStale && Monitor.is_running() && Generation == CachedGeneration)
+	{
+		return;
+	}
+
+	const auto Start = Clock::now();
+	ma_device_info* PlaybackInfos = nullptr;
+	ma_uint32 PlaybackCount = 0;
+	ma_device_info* CaptureInfos = nullptr;
+	ma_uint32 CaptureCount = 0;
+	if (ma_context_get_devices(&Context, &PlaybackInfos, &PlaybackCount, &CaptureInfos, &CaptureCount) != MA_SUCCESS)
+	{
+		PlaybackCount = 0;
+	}
+	// The returned arrays belong to the context and are overwritten by the next enumeration.
+	Playback.assign(PlaybackInfos, PlaybackInfos + PlaybackCount);
+	Enumerations.fetch_add(1, std::memory_order_relaxed);
+	BackendTimeUs.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - Start).count(), std::memory_order_relaxed);
+
+	linux_audio_topology& Topology = linux_audio_topology::Get();
+	Topology.rebuild();
+	ByCard.clear();
+	FirstNamedController = -1;
+	for (std::size_t i = 0; i < Playback.size(); ++i)
+	{
+		int Card = -1;
+		if (Context.backend == ma_backend_alsa)
+		{
+			Card = Topology.card_for_alsa_id(Playback[i].id.alsa);
+		}
+		else if (Context.backend == ma_backend_pulseaudio)
+		{
+			// PipeWire is reached through its PulseAudio server and names sinks the same way.
+			Card = Topology.card_for_sink_name(Playback[i].id.pulse);
+		}
+		if (Card >= 0)
+		{
+			ByCard.emplace(Card, i);
+		}
+		if (FirstNamedController < 0 && is_controller_name(Playback[i].name))
+		{
+			FirstNamedController = static_cast<int>(i);
+		}
+	}
+
+	CachedGeneration = Generation;
+	bStale = false;
+}
+
+bool linux_audio_context::find_controller_device(const std::string& HidPath, ma_device_id& OutId, std::string& OutName)
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	if (!ensure_context())
+	{
+		return false;
+	}
+	refresh_if_stale();
+	Lookups.fetch_add(1, std::memory_order_relaxed);
+
+	// The controller's own card: its sysfs container is the USB device that also carries the
+	// audio interface. Bluetooth controllers have no card and play haptics over HID instead.
+	const linux_audio_topology& Topology = linux_audio_topology::Get();
+	const std::string Container = Topology.container_for_hid(HidPath);
+	int Card = Topology.card_for_container(Container);
+	if (Card < 0 && !Container.empty() && access((Container + "/idVendor").c_str(), F_OK) == 0)
+	{
+		// A USB controller whose card was not indexed yet: its uevent may still be on the way.
+		bStale = true;
+		refresh_if_stale();
+		Card = Topology.card_for_container(Container);
+	}
+
+	int Found = -1;
+	if (Card >= 0)
+	{
+		const auto It = ByCard.find(Card);
+		Found = It == ByCard.end() ? -1 : static_cast<int>(It->second);
+	}
+	// Only when sysfs cannot place the controller at all, fall back to the device name. Once it
+	// did, a device that is not on the controller's card, or no card at all, belongs to another one.
+	else if (Container.empty())
+	{
+		Found = FirstNamedController;
+	}
+
+	if (Found < 0)
+	{
+		return false;
+	}
+	OutId = Playback[Found].id;
+	OutName = Playback[Found].name;
+	return true;
+}
+
+void linux_audio_context::invalidate()
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	bStale = true;
+}
+
+linux_audio_statistics linux_audio_context::statistics()
+{
+	linux_audio_statistics Stats;
+	Stats.ContextInits = ContextInits.load(std::memory_order_relaxed);
+	Stats.Enumerations = Enumerations.load(std::memory_order_relaxed);
+	Stats.Lookups = Lookups.load(std::memory_order_relaxed);
+	Stats.BackendTimeUs = BackendTimeUs.load(std::memory_order_relaxed);
+	return Stats;
+}
+#endif
+#endif
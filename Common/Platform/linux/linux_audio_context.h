@@ -0,0 +1,74 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Utils/SoDefines.h"
+#if GAMEPAD_CORE_HAS_AUDIO
+#include "miniaudio.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct linux_audio_statistics
+{
+	std::uint64_t ContextInits = 0;
+	std::uint64_t Enumerations = 0;
+	std::uint64_t Lookups = 0;
+	// Total time spent in ma_context_init and ma_context_get_devices.
+	std::uint64_t BackendTimeUs = 0;
+};
+
+/**
+ * @brief Process-wide miniaudio context and a cached list of playback devices.
+ *
+ * The context is initialised on first use and kept until exit. The playback list, and the
+ * controller-to-device index built from it with linux_audio_topology, is only refreshed when
+ * linux_hotplug_monitor reports a sound device change, so setting up audio for a controller
+ * is a lookup rather than a context init plus a full enumeration. Without the monitor every
+ * lookup refreshes, which is still one enumeration less than before.
+ */
+class linux_audio_context
+{
+public:
+	static linux_audio_context& Get();
+
+	~linux_audio_context();
+
+	// Playback device for the controller behind HidPath: the ALSA device or sound server sink on
+	// its own card. Only when sysfs cannot resolve the controller, the first one named like a
+	// controller. False when there is none.
+	bool find_controller_device(const std::string& HidPath, ma_device_id& OutId, std::string& OutName);
+	// Drops the cached enumeration; the next lookup re-enumerates.
+	void invalidate();
+
+	linux_audio_statistics statistics();
+
+private:
+	linux_audio_context() = default;
+
+	// Called with Mutex held.
+	bool ensure_context();
+	void refresh_if_stale();
+
+	gc_lock::mutex Mutex;
+	ma_context Context{};
+	bool bContextReady = false;
+	bool bContextFailed = false;
+
+	// Sound generation of linux_hotplug_monitor the cache belongs to; 0 = never enumerated.
+	std::uint64_t CachedGeneration = 0;
+	bool bStale = true;
+	std::vector<ma_device_info> Playback;
+	// Card index -> first playback device on it, and the first device named like a controller.
+	std::unordered_map<int, std::size_t> ByCard;
+	int FirstNamedController = -1;
+
+	std::atomic<std::uint64_t> ContextInits{0};
+	std::atomic<std::uint64_t> Enumerations{0};
+	std::atomic<std::uint64_t> Lookups{0};
+	std::atomic<std::uint64_t> BackendTimeUs{0};
+};
+#endif
+#endif
@@ -0,0 +1,253 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "linux_audio_topology.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#ifdef __unix__
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+static std::string canonical_path(const fs::path& Path)
+{
+	std::error_code Error;
+	const fs::path Resolved = fs::canonical(Path, Error);
+	return Error ? std::string() : Resolved.string();
+}
+
+static constexpr unsigned int kBusUsb = 0x03;
+
+// HID devices are named <bus>:<vendor>:<product>.<instance>, e.g. 0005:054C:0CE6.0002.
+static bool parse_hid_device_bus(const std::string& Name, unsigned int& OutBus)
+{
+	unsigned int Vendor = 0;
+	unsigned int Product = 0;
+	unsigned int Instance = 0;
+	return std::sscanf(Name.c_str(), "%x:%x:%x.%x", &OutBus, &Vendor, &Product, &Instance) == 4;
+}
+
+static bool parse_int(std::string_view Text, int& Out)
+{
+	const auto [End, Error] = std::from_chars(Text.data(), Text.data() + Text.size(), Out);
+	return Error == std::errc() && End == Text.data() + Text.size() && Out >= 0;
+}
+
+static std::string read_line(const fs::path& Path)
+{
+	std::string Line;
+	std::ifstream File(Path);
+	std::getline(File, Line);
+	return Line;
+}
+
+// Sound servers only keep [A-Za-z0-9._-] in object names and turn everything else into '_'.
+static std::string sink_name_part(std::string_view Text)
+{
+	std::string Part(Text);
+	for (char& Char : Part)
+	{
+		const bool bValid = (Char >= 'a' && Char <= 'z') || (Char >= 'A' && Char <= 'Z') || (Char >= '0' && Char <= '9') || Char == '.' || Char == '-' || Char == '_';
+		Char = bValid ? Char : '_';
+	}
+	return Part;
+}
+
+// Keys a USB card's sinks are named after: udev's ID_PATH ("...-usb-0:2:1.0") and ID_ID
+// ("usb-<vendor>_<model>[_<serial>]-<interface>"), as the sound server spells them.
+static std::vector<std::string> usb_sink_keys(const fs::path& CardPath, const std::string& Container)
+{
+	// cardN sits in <usb device>/<interface>/sound/cardN and the interface is named <bus>-<ports>:<config>.<number>.
+	const fs::path Interface = CardPath.parent_path().parent_path();
+	const std::string InterfaceName = Interface.filename().string();
+	const std::size_t Dash = InterfaceName.find('-');
+	const std::string Number = read_line(Interface / "bInterfaceNumber");
+	if (Container.empty() || Interface.parent_path().string() != Container || Dash == std::string::npos || Number.empty())
+	{
+		return {};
+	}
+
+	std::vector<std::string> Keys;
+	Keys.push_back(sink_name_part("-usb-0:" + InterfaceName.substr(Dash + 1)));
+
+	const std::string Vendor = read_line(fs::path(Container) / "manufacturer");
+	const std::string Model = read_line(fs::path(Container) / "product");
+	const std::string Serial = read_line(fs::path(Container) / "serial");
+	if (!Vendor.empty() && !Model.empty())
+	{
+		std::string Id = "usb-" + Vendor + "_" + Model;
+		if (!Serial.empty())
+		{
+			Id += "_" + Serial;
+		}
+		Keys.push_back(sink_name_part(Id + "-" + Number + "."));
+	}
+	return Keys;
+}
+
+linux_audio_topology& linux_audio_topology::Get()
+{
+	static linux_audio_topology Instance;
+	return Instance;
+}
+
+linux_audio_topology::linux_audio_topology(std::string SysfsRoot)
+    : Root(canonical_path(SysfsRoot))
+{
+}
+
+std::string linux_audio_topology::container_of(const std::string& DevicePath) const
+{
+	const std::string Devices = Root + "/devices/";
+	if (Root.empty() || DevicePath.compare(0, Devices.size(), Devices) != 0)
+	{
+		return {};
+	}
+
+	std::error_code Error;
+	for (fs::path Current(DevicePath); Current.string().size() > Devices.size(); Current = Current.parent_path())
+	{
+		unsigned int Bus = 0;
+		if (parse_hid_device_bus(Current.filename().string(), Bus) && Bus != kBusUsb)
+		{
+			// Bluetooth or uhid: the USB device further up is the adapter, shared by every controller
+			// on it. No sound card belongs to the controller, the HID device itself identifies it.
+			return Current.string();
+		}
+		if (fs::exists(Current / "idVendor", Error))
+		{
+			return Current.string();
+		}
+	}
+	return {};
+}
+
+void linux_audio_topology::rebuild()
+{
+	std::vector<linux_sound_card> Found;
+	std::error_code Error;
+	for (const fs::directory_entry& Entry : fs::directory_iterator(Root + "/class/sound", Error))
+	{
+		const std::string Name = Entry.path().filename().string();
+		linux_sound_card Card;
+		if (Name.compare(0, 4, "card") != 0 || !parse_int(std::string_view(Name).substr(4), Card.Index))
+		{
+			continue;
+		}
+
+		Card.Id = read_line(Entry.path() / "id");
+		// cardN is a link into the device tree: .../<usb device>/<audio interface>/sound/cardN.
+		const std::string CardPath = canonical_path(Entry.path());
+		Card.Container = container_of(CardPath);
+		Card.SinkKeys = usb_sink_keys(CardPath, Card.Container);
+		Found.push_back(std::move(Card));
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	Cards = std::move(Found);
+	ByContainer.clear();
+	ByCardId.clear();
+	BySinkKey.clear();
+	ByIndex.clear();
+	std::unordered_map<std::string, int> KeyUses;
+	for (std::size_t i = 0; i < Cards.size(); ++i)
+	{
+		if (!Cards[i].Container.empty())
+		{
+			ByContainer.emplace(Cards[i].Container, i);
+		}
+		if (!Cards[i].Id.empty())
+		{
+			ByCardId.emplace(Cards[i].Id, i);
+		}
+		ByIndex.emplace(Cards[i].Index, i);
+		for (const std::string& Key : Cards[i].SinkKeys)
+		{
+			if (++KeyUses[Key] == 1)
+			{
+				BySinkKey.emplace(Key, i);
+			}
+			else
+			{
+				BySinkKey.erase(Key);
+			}
+		}
+	}
+}
+
+std::string linux_audio_topology::container_for_hid(std::string_view HidPath) const
+{
+	const std::size_t NameStart = HidPath.rfind('/');
+	const std::string_view Name = NameStart == std::string_view::npos ? HidPath : HidPath.substr(NameStart + 1);
+	if (Name.compare(0, 6, "hidraw") != 0)
+	{
+		return {};
+	}
+	return container_of(canonical_path(Root + "/class/hidraw/" + std::string(Name)));
+}
+
+int linux_audio_topology::card_for_container(std::string_view Container) const
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	const auto It = ByContainer.find(std::string(Container));
+	return It == ByContainer.end() ? -1 : Cards[It->second].Index;
+}
+
+std::string linux_audio_topology::container_for_card(int CardIndex) const
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	const auto It = ByIndex.find(CardIndex);
+	return It == ByIndex.end() ? std::string() : Cards[It->second].Container;
+}
+
+int linux_audio_topology::card_for_alsa_id(std::string_view AlsaId) const
+{
+	// <plugin>:<args>, where args is "N[,M]" or a list of KEY=value pairs with CARD among them.
+	const std::size_t Colon = AlsaId.find(':');
+	if (Colon == std::string_view::npos)
+	{
+		return -1;
+	}
+	const std::string_view Args = AlsaId.substr(Colon + 1);
+
+	const std::size_t CardKey = Args.find("CARD=");
+	if (CardKey == std::string_view::npos)
+	{
+		int Index = -1;
+		return parse_int(Args.substr(0, Args.find(',')), Index) ? Index : -1;
+	}
+
+	std::string_view Card = Args.substr(CardKey + 5);
+	Card = Card.substr(0, Card.find(','));
+	int Index = -1;
+	if (parse_int(Card, Index))
+	{
+		return Index;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	const auto It = ByCardId.find(std::string(Card));
+	return It == ByCardId.end() ? -1 : Cards[It->second].Index;
+}
+
+int linux_audio_topology::card_for_sink_name(std::string_view SinkName) const
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	for (const auto& [Key, Index] : BySinkKey)
+	{
+		if (SinkName.find(Key) != std::string_view::npos)
+		{
+			return Cards[Index].Index;
+		}
+	}
+	return -1;
+}
+
+std::vector<linux_sound_card> linux_audio_topology::cards() const
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	return Cards;
+}
+#endif
+#endif
@@ -0,0 +1,73 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Utils/SoDefines.h"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief One ALSA card and the physical device it belongs to.
+ */
+struct linux_sound_card
+{
+	int Index = -1;
+	// /sys/class/sound/cardN/id, the name ALSA accepts as CARD=<Id>.
+	std::string Id;
+	// Canonical sysfs path of the physical device, see linux_audio_topology::container_of().
+	std::string Container;
+	// What PulseAudio and PipeWire name the card's sinks after, see linux_audio_topology::card_for_sink_name().
+	std::vector<std::string> SinkKeys;
+};
+
+/**
+ * @brief Maps controllers to their ALSA card through the sysfs device tree.
+ *
+ * A USB controller's hidraw node and its sound card hang off different interfaces of the same
+ * USB device, so both resolve to that device's directory, which plays the role of Windows'
+ * container ID. rebuild() indexes every card by container and by ALSA id once, so matching a
+ * controller, or any ALSA device id, is a hash lookup instead of a name scan over every playback
+ * device. The sysfs root is a parameter so the matching can be tested against a fake tree.
+ */
+class linux_audio_topology
+{
+public:
+	// Topology of the real /sys, shared by the backends.
+	static linux_audio_topology& Get();
+
+	explicit linux_audio_topology(std::string SysfsRoot = "/sys");
+
+	// Re-reads <root>/class/sound. Cheap (one readlink per card); call it before matching a new controller.
+	void rebuild();
+
+	// Container of a hidraw node given as /dev/hidrawN or hidrawN; empty when it cannot be resolved.
+	std::string container_for_hid(std::string_view HidPath) const;
+	// Card of a container, -1 when the device has none (a Bluetooth controller, for instance).
+	int card_for_container(std::string_view Container) const;
+	std::string container_for_card(int CardIndex) const;
+	// Card an ALSA device id refers to: "hw:1,0", "plughw:1", ":1,0" or "front:CARD=Controller,DEV=0".
+	int card_for_alsa_id(std::string_view AlsaId) const;
+	// Card a sound server sink belongs to, e.g. "alsa_output.pci-0000_00_14.0-usb-0_2_1.0.analog-stereo".
+	// Sinks are named after udev's ID_PATH or ID_ID of the card; a key two cards share identifies
+	// neither. -1 when no card matches.
+	int card_for_sink_name(std::string_view SinkName) const;
+
+	std::vector<linux_sound_card> cards() const;
+
+	// Nearest ancestor of a canonical sysfs device path that is a USB device (has idVendor); for HID
+	// devices on other buses, the HID device itself. Empty when Path is outside <root>/devices.
+	std::string container_of(const std::string& DevicePath) const;
+
+private:
+	std::string Root;
+
+	mutable gc_lock::mutex Mutex;
+	std::vector<linux_sound_card> Cards;
+	std::unordered_map<std::string, std::size_t> ByContainer;
+	std::unordered_map<std::string, std::size_t> ByCardId;
+	std::unordered_map<std::string, std::size_t> BySinkKey;
+	std::unordered_map<int, std::size_t> ByIndex;
+};
+#endif
@@ -0,0 +1,339 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "linux_calibration_cache.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#ifdef __unix__
+#include "GImplementations/Utils/GamepadSensors.h"
+#include "linux_device_info.h"
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+static constexpr const char* kFileHeader = "# gamepad-core calibration cache v1";
+// Longest key kept; linux_hid_writer tasks carry it in their report buffer.
+static constexpr std::size_t kMaxIdentity = 96;
+static_assert(kMaxIdentity <= linux_hid_writer::kMaxReportSize, "identity must fit in a writer command");
+
+static void parse_report(const unsigned char* Report, FGamepadCalibration& OutCalibration)
+{
+	unsigned char FeatureBuffer[linux_calibration_cache::kReportSize];
+	std::memcpy(FeatureBuffer, Report, sizeof(FeatureBuffer));
+
+	using namespace FGamepadSensors;
+	DualSenseCalibrationSensors(FeatureBuffer, OutCalibration);
+}
+
+// mkdir -p of the directory part of FilePath.
+static bool make_parent_dirs(const std::string& FilePath)
+{
+	for (std::size_t Slash = FilePath.find('/', 1); Slash != std::string::npos; Slash = FilePath.find('/', Slash + 1))
+	{
+		const std::string Dir = FilePath.substr(0, Slash);
+		if (mkdir(Dir.c_str(), 0700) != 0 && errno != EEXIST)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+linux_calibration_cache& linux_calibration_cache::Get()
+{
+	static linux_calibration_cache Instance;
+	return Instance;
+}
+
+bool linux_calibration_cache::identity_for_path(std::string_view Path, std::string& OutIdentity)
+{
+	OutIdentity.clear();
+	const std::size_t NameStart = Path.rfind('/');
+	if (NameStart == std::string_view::npos || Path.substr(NameStart + 1, 6) != "hidraw")
+	{
+		return false;
+	}
+
+	char UeventPath[PATH_MAX];
+	const std::string_view Name = Path.substr(NameStart + 1);
+	if (std::snprintf(UeventPath, sizeof(UeventPath), "/sys/class/hidraw/%.*s/device/uevent", (int)Name.size(), Name.data()) >= (int)sizeof(UeventPath))
+	{
+		return false;
+	}
+	FILE* File = std::fopen(UeventPath, "r");
+	if (!File)
+	{
+		return false;
+	}
+
+	std::uint32_t Bus = 0;
+	std::uint32_t Vendor = 0;
+	std::uint32_t Product = 0;
+	bool bHasId = false;
+	char Uniq[64] = {0};
+	char Line[256];
+	while (std::fgets(Line, sizeof(Line), File))
+	{
+		if (std::sscanf(Line, "HID_ID=%x:%x:%x", &Bus, &Vendor, &Product) == 3)
+		{
+			bHasId = true;
+		}
+		else if (std::strncmp(Line, "HID_UNIQ=", 9) == 0)
+		{
+			std::snprintf(Uniq, sizeof(Uniq), "%s", Line + 9);
+			Uniq[std::strcspn(Uniq, "\r\n")] = '\0';
+		}
+	}
+	std::fclose(File);
+
+	// USB controllers without a serial string have an empty HID_UNIQ: nothing to key on.
+	if (!bHasId || Uniq[0] == '\0' || std::strpbrk(Uniq, " \t") != nullptr)
+	{
+		return false;
+	}
+
+	char Identity[kMaxIdentity];
+	if (std::snprintf(Identity, sizeof(Identity), "%04x:%04x:%04x:%s", Bus, Vendor, Product, Uniq) >= (int)sizeof(Identity))
+	{
+		return false;
+	}
+	OutIdentity = Identity;
+	return true;
+}
+
+std::string linux_calibration_cache::default_file_path()
+{
+	if (const char* Override = std::getenv("GAMEPAD_CORE_CALIBRATION_CACHE"); Override && *Override)
+	{
+		return Override;
+	}
+	if (const char* CacheHome = std::getenv("XDG_CACHE_HOME"); CacheHome && *CacheHome == '/')
+	{
+		return std::string(CacheHome) + "/gamepad-core/calibration";
+	}
+	if (const char* Home = std::getenv("HOME"); Home && *Home == '/')
+	{
+		return std::string(Home) + "/.cache/gamepad-core/calibration";
+	}
+	return {};
+}
+
+void linux_calibration_cache::load(const std::string& Path)
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	load_locked(Path);
+}
+
+void linux_calibration_cache::load_locked(const std::string& Path)
+{
+	bLoaded = true;
+	FilePath = Path;
+	Entries.clear();
+
+	FILE* File = FilePath.empty() ? nullptr : std::fopen(FilePath.c_str(), "r");
+	if (!File)
+	{
+		return;
+	}
+
+	// One "<identity> <report as hex>" line per controller; anything malformed is skipped.
+	char Line[kMaxIdentity + kReportSize * 2 + 8];
+	while (std::fgets(Line, sizeof(Line), File))
+	{
+		char* Separator = std::strchr(Line, ' ');
+		if (Line[0] == '#' || !Separator)
+		{
+			continue;
+		}
+		*Separator = '\0';
+		const char* Hex = Separator + 1;
+		if (std::strcspn(Hex, "\r\n") != kReportSize * 2)
+		{
+			continue;
+		}
+
+		entry Entry;
+		bool bValid = true;
+		for (std::size_t i = 0; i < kReportSize && bValid; ++i)
+		{
+			unsigned int Byte = 0;
+			bValid = std::sscanf(Hex + i * 2, "%2x", &Byte) == 1;
+			Entry.Report[i] = static_cast<unsigned char>(Byte);
+		}
+		if (bValid && Entry.Report[0] == kReportId)
+		{
+			parse_report(Entry.Report.data(), Entry.Calibration);
+			Entries.insert_or_assign(std::string(Line), Entry);
+		}
+	}
+	std::fclose(File);
+}
+
+void linux_calibration_cache::ensure_loaded()
+{
+	if (bLoaded)
+	{
+		return;
+	}
+
+	load_locked(default_file_path());
+}
+
+bool linux_calibration_cache::save() const
+{
+	// Called with Mutex held. Written to a temporary and renamed so a crash never leaves half a file.
+	if (FilePath.empty() || !make_parent_dirs(FilePath))
+	{
+		return false;
+	}
+
+	const std::string Temporary = FilePath + ".tmp";
+	FILE* File = std::fopen(Temporary.c_str(), "w");
+	if (!File)
+	{
+		return false;
+	}
+
+	std::fprintf(File, "%s\n", kFileHeader);
+	for (const auto& [Identity, Entry] : Entries)
+	{
+		std::fprintf(File, "%s ", Identity.c_str());
+		for (unsigned char Byte : Entry.Report)
+		{
+			std::fprintf(File, "%02x", Byte);
+		}
+		std::fputc('\n', File);
+	}
+
+	const bool bWritten = std::fflush(File) == 0 && !std::ferror(File);
+	std::fclose(File);
+	if (!bWritten || std::rename(Temporary.c_str(), FilePath.c_str()) != 0)
+	{
+		std::remove(Temporary.c_str());
+		return false;
+	}
+	return true;
+}
+
+void linux_calibration_cache::store(std::string_view Identity, const report& Report)
+{
+	// Called with Mutex held.
+	entry Entry;
+	Entry.Report = Report;
+	parse_report(Report.data(), Entry.Calibration);
+	Entries.insert_or_assign(std::string(Identity), Entry);
+	save();
+}
+
+bool linux_calibration_cache::resolve(std::string_view Path, FPlatformDeviceHandle Handle, FReadReportFn ReadReport,
+                                      FGamepadCalibration& OutCalibration, std::string& OutIdentity, bool& bOutCached)
+{
+	bOutCached = false;
+	OutIdentity.clear();
+	const bool bCacheable = linux_device_info::get_config().bCalibrationCache && identity_for_path(Path, OutIdentity);
+	if (bCacheable)
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		ensure_loaded();
+		const auto It = Entries.find(OutIdentity);
+		if (It != Entries.end())
+		{
+			OutCalibration = It->second.Calibration;
+			bOutCached = true;
+			Hits.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	report Report{};
+	Report[0] = kReportId;
+	if (!ReadReport(Handle, Report.data(), Report.size()))
+	{
+		return false;
+	}
+	parse_report(Report.data(), OutCalibration);
+
+	if (bCacheable)
+	{
+		Misses.fetch_add(1, std::memory_order_relaxed);
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		store(OutIdentity, Report);
+	}
+	return true;
+}
+
+bool linux_calibration_cache::schedule_validation(FPlatformDeviceHandle Handle, const std::string& Identity, linux_hid_writer::FTaskFn Validate)
+{
+	return linux_hid_writer::Get().enqueue_task(Handle, Validate, reinterpret_cast<const unsigned char*>(Identity.data()), Identity.size());
+}
+
+void linux_calibration_cache::validate(FPlatformDeviceHandle Handle, std::string_view Identity, FReadReportFn ReadReport)
+{
+	report Report{};
+	Report[0] = kReportId;
+	if (!ReadReport(Handle, Report.data(), Report.size()))
+	{
+		// A failing device is handled by the next read or write; keep the entry.
+		return;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	const auto It = Entries.find(Identity);
+	if (It != Entries.end() && It->second.Report == Report)
+	{
+		Validated.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Invalidated.fetch_add(1, std::memory_order_relaxed);
+	store(Identity, Report);
+	if (Updates.insert_or_assign(Handle, Entries.find(Identity)->second.Calibration).second)
+	{
+		UpdateCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+bool linux_calibration_cache::take_update(FPlatformDeviceHandle Handle, FGamepadCalibration& OutCalibration)
+{
+	if (UpdateCount.load(std::memory_order_relaxed) == 0)
+	{
+		return false;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	const auto It = Updates.find(Handle);
+	if (It == Updates.end())
+	{
+		return false;
+	}
+	OutCalibration = It->second;
+	Updates.erase(It);
+	UpdateCount.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+void linux_calibration_cache::forget(FPlatformDeviceHandle Handle)
+{
+	if (UpdateCount.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	if (Updates.erase(Handle) > 0)
+	{
+		UpdateCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+linux_calibration_statistics linux_calibration_cache::statistics()
+{
+	linux_calibration_statistics Stats;
+	Stats.Hits = Hits.load(std::memory_order_relaxed);
+	Stats.Misses = Misses.load(std::memory_order_relaxed);
+	Stats.Validated = Validated.load(std::memory_order_relaxed);
+	Stats.Invalidated = Invalidated.load(std::memory_order_relaxed);
+	return Stats;
+}
+#endif
+#endif
@@ -0,0 +1,101 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/Structs/Config/GamepadCalibration.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "GCore/Utils/SoDefines.h"
+#include "linux_hid_writer.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct linux_calibration_statistics
+{
+	// Opens that took the calibration from the cache and skipped the feature report.
+	std::uint64_t Hits = 0;
+	// Opens of a device with a known identity that still had to read the report.
+	std::uint64_t Misses = 0;
+	// Background re-reads that matched the cached report, and the ones that did not.
+	std::uint64_t Validated = 0;
+	std::uint64_t Invalidated = 0;
+};
+
+/**
+ * @brief Calibration feature reports of known controllers, persisted across sessions.
+ *
+ * Entries are keyed by "<bus>:<vendor>:<product>:<uniq>", where uniq is the serial or MAC
+ * address the kernel exposes as HID_UNIQ, and the file is read on first use. A cache hit
+ * lets a reconnecting controller skip the blocking feature report round trip. The report is
+ * then re-read lazily on linux_hid_writer: when it changed, the entry is rewritten and the
+ * owner thread picks the new calibration up with take_update().
+ */
+class linux_calibration_cache
+{
+public:
+	static constexpr unsigned char kReportId = 0x05;
+	static constexpr std::size_t kReportSize = 41;
+	// Blocking read of the calibration feature report; Report[0] holds kReportId on entry.
+	using FReadReportFn = bool (*)(FPlatformDeviceHandle Handle, unsigned char* Report, std::size_t Length);
+
+	static linux_calibration_cache& Get();
+
+	// Identity of the device behind a /dev/hidrawN path; false when it exposes no serial or MAC.
+	static bool identity_for_path(std::string_view Path, std::string& OutIdentity);
+	// $GAMEPAD_CORE_CALIBRATION_CACHE, else $XDG_CACHE_HOME or ~/.cache + /gamepad-core/calibration.
+	static std::string default_file_path();
+
+	// Replaces the cache with the content of FilePath (missing file = empty cache); later stores go there too.
+	void load(const std::string& FilePath);
+	// Calibration of the device at Path: from the cache when possible (bOutCached), otherwise read
+	// with ReadReport and remembered. OutIdentity is empty when the device cannot be cached.
+	bool resolve(std::string_view Path, FPlatformDeviceHandle Handle, FReadReportFn ReadReport,
+	             FGamepadCalibration& OutCalibration, std::string& OutIdentity, bool& bOutCached);
+	// Queues Validate on linux_hid_writer for an adopted handle whose calibration came from the cache.
+	static bool schedule_validation(FPlatformDeviceHandle Handle, const std::string& Identity, linux_hid_writer::FTaskFn Validate);
+	// Writer-thread half of the lazy validation of a cache hit.
+	void validate(FPlatformDeviceHandle Handle, std::string_view Identity, FReadReportFn ReadReport);
+	// True once when validate() found a newer calibration for Handle.
+	bool take_update(FPlatformDeviceHandle Handle, FGamepadCalibration& OutCalibration);
+	// Drops a pending update of a handle that is being closed.
+	void forget(FPlatformDeviceHandle Handle);
+
+	linux_calibration_statistics statistics();
+
+private:
+	linux_calibration_cache() = default;
+
+	using report = std::array<unsigned char, kReportSize>;
+
+	struct entry
+	{
+		report Report{};
+		FGamepadCalibration Calibration;
+	};
+
+	// Called with Mutex held.
+	void ensure_loaded();
+	void load_locked(const std::string& Path);
+	void store(std::string_view Identity, const report& Report);
+	bool save() const;
+
+	gc_lock::mutex Mutex;
+	bool bLoaded = false;
+	std::string FilePath;
+	std::map<std::string, entry, std::less<>> Entries;
+
+	// Written only when a validation fails; UpdateCount keeps take_update() lock-free otherwise.
+	std::atomic<std::uint32_t> UpdateCount{0};
+	std::unordered_map<FPlatformDeviceHandle, FGamepadCalibration> Updates;
+
+	std::atomic<std::uint64_t> Hits{0};
+	std::atomic<std::uint64_t> Misses{0};
+	std::atomic<std::uint64_t> Validated{0};
+	std::atomic<std::uint64_t> Invalidated{0};
+};
+#endif
@@ -0,0 +1,248 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+static constexpr std::uint16_t SONY_VENDOR_ID = 0x054C;
+static constexpr std::uint16_t DUALSHOCK4_PID_V1 = 0x05C4;
+static constexpr std::uint16_t DUALSHOCK4_PID_V2 = 0x09CC;
+static constexpr std::uint16_t DUALSENSE_PID = 0x0CE6;
+static constexpr std::uint16_t DUALSENSE_EDGE_PID = 0x0DF2;
+
+struct linux_supported_device
+{
+	std::uint16_t ProductId;
+	EDSDeviceType DeviceType;
+};
+
+inline constexpr linux_supported_device kSupportedDevices[] = {
+    {DUALSHOCK4_PID_V1, EDSDeviceType::DualShock4},
+    {DUALSHOCK4_PID_V2, EDSDeviceType::DualShock4},
+    {DUALSENSE_PID, EDSDeviceType::DualSense},
+    {DUALSENSE_EDGE_PID, EDSDeviceType::DualSenseEdge}};
+
+/** @brief Device type of a Sony product id, or false when the controller is not supported. */
+constexpr bool linux_find_device_type(std::uint16_t ProductId, EDSDeviceType& OutDeviceType)
+{
+	for (const linux_supported_device& Device : kSupportedDevices)
+	{
+		if (Device.ProductId == ProductId)
+		{
+			OutDeviceType = Device.DeviceType;
+			return true;
+		}
+	}
+	return false;
+}
+
+static_assert([] {
+	EDSDeviceType Type{};
+	return linux_find_device_type(DUALSENSE_EDGE_PID, Type) && Type == EDSDeviceType::DualSenseEdge && !linux_find_device_type(0, Type);
+}());
+
+/**
+ * @brief What detection needs to know about one controller: fixed-size, so lists of them can be
+ * rebuilt every poll without touching the heap.
+ */
+struct linux_detected_device
+{
+	static constexpr std::size_t kMaxPath = 96;
+	char Path[kMaxPath] = {0};
+	EDSDeviceType DeviceType = EDSDeviceType::DualSense;
+	EDSDeviceConnection ConnectionType = EDSDeviceConnection::Usb;
+	// CLOCK_MONOTONIC of the enumeration that first found the device; both open paths measure from it.
+	std::uint64_t DetectedAtNs = 0;
+
+	// A hidraw node number can be reused by a different controller between two polls.
+	bool same_device(const char* OtherPath, EDSDeviceType OtherType, EDSDeviceConnection OtherConnection) const
+	{
+		return DeviceType == OtherType && ConnectionType == OtherConnection && std::strncmp(Path, OtherPath, kMaxPath) == 0;
+	}
+};
+
+/**
+ * @brief Diffs successive enumerations by path (and device type, see same_device()).
+ *
+ * A backend calls begin(), add() for every supported controller it finds and commit(), which
+ * reports what appeared and disappeared since the previous commit(). Lists are reserved up front
+ * and only cleared, so as long as fewer than kReserved controllers are present nothing allocates.
+ */
+class linux_device_tracker
+{
+public:
+	static constexpr std::size_t kReserved = 64;
+
+	linux_device_tracker()
+	{
+		Previous.reserve(kReserved);
+		Current.reserve(kReserved);
+	}
+
+	void begin() { Current.clear(); }
+
+	void add(const char* Path, EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType)
+	{
+		linux_detected_device& Device = Current.emplace_back();
+		std::strncpy(Device.Path, Path, linux_detected_device::kMaxPath - 1);
+		Device.DeviceType = DeviceType;
+		Device.ConnectionType = ConnectionType;
+
+		// A device seen before keeps its detection time. Order is stable, so try the same slot first.
+		const std::size_t Slot = Current.size() - 1;
+		if (Slot < Previous.size() && Previous[Slot].same_device(Path, DeviceType, ConnectionType))
+		{
+			Device.DetectedAtNs = Previous[Slot].DetectedAtNs;
+		}
+		else if (const linux_detected_device* Known = find(Previous, Path, DeviceType, ConnectionType))
+		{
+			Device.DetectedAtNs = Known->DetectedAtNs;
+		}
+	}
+
+	// Clears and fills Added/Removed; returns true when either is non-empty. NowNs becomes the
+	// detection time of the added devices.
+	bool commit(std::vector<linux_detected_device>& Added, std::vector<linux_detected_device>& Removed, std::uint64_t NowNs)
+	{
+		Added.clear();
+		Removed.clear();
+		// Enumeration order is stable, so an unchanged set is confirmed in one linear pass.
+		if (same_in_order(Current, Previous))
+		{
+			Previous.swap(Current);
+			return false;
+		}
+
+		for (linux_detected_device& Device : Current)
+		{
+			if (!contains(Previous, Device.Path, Device.DeviceType, Device.ConnectionType))
+			{
+				Device.DetectedAtNs = NowNs;
+				Added.push_back(Device);
+			}
+		}
+		for (const linux_detected_device& Device : Previous)
+		{
+			if (!contains(Current, Device.Path, Device.DeviceType, Device.ConnectionType))
+			{
+				Removed.push_back(Device);
+			}
+		}
+		Previous.swap(Current);
+		return !Added.empty() || !Removed.empty();
+	}
+
+	const std::vector<linux_detected_device>& devices() const { return Previous; }
+
+	// Detection time of the device at Path as of the last commit(); 0 when it is not present.
+	std::uint64_t detected_at(const char* Path) const
+	{
+		for (const linux_detected_device& Device : Previous)
+		{
+			if (std::strncmp(Device.Path, Path, linux_detected_device::kMaxPath) == 0)
+			{
+				return Device.DetectedAtNs;
+			}
+		}
+		return 0;
+	}
+
+	static const linux_detected_device* find(const std::vector<linux_detected_device>& Devices, const char* Path, EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType)
+	{
+		for (const linux_detected_device& Device : Devices)
+		{
+			if (Device.same_device(Path, DeviceType, ConnectionType))
+			{
+				return &Device;
+			}
+		}
+		return nullptr;
+	}
+
+	static bool contains(const std::vector<linux_detected_device>& Devices, const char* Path, EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType)
+	{
+		return find(Devices, Path, DeviceType, ConnectionType) != nullptr;
+	}
+
+	static bool same_in_order(const std::vector<linux_detected_device>& Left, const std::vector<linux_detected_device>& Right)
+	{
+		if (Left.size() != Right.size())
+		{
+			return false;
+		}
+		for (std::size_t i = 0; i < Left.size(); ++i)
+		{
+			if (!Left[i].same_device(Right[i].Path, Right[i].DeviceType, Right[i].ConnectionType))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+private:
+	std::vector<linux_detected_device> Previous;
+	std::vector<linux_detected_device> Current;
+};
+
+/**
+ * @brief Brings a caller-owned context list in line with Present, editing it in place.
+ *
+ * Contexts whose path is gone are erased and new controllers appended; contexts that are still
+ * present are left untouched, so a caller that keeps its list between calls pays nothing (no
+ * copy, no allocation) while the set of controllers is stable.
+ */
+inline void linux_reconcile_devices(const std::vector<linux_detected_device>& Present, std::vector<FDeviceContext>& Devices)
+{
+	if (Devices.size() == Present.size())
+	{
+		std::size_t Matching = 0;
+		while (Matching < Present.size() &&
+		       Present[Matching].same_device(Devices[Matching].Path.c_str(), Devices[Matching].DeviceType, Devices[Matching].ConnectionType))
+		{
+			++Matching;
+		}
+		if (Matching == Present.size())
+		{
+			return;
+		}
+	}
+
+	for (std::size_t i = Devices.size(); i-- > 0;)
+	{
+		const FDeviceContext& Context = Devices[i];
+		if (!linux_device_tracker::contains(Present, Context.Path.c_str(), Context.DeviceType, Context.ConnectionType))
+		{
+			Devices.erase(Devices.begin() + static_cast<std::ptrdiff_t>(i));
+		}
+	}
+
+	for (const linux_detected_device& Device : Present)
+	{
+		bool bKnown = false;
+		for (const FDeviceContext& Context : Devices)
+		{
+			if (Device.same_device(Context.Path.c_str(), Context.DeviceType, Context.ConnectionType))
+			{
+				bKnown = true;
+				break;
+			}
+		}
+		if (bKnown)
+		{
+			continue;
+		}
+
+		FDeviceContext& NewDeviceContext = Devices.emplace_back();
+		NewDeviceContext.Path = Device.Path;
+		NewDeviceContext.DeviceType = Device.DeviceType;
+		NewDeviceContext.ConnectionType = Device.ConnectionType;
+		NewDeviceContext.IsConnected = true;
+		NewDeviceContext.Handle = nullptr;
+	}
+}
+#endif
@@ -5,17 +5,121 @@
 #include "GCore/Types/ECoreGamepad.h"
 #include "GCore/Types/Structs/Config/GamepadCalibration.h"
 #include "GCore/Types/Structs/Context/DeviceContext.h"
-#include "GImplementations/Utils/GamepadSensors.h"
 #include "SDL_hidapi.h"
+#include "linux_audio_topology.h"
+#include "linux_calibration_cache.h"
+#include "linux_device_opener.h"
+#include "linux_hid_writer.h"
+#include "linux_hotplug_monitor.h"
+#include "linux_input_reactor.h"
+#include <algorithm>
 #include <cstring>
 #include <string>
-#include <unordered_set>
 
-static const std::uint16_t SONY_VENDOR_ID = 0x054C;
-static const std::uint16_t DUALSHOCK4_PID_V1 = 0x05C4;
-static const std::uint16_t DUALSHOCK4_PID_V2 = 0x09CC;
-static const std::uint16_t DUALSENSE_PID = 0x0CE6;
-static const std::uint16_t DUALSENSE_EDGE_PID = 0x0DF2;
+static linux_device_config GConfig;
+// Controllers seen by the last enumeration and the hotplug generation they belong to.
+static linux_device_tracker GTracker;
+static std::vector<linux_detected_device> GAdded;
+static std::vector<linux_detected_device> GRemoved;
+static std::vector<linux_detected_device> GPublished;
+static std::uint64_t GDetectedGeneration = 0;
+// HID_ID bus of a USB device, from <linux/input.h>.
+static constexpr std::uint32_t kBusUsb = 0x03;
+
+static int sdl_write(FPlatformDeviceHandle Handle, const unsigned char* Data, std::size_t Length)
+{
+	return SDL_hid_write(static_cast<SDL_hid_device*>(Handle), Data, Length);
+}
+
+static bool sdl_read_calibration_report(FPlatformDeviceHandle Handle, unsigned char* Report, std::size_t Length)
+{
+	return SDL_hid_get_feature_report(static_cast<SDL_hid_device*>(Handle), Report, Length) > 0;
+}
+
+// linux_hid_writer task: Data is the linux_calibration_cache identity of the device.
+static void sdl_validate_calibration(FPlatformDeviceHandle Handle, const unsigned char* Data, std::size_t Length)
+{
+	linux_calibration_cache::Get().validate(Handle, std::string_view(reinterpret_cast<const char*>(Data), Length), &sdl_read_calibration_report);
+}
+
+static bool sdl_resolve_calibration(const std::string& Path, linux_prepared_device& Prepared)
+{
+	return linux_calibration_cache::Get().resolve(Path, Prepared.Handle, &sdl_read_calibration_report,
+	                                              Prepared.Calibration, Prepared.Identity, Prepared.bCalibrationCached);
+}
+
+// linux_device_opener worker: the blocking part of create_handle().
+static bool sdl_open_prepared(const std::string& Path, linux_prepared_device& Out)
+{
+	SDL_hid_device* DeviceHandle = SDL_hid_open_path(Path.c_str(), true);
+	if (DeviceHandle == INVALID_PLATFORM_HANDLE)
+	{
+		return false;
+	}
+
+	SDL_hid_set_nonblocking(DeviceHandle, 1);
+	Out.Handle = DeviceHandle;
+	Out.bCalibrated = sdl_resolve_calibration(Path, Out);
+	return true;
+}
+
+static void sdl_close_prepared(FPlatformDeviceHandle Handle)
+{
+	SDL_hid_close(static_cast<SDL_hid_device*>(Handle));
+}
+
+void linux_device_info::configure(const linux_device_config& Config)
+{
+	GConfig = Config;
+	if (GConfig.MaxDrainPerTick == 0)
+	{
+		GConfig.MaxDrainPerTick = 1;
+	}
+}
+
+const linux_device_config& linux_device_info::get_config()
+{
+	return GConfig;
+}
+
+linux_device_statistics linux_device_info::get_statistics(const FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return {};
+	}
+
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	if (!State)
+	{
+		return {};
+	}
+	gc_lock::lock_guard<gc_lock::mutex> Lock(State->OutputMutex);
+	return State->Statistics;
+}
+
+linux_input_timing linux_device_info::get_timing(const FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return {};
+	}
+
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	return State ? State->Timing : linux_input_timing{};
+}
+
+const std::vector<linux_input_report>* linux_device_info::get_backlog(const FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return nullptr;
+	}
+
+	// The registry keeps the state alive until invalidate_handle(), so the pointer outlives this reference.
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	return State ? &State->Backlog : nullptr;
+}
 
 void linux_device_info::read(FDeviceContext* Context)
 {
@@ -29,29 +133,47 @@ void linux_device_info::read(FDeviceContext* Context)
 		return;
 	}
 
-	if (Context->ConnectionType == EDSDeviceConnection::Bluetooth && Context->DeviceType == EDSDeviceType::DualShock4)
+	// Writes that failed on the writer thread are handled here, on the thread that owns the device.
+	if (GConfig.bAsyncWriter && linux_hid_writer::Get().take_error(Context->Handle))
 	{
-		const size_t InputReportLength = 547;
-		std::int32_t BytesRead = 0;
-		if (poll_tick(Context->Handle, Context->BufferDS4, (std::int32_t)InputReportLength, BytesRead) == EPollResult::Disconnected)
-		{
-			invalidate_handle(Context);
-		}
+		invalidate_handle(Context);
 		return;
 	}
+	// The cached calibration turned out to be stale; the writer thread read the current one.
+	linux_calibration_cache::Get().take_update(Context->Handle, Context->Calibration);
 
-	const size_t InputReportLength = (Context->ConnectionType == EDSDeviceConnection::Bluetooth) ? 78 : 64;
-	if (sizeof(Context->Buffer) < InputReportLength)
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	if (!State)
 	{
-		invalidate_handle(Context);
 		return;
 	}
+	unsigned char* Buffer = State->Reports.bLargeInput ? Context->BufferDS4 : Context->Buffer;
+	const std::int32_t InputReportLength = State->Reports.Input;
 
 	std::int32_t BytesRead = 0;
-	if (poll_tick(Context->Handle, Context->Buffer, (std::int32_t)InputReportLength, BytesRead) == EPollResult::Disconnected)
+	EPollResult Result = EPollResult::NoIoThisTick;
+	if (GConfig.ReadMode == EReadMode::Single)
+	{
+		Result = poll_tick(Context->Handle, Buffer, InputReportLength, BytesRead);
+		if (Result == EPollResult::ReadOk)
+		{
+			linux_track_report(State.get(), Buffer, BytesRead, linux_monotonic_ns());
+		}
+		linux_record_reads(State.get(), GConfig, Result == EPollResult::ReadOk ? 1 : 0);
+	}
+	else
+	{
+		Result = drain_tick(Context->Handle, Buffer, InputReportLength, BytesRead);
+	}
+
+	if (Result == EPollResult::Disconnected)
 	{
 		invalidate_handle(Context);
+		return;
 	}
+
+	// Outputs left pending by a caller that never flushed go out with the next input poll.
+	flush_output(Context);
 }
 
 void linux_device_info::process_audio_haptic(FDeviceContext* Context)
@@ -61,44 +183,40 @@ void linux_device_info::process_audio_haptic(FDeviceContext* Context)
 		return;
 	}
 
-	SDL_hid_device* DeviceHandle = static_cast<SDL_hid_device*>(Context->Handle);
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	const std::uint16_t AudioReportLength = State ? linux_audio_report_size(State.get()) : 0;
+	if (AudioReportLength == 0)
+	{
+		return;
+	}
 
-	if (Context->ConnectionType == EDSDeviceConnection::Bluetooth)
-	{
-		// DualSense Bluetooth Audio Haptic report ID is 0x31
-		// On some Linux versions, we must ensure the report is sent with the correct ID.
-		// BufferAudio already has 0x31 at index 0.
-		
-		constexpr size_t ReportSize = 78; // Try 78 for standard haptics or 147 for advanced
-		// DualSense Bluetooth haptics often use 78-byte reports (0x31)
-		
-		int BytesWritten = SDL_hid_write(DeviceHandle, Context->BufferAudio, 147);
-		if (BytesWritten < 0)
-		{
-			// Try with 78 if 147 fails
-			SDL_hid_write(DeviceHandle, Context->BufferAudio, 78);
-		}
+	if (GConfig.bAsyncWriter)
+	{
+		linux_hid_writer::Get().enqueue(Context->Handle, &sdl_write, Context->BufferAudio, AudioReportLength, &linux_demote_audio_after_write_error);
+		return;
+	}
+
+	// BufferAudio already holds the report ID at index 0.
+	if (SDL_hid_write(static_cast<SDL_hid_device*>(Context->Handle), Context->BufferAudio, AudioReportLength) < 0)
+	{
+		linux_demote_audio_after_error(State.get(), AudioReportLength);
 	}
 }
 
 bool linux_device_info::configure_features(FDeviceContext* Context)
 {
-	SDL_hid_device* DeviceHandle = static_cast<SDL_hid_device*>(Context->Handle);
-
-	unsigned char FeatureBuffer[41] = {0};
-	std::memset(FeatureBuffer, 0, sizeof(FeatureBuffer));
-
-	FeatureBuffer[0] = 0x05;
-	if (!SDL_hid_get_feature_report(DeviceHandle, FeatureBuffer, 41))
+	linux_prepared_device Prepared;
+	Prepared.Handle = Context->Handle;
+	if (!sdl_resolve_calibration(Context->Path, Prepared))
 	{
 		return false;
 	}
 
-	using namespace FGamepadSensors;
-	FGamepadCalibration Calibration;
-	DualSenseCalibrationSensors(FeatureBuffer, Calibration);
-
-	Context->Calibration = Calibration;
+	Context->Calibration = Prepared.Calibration;
+	if (Prepared.bCalibrationCached)
+	{
+		linux_calibration_cache::schedule_validation(Context->Handle, Prepared.Identity, &sdl_validate_calibration);
+	}
 	return true;
 }
 
@@ -109,70 +227,127 @@ void linux_device_info::write(FDeviceContext* Context)
 		return;
 	}
 
-	SDL_hid_device* DeviceHandle = static_cast<SDL_hid_device*>(Context->Handle);
+	if (!linux_defer_output(linux_device_state_registry::Get().Find(Context->Handle).get(), GConfig, Context, &flush_output))
+	{
+		send_output(Context);
+	}
+}
+
+void linux_device_info::flush_output(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
 
-	const size_t InReportLength = (Context->DeviceType == EDSDeviceType::DualShock4) ? 32 : 74;
-	const size_t OutputReportLength = (Context->ConnectionType == EDSDeviceConnection::Bluetooth) ? 78 : InReportLength;
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	unsigned char Report[linux_device_state::kMaxOutputSize];
+	if (linux_claim_pending_output(State.get(), GConfig, Context->ConnectionType == EDSDeviceConnection::Bluetooth, Report))
+	{
+		send_report(Context, State.get(), Report);
+	}
+}
+
+void linux_device_info::flush_outputs()
+{
+	linux_device_state_registry::Get().FlushPendingOutputs();
+}
+
+void linux_device_info::send_output(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	send_report(Context, linux_device_state_registry::Get().Find(Context->Handle).get(), Context->GetRawOutputBuffer());
+}
+
+void linux_device_info::send_report(FDeviceContext* Context, linux_device_state* State, const unsigned char* Report)
+{
+	if (!State)
+	{
+		return;
+	}
+	const size_t OutputReportLength = State->Reports.Output;
+	const bool bBluetooth = Context->ConnectionType == EDSDeviceConnection::Bluetooth;
+	if (!linux_should_send_output(State, GConfig, Report, (std::int32_t)OutputReportLength, bBluetooth))
+	{
+		return;
+	}
+
+	if (GConfig.bAsyncWriter)
+	{
+		if (linux_hid_writer::Get().enqueue(Context->Handle, &sdl_write, Report, OutputReportLength))
+		{
+			linux_record_output(State, GConfig, Report, (std::int32_t)OutputReportLength, bBluetooth);
+		}
+		return;
+	}
 
-	int BytesWritten = SDL_hid_write(DeviceHandle, Context->GetRawOutputBuffer(), OutputReportLength);
+	int BytesWritten = SDL_hid_write(static_cast<SDL_hid_device*>(Context->Handle), Report, OutputReportLength);
 	if (BytesWritten < 0)
 	{
 		invalidate_handle(Context);
+		return;
 	}
+	linux_record_output(State, GConfig, Report, (std::int32_t)OutputReportLength, bBluetooth);
 }
 
 void linux_device_info::detect(std::vector<FDeviceContext>& Devices)
 {
-	Devices.clear();
+	detect_changes(GAdded, GRemoved);
+	if (!GConfig.bAsyncOpen)
+	{
+		linux_reconcile_devices(GTracker.devices(), Devices);
+		return;
+	}
 
-	const std::unordered_set<uint16_t> SupportedPIDs = {
-	    DUALSHOCK4_PID_V1,
-	    DUALSHOCK4_PID_V2,
-	    DUALSENSE_PID,
-	    DUALSENSE_EDGE_PID};
+	linux_device_opener::Get().publish(GTracker.devices(), GRemoved, &sdl_open_prepared, &sdl_close_prepared, GPublished);
+	linux_reconcile_devices(GPublished, Devices);
+}
 
-	SDL_hid_device_info* Devs = SDL_hid_enumerate(SONY_VENDOR_ID, 0);
-	if (!Devs)
+bool linux_device_info::detect_changes(std::vector<linux_detected_device>& Added, std::vector<linux_detected_device>& Removed)
+{
+	// With the hotplug monitor, SDL only enumerates after a hidraw node came or went.
+	linux_hotplug_monitor& Monitor = linux_hotplug_monitor::Get();
+	if (GConfig.bHotplugMonitor && Monitor.start())
 	{
-		return;
+		const std::uint64_t Generation = Monitor.generation();
+		if (Generation == GDetectedGeneration)
+		{
+			Added.clear();
+			Removed.clear();
+			return false;
+		}
+		GDetectedGeneration = Generation;
 	}
 
+	GTracker.begin();
+	SDL_hid_device_info* Devs = SDL_hid_enumerate(SONY_VENDOR_ID, 0);
 	for (SDL_hid_device_info* CurrentDevice = Devs; CurrentDevice != nullptr; CurrentDevice = CurrentDevice->next)
 	{
-		if (SupportedPIDs.contains(CurrentDevice->product_id))
+		EDSDeviceType DeviceType;
+		if (!CurrentDevice->path || !linux_find_device_type(CurrentDevice->product_id, DeviceType))
 		{
-			FDeviceContext NewDeviceContext;
-			NewDeviceContext.Path = std::string(CurrentDevice->path);
-
-			switch (CurrentDevice->product_id)
-			{
-				case DUALSHOCK4_PID_V1:
-				case DUALSHOCK4_PID_V2:
-					NewDeviceContext.DeviceType = EDSDeviceType::DualShock4;
-					break;
-				case DUALSENSE_EDGE_PID:
-					NewDeviceContext.DeviceType = EDSDeviceType::DualSenseEdge;
-					break;
-				case DUALSENSE_PID:
-				default:
-					NewDeviceContext.DeviceType = EDSDeviceType::DualSense;
-					break;
-			}
-
-			NewDeviceContext.IsConnected = true;
-			if (CurrentDevice->interface_number == -1)
-			{
-				NewDeviceContext.ConnectionType = EDSDeviceConnection::Bluetooth;
-			}
-			else
-			{
-				NewDeviceContext.ConnectionType = EDSDeviceConnection::Usb;
-			}
-			NewDeviceContext.Handle = nullptr;
-			Devices.push_back(NewDeviceContext);
+			continue;
 		}
+
+		// SDL2 has no bus type; interface_number is -1 for Bluetooth, but also for USB pads that have no
+		// USB parent device (uhid), so the kernel's bus decides those.
+		EDSDeviceConnection ConnectionType = EDSDeviceConnection::Usb;
+		linux_hidraw_node Node;
+		if (CurrentDevice->interface_number == -1 && !(linux_hotplug_monitor::read_node(CurrentDevice->path, Node) && Node.Bus == kBusUsb))
+		{
+			ConnectionType = EDSDeviceConnection::Bluetooth;
+		}
+		GTracker.add(CurrentDevice->path, DeviceType, ConnectionType);
+	}
+	if (Devs)
+	{
+		SDL_hid_free_enumeration(Devs);
 	}
-	SDL_hid_free_enumeration(Devs);
+	return GTracker.commit(Added, Removed, linux_monotonic_ns());
 }
 
 bool linux_device_info::create_handle(FDeviceContext* Context)
@@ -182,18 +357,45 @@ bool linux_device_info::create_handle(FDeviceContext* Context)
 		return false;
 	}
 
-	const char* Path = Context->Path.data();
-	const FPlatformDeviceHandle Handle = SDL_hid_open_path(Path, true);
-	if (Handle == INVALID_PLATFORM_HANDLE)
+	// Normally detect() only reported this device once a worker had opened and calibrated it.
+	linux_prepared_device Prepared;
+	const bool bPrepared = GConfig.bAsyncOpen && linux_device_opener::Get().take(Context->Path, Prepared);
+	if (!bPrepared)
 	{
-		return false;
+		Prepared.DetectedAtNs = GTracker.detected_at(Context->Path.c_str());
+		Prepared.Handle = SDL_hid_open_path(Context->Path.data(), true);
+		if (Prepared.Handle == INVALID_PLATFORM_HANDLE)
+		{
+			return false;
+		}
+		SDL_hid_set_nonblocking(static_cast<SDL_hid_device*>(Prepared.Handle), 1);
 	}
 
-	SDL_hid_device* DeviceHandle = static_cast<SDL_hid_device*>(Handle);
-	SDL_hid_set_nonblocking(DeviceHandle, 1);
+	const FPlatformDeviceHandle Handle = Prepared.Handle;
 	Context->Handle = Handle;
 
-	configure_features(Context);
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Attach(Handle, Context);
+	linux_settle_report_sizes(State.get(), Context);
+
+	if (GConfig.bInputReactor)
+	{
+		linux_input_reactor::Get().watch(Handle, Context->Path);
+	}
+
+	if (!bPrepared)
+	{
+		configure_features(Context);
+		Prepared.ReadyAtNs = linux_monotonic_ns();
+	}
+	else if (Prepared.bCalibrated)
+	{
+		Context->Calibration = Prepared.Calibration;
+		if (Prepared.bCalibrationCached)
+		{
+			linux_calibration_cache::schedule_validation(Handle, Prepared.Identity, &sdl_validate_calibration);
+		}
+	}
+	linux_record_open(State.get(), Prepared.DetectedAtNs, Prepared.ReadyAtNs);
 	return true;
 }
 
@@ -204,6 +406,12 @@ void linux_device_info::invalidate_handle(FDeviceContext* Context)
 		SDL_hid_device* DeviceHandle = static_cast<SDL_hid_device*>(Context->Handle);
 		if (DeviceHandle != nullptr)
 		{
+			linux_input_reactor::Get().unwatch(Context->Handle);
+			linux_device_state_registry::Get().Detach(Context->Handle);
+			// Reports still queued for this handle must be written before the device goes away.
+			linux_hid_writer::Get().retire(Context->Handle);
+			linux_calibration_cache::Get().forget(Context->Handle);
+			linux_device_opener::Get().release(Context->Path);
 			SDL_hid_close(DeviceHandle);
 		}
 
@@ -222,21 +430,15 @@ void linux_device_info::invalidate_handle(FDeviceContext* Context)
 
 std::string linux_device_info::get_container_id(const std::string& DevicePath)
 {
-	// No Linux, dispositivos HID no sysfs geralmente têm um link para um dispositivo "pai" que representa o hardware físico.
-	// Uma forma comum é subir na árvore do sysfs até encontrar um nó que tenha o Container ID ou usar o ID do barramento físico.
-	// Por simplicidade e compatibilidade com o que é esperado (um ID único por controle),
-	// podemos tentar extrair o endereço Bluetooth ou o caminho físico do USB se o Container ID não estiver explícito.
-
-	// No entanto, para seguir o padrão do Windows que retorna um GUID, 
-	// e considerando que o objetivo é pareamento HID + Áudio:
-	
-	// Implementação simplificada: retornar uma string vazia por enquanto ou tentar algo básico.
-	return "";
+	// The physical device behind the hidraw node; its ALSA card, if any, resolves to the same one.
+	return linux_audio_topology::Get().container_for_hid(DevicePath);
 }
 
 std::string linux_device_info::get_audio_container_id(const std::string& AudioDeviceId)
 {
-	return "";
+	const linux_audio_topology& Topology = linux_audio_topology::Get();
+	const int Card = Topology.card_for_alsa_id(AudioDeviceId);
+	return Card < 0 ? std::string() : Topology.container_for_card(Card);
 }
 
 EPollResult linux_device_info::poll_tick(FPlatformDeviceHandle Handle, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead)
@@ -263,5 +465,13 @@ EPollResult linux_device_info::poll_tick(FPlatformDeviceHandle Handle, unsigned
 	OutBytesRead = Result;
 	return EPollResult::ReadOk;
 }
+
+EPollResult linux_device_info::drain_tick(FPlatformDeviceHandle Handle, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead)
+{
+	return linux_drain_reports(linux_device_state_registry::Get().Find(Handle).get(), GConfig, Buffer, Length, OutBytesRead,
+	                           [Handle](unsigned char* Target, std::int32_t TargetLength, std::int32_t& BytesRead) {
+		                           return poll_tick(Handle, Target, TargetLength, BytesRead);
+	                           });
+}
 #endif
 #endif
@@ -3,18 +3,13 @@
 #ifdef BUILD_GAMEPAD_CORE_TESTS
 
 #include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "linux_device_detection.h"
+#include "linux_device_state.h"
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
-enum class EPollResult
-{
-	ReadOk,
-	NoIoThisTick,
-	TransientError,
-	Disconnected
-};
-
 class linux_device_info
 {
 public:
@@ -23,12 +18,32 @@ public:
 	static bool configure_features(FDeviceContext* Context);
 	static void read(FDeviceContext* Context);
 	static void write(FDeviceContext* Context);
+	// Sends the output report now, bypassing coalescing (change suppression still applies).
+	static void send_output(FDeviceContext* Context);
+	// send_output() for a report held outside the context, such as the copy flush_output() claimed.
+	static void send_report(FDeviceContext* Context, linux_device_state* State, const unsigned char* Report);
+	// Sends the coalesced output of this device if one is pending and its rate cap allows it.
+	static void flush_output(FDeviceContext* Context);
+	// Flushes the pending outputs of every open Linux device, whatever its backend. Call once per
+	// tick from the thread that runs the registry loop; it writes through the owning contexts.
+	static void flush_outputs();
+	// Reconciles Devices in place with the controllers present: stale entries are erased, new ones appended.
 	static void detect(std::vector<FDeviceContext>& Devices);
+	// Controllers that appeared or disappeared since the previous call; false when nothing changed.
+	static bool detect_changes(std::vector<linux_detected_device>& Added, std::vector<linux_detected_device>& Removed);
 	static bool create_handle(FDeviceContext* Context);
 	static void invalidate_handle(FDeviceContext* Context);
 	static std::string get_container_id(const std::string& DevicePath);
 	static std::string get_audio_container_id(const std::string& AudioDeviceId);
 	static EPollResult poll_tick(FPlatformDeviceHandle Handle, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead);
+	static EPollResult drain_tick(FPlatformDeviceHandle Handle, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead);
+	static void configure(const linux_device_config& Config);
+	static const linux_device_config& get_config();
+	static linux_device_statistics get_statistics(const FDeviceContext* Context);
+	// Host and device timing of the newest report read for Context.
+	static linux_input_timing get_timing(const FDeviceContext* Context);
+	// Reports drained by the last read() in EReadMode::DrainAll, oldest first; nullptr for unknown handles.
+	static const std::vector<linux_input_report>* get_backlog(const FDeviceContext* Context);
 	static bool should_treat_as_disconnected(const std::int32_t Error)
 	{
 		// No Linux via SDL_hidapi, erros negativos geralmente indicam desconexão ou erro fatal
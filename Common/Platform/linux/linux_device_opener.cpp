@@ -0,0 +1,253 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "linux_device_opener.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#ifdef __unix__
+#include "linux_device_state.h"
+#include "linux_input_reactor.h"
+
+linux_device_opener& linux_device_opener::Get()
+{
+	static linux_device_opener Instance;
+	return Instance;
+}
+
+linux_device_opener::~linux_device_opener()
+{
+	stop();
+}
+
+void linux_device_opener::ensure_started()
+{
+	// Called with Mutex held.
+	if (bRunning.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	bRunning.store(true, std::memory_order_release);
+	for (std::uint32_t i = 0; i < kWorkers; ++i)
+	{
+		Workers.emplace_back(&linux_device_opener::run, this);
+	}
+}
+
+void linux_device_opener::stop()
+{
+	std::vector<std::thread> Joining;
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		if (!bRunning.exchange(false))
+		{
+			return;
+		}
+		Joining.swap(Workers);
+	}
+
+	Signal.fetch_add(1, std::memory_order_release);
+	Signal.notify_all();
+	for (std::thread& Worker : Joining)
+	{
+		Worker.join();
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	for (auto& [Path, Entry] : Entries)
+	{
+		if (Entry.State == EState::Ready && Entry.Close)
+		{
+			Entry.Close(Entry.Prepared.Handle);
+		}
+	}
+	Entries.clear();
+	Queue.clear();
+}
+
+void linux_device_opener::request(std::string_view Path, std::uint64_t DetectedAtNs, FOpenFn Open, FCloseFn Close)
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	auto It = Entries.find(Path);
+	if (It == Entries.end())
+	{
+		entry& Entry = Entries[std::string(Path)];
+		Entry.Open = Open;
+		Entry.Close = Close;
+		Entry.Prepared.DetectedAtNs = DetectedAtNs;
+		Queue.emplace_back(Path);
+	}
+	else if (It->second.State == EState::Failed && linux_monotonic_ns() >= It->second.RetryAtNs)
+	{
+		It->second.State = EState::Pending;
+		Queue.emplace_back(Path);
+	}
+	else
+	{
+		// Unplugged and plugged back before the worker finished: keep the job.
+		It->second.bCancelled = false;
+		return;
+	}
+
+	ensure_started();
+	Signal.fetch_add(1, std::memory_order_release);
+	Signal.notify_one();
+}
+
+bool linux_device_opener::ready(std::string_view Path)
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	const auto It = Entries.find(Path);
+	return It != Entries.end() && !It->second.bCancelled &&
+	       (It->second.State == EState::Ready || It->second.State == EState::Adopted);
+}
+
+bool linux_device_opener::take(std::string_view Path, linux_prepared_device& Out)
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	const auto It = Entries.find(Path);
+	if (It == Entries.end() || It->second.State != EState::Ready)
+	{
+		return false;
+	}
+
+	Out = It->second.Prepared;
+	It->second.State = EState::Adopted;
+	It->second.Prepared.Handle = nullptr;
+	return true;
+}
+
+void linux_device_opener::cancel(std::string_view Path)
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	const auto It = Entries.find(Path);
+	if (It == Entries.end())
+	{
+		return;
+	}
+
+	entry& Entry = It->second;
+	if (Entry.State == EState::Pending)
+	{
+		// A worker may be inside Open() right now; it closes the handle when it sees the flag.
+		Entry.bCancelled = true;
+		return;
+	}
+	if (Entry.State == EState::Ready && Entry.Close)
+	{
+		Entry.Close(Entry.Prepared.Handle);
+	}
+	Entries.erase(It);
+}
+
+void linux_device_opener::publish(const std::vector<linux_detected_device>& Present, const std::vector<linux_detected_device>& Removed,
+                                  FOpenFn Open, FCloseFn Close, std::vector<linux_detected_device>& OutReady)
+{
+	for (const linux_detected_device& Device : Removed)
+	{
+		cancel(Device.Path);
+	}
+
+	OutReady.clear();
+	for (const linux_detected_device& Device : Present)
+	{
+		if (ready(Device.Path))
+		{
+			OutReady.push_back(Device);
+		}
+		else
+		{
+			request(Device.Path, Device.DetectedAtNs, Open, Close);
+		}
+	}
+}
+
+void linux_device_opener::release(std::string_view Path)
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	const auto It = Entries.find(Path);
+	if (It != Entries.end() && It->second.State == EState::Adopted)
+	{
+		Entries.erase(It);
+	}
+}
+
+void linux_device_opener::run()
+{
+	while (bRunning.load(std::memory_order_acquire))
+	{
+		const std::uint32_t Observed = Signal.load(std::memory_order_acquire);
+
+		std::string Path;
+		FOpenFn Open = nullptr;
+		FCloseFn Close = nullptr;
+		{
+			gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+			while (!Queue.empty() && !Open)
+			{
+				Path = std::move(Queue.front());
+				Queue.pop_front();
+
+				const auto It = Entries.find(Path);
+				if (It == Entries.end() || It->second.State != EState::Pending)
+				{
+					continue;
+				}
+				if (It->second.bCancelled)
+				{
+					Entries.erase(It);
+					continue;
+				}
+				Open = It->second.Open;
+				Close = It->second.Close;
+			}
+		}
+
+		if (!Open)
+		{
+			Signal.wait(Observed, std::memory_order_acquire);
+			continue;
+		}
+
+		linux_prepared_device Prepared;
+		const bool bOpened = Open(Path, Prepared);
+		Prepared.ReadyAtNs = linux_monotonic_ns();
+
+		bool bDiscard = false;
+		{
+			gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+			const auto It = Entries.find(Path);
+			if (It == Entries.end() || It->second.bCancelled)
+			{
+				bDiscard = true;
+				if (It != Entries.end())
+				{
+					Entries.erase(It);
+				}
+			}
+			else if (bOpened)
+			{
+				Prepared.DetectedAtNs = It->second.Prepared.DetectedAtNs;
+				It->second.Prepared = Prepared;
+				It->second.State = EState::Ready;
+			}
+			else
+			{
+				It->second.State = EState::Failed;
+				It->second.RetryAtNs = Prepared.ReadyAtNs + kRetryDelayNs;
+			}
+		}
+
+		if (bOpened && bDiscard)
+		{
+			if (Close)
+			{
+				Close(Prepared.Handle);
+			}
+		}
+		else if (bOpened)
+		{
+			// Let a loop blocked in wait_until() publish the controller right away.
+			linux_input_reactor::Get().wake();
+		}
+	}
+}
+#endif
+#endif
@@ -0,0 +1,106 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/Structs/Config/GamepadCalibration.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "GCore/Utils/SoDefines.h"
+#include "linux_device_detection.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A device opened and calibrated off the game thread, waiting for create_handle() to adopt it.
+ */
+struct linux_prepared_device
+{
+	FPlatformDeviceHandle Handle = nullptr;
+	FGamepadCalibration Calibration;
+	bool bCalibrated = false;
+	// Calibration came from linux_calibration_cache; create_handle() schedules its validation.
+	bool bCalibrationCached = false;
+	std::string Identity;
+	// CLOCK_MONOTONIC when detect() first saw the device and when the worker finished with it.
+	std::uint64_t DetectedAtNs = 0;
+	std::uint64_t ReadyAtNs = 0;
+};
+
+/**
+ * @brief Small worker pool that opens and calibrates new controllers in the background.
+ *
+ * Opening a Bluetooth controller and reading its calibration feature report can take tens of
+ * milliseconds each. detect() calls request() for every controller it sees and only publishes
+ * the ones that are ready(), so the registry's create_handle() merely adopts the prepared handle
+ * with take() and several controllers connecting at once never stall the frame loop.
+ */
+class linux_device_opener
+{
+public:
+	// Blocking open + calibration; runs on a worker. Returns false when the device cannot be opened.
+	using FOpenFn = bool (*)(const std::string& Path, linux_prepared_device& Out);
+	using FCloseFn = void (*)(FPlatformDeviceHandle Handle);
+
+	static constexpr std::uint32_t kWorkers = 2;
+	// A failed open (permissions not applied yet, device busy) is retried after this long.
+	static constexpr std::uint64_t kRetryDelayNs = 500ull * 1000 * 1000;
+
+	static linux_device_opener& Get();
+
+	~linux_device_opener();
+
+	// Queues Path unless it is already pending, prepared or adopted. Cheap to call every tick.
+	// DetectedAtNs is when detection first saw the device, see linux_detected_device.
+	void request(std::string_view Path, std::uint64_t DetectedAtNs, FOpenFn Open, FCloseFn Close);
+	// True once Path is prepared or has been adopted: the registry may see it.
+	bool ready(std::string_view Path);
+	// Hands the prepared device over to the caller; false when there is none.
+	bool take(std::string_view Path, linux_prepared_device& Out);
+	// The device is gone: closes an unadopted handle now, or as soon as its worker finishes.
+	void cancel(std::string_view Path);
+	// Cancels Removed, requests every device of Present that is not ready yet and fills OutReady
+	// with the ones that are. This is what detect() hands to the registry.
+	void publish(const std::vector<linux_detected_device>& Present, const std::vector<linux_detected_device>& Removed,
+	             FOpenFn Open, FCloseFn Close, std::vector<linux_detected_device>& OutReady);
+	// The adopted handle was closed; a later request() opens the device again.
+	void release(std::string_view Path);
+	void stop();
+
+private:
+	linux_device_opener() = default;
+
+	enum class EState : std::uint8_t
+	{
+		Pending,
+		Ready,
+		Adopted,
+		Failed
+	};
+
+	struct entry
+	{
+		EState State = EState::Pending;
+		bool bCancelled = false;
+		FOpenFn Open = nullptr;
+		FCloseFn Close = nullptr;
+		linux_prepared_device Prepared;
+		std::uint64_t RetryAtNs = 0;
+	};
+
+	void ensure_started();
+	void run();
+
+	gc_lock::mutex Mutex;
+	std::map<std::string, entry, std::less<>> Entries;
+	std::deque<std::string> Queue;
+	std::vector<std::thread> Workers;
+	std::atomic<std::uint32_t> Signal{0};
+	std::atomic<bool> bRunning{false};
+};
+#endif
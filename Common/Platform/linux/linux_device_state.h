@@ -0,0 +1,627 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "GCore/Utils/SoDefines.h"
+#include "linux_report_sizes.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <time.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class EPollResult
+{
+	ReadOk,
+	NoIoThisTick,
+	TransientError,
+	Disconnected
+};
+
+enum class EReadMode
+{
+	// One report per read() call, oldest first (kernel queue order).
+	Single,
+	// Drain every pending report and keep only the newest one in the context buffer.
+	DrainToLatest,
+	// Drain every pending report, keep the newest one in the context buffer and expose all of them.
+	DrainAll
+};
+
+/**
+ * @brief Process-wide tuning knobs for the Linux HID backends.
+ */
+struct linux_device_config
+{
+	EReadMode ReadMode = EReadMode::Single;
+	// Upper bound on reports consumed per read() so a flooding device cannot stall the tick.
+	std::uint32_t MaxDrainPerTick = 64;
+	// Register every opened device with linux_input_reactor so loops can block until input arrives.
+	bool bInputReactor = false;
+	// Skip output reports identical to the last one sent, except once every OutputKeepalive.
+	bool bSuppressUnchangedOutput = true;
+	// Zero resends nothing once the state is unchanged.
+	std::chrono::milliseconds OutputKeepalive{1000};
+	// write() only marks the output dirty; every change made during a tick goes out as one report
+	// at the next flush_outputs() or at the device's next read(), whichever comes first. Opt-in:
+	// callers that never flush would delay their output to the next read().
+	bool bCoalesceOutput = false;
+	// Per-connection cap on coalesced output reports per second; 0 removes the cap.
+	std::uint32_t MaxOutputRateUsbHz = 500;
+	std::uint32_t MaxOutputRateBluetoothHz = 125;
+	// Hand output and audio reports to linux_hid_writer instead of writing on the calling thread.
+	// The io_uring backend is asynchronous already and ignores this.
+	bool bAsyncWriter = false;
+	// detect() returns a cached list that linux_hotplug_monitor invalidates on hidraw add/remove
+	// instead of enumerating every call. Falls back to enumeration when netlink is unavailable.
+	bool bHotplugMonitor = true;
+	// Open and calibrate new controllers on linux_device_opener's workers; detect() only reports a
+	// controller once it is ready, so create_handle() never blocks the frame loop.
+	bool bAsyncOpen = true;
+	// Reuse the calibration of controllers seen before (linux_calibration_cache) instead of reading
+	// the feature report on every connect; the report is re-checked in the background. Opt-in.
+	bool bCalibrationCache = false;
+};
+
+struct linux_device_statistics
+{
+	std::uint64_t ReportsRead = 0;
+	std::uint64_t ReportsSkipped = 0;
+	std::uint64_t EmptyReads = 0;
+	std::uint32_t LastBacklog = 0;
+	std::uint32_t MaxBacklog = 0;
+	std::uint64_t OutputsSent = 0;
+	std::uint64_t OutputsSuppressed = 0;
+	// Subset of OutputsSent that only went out because the keepalive expired.
+	std::uint64_t OutputKeepalives = 0;
+	// write() calls merged into an output that was already pending.
+	std::uint64_t OutputsCoalesced = 0;
+	// Flushes postponed because the connection's output rate cap was reached.
+	std::uint64_t OutputsDeferred = 0;
+	// Reports the device sent but the host never saw, from gaps in the device report counter.
+	std::uint64_t DroppedReports = 0;
+	std::uint32_t MaxInputAgeUs = 0;
+	// From the first detect() that saw the device to its handle being ready, and to its first report.
+	std::uint32_t OpenLatencyUs = 0;
+	std::uint32_t TimeToFirstInputUs = 0;
+};
+
+/**
+ * @brief Timing of the newest input report of a device.
+ */
+struct linux_input_timing
+{
+	// CLOCK_MONOTONIC when the report was read from the kernel.
+	std::uint64_t HostTimeNs = 0;
+	// Device report counter and sensor clock (unwrapped, microseconds since the first report).
+	std::uint32_t DeviceSequence = 0;
+	std::uint64_t DeviceTimeUs = 0;
+	// Deltas to the previous report, on the device clock and on the host clock.
+	std::uint32_t DeviceDeltaUs = 0;
+	std::uint64_t HostDeltaNs = 0;
+	// How much longer than the fastest delivery seen so far this report took to be read.
+	std::uint32_t InputAgeUs = 0;
+	// False until a report with a known layout has been seen; only HostTimeNs is meaningful then.
+	bool bDeviceClock = false;
+};
+
+struct linux_input_report
+{
+	static constexpr std::size_t kMaxSize = 547;
+	std::int32_t Length = 0;
+	std::uint64_t HostTimeNs = 0;
+	std::uint32_t DeviceSequence = 0;
+	std::uint64_t DeviceTimeUs = 0;
+	unsigned char Data[kMaxSize] = {0};
+};
+
+/**
+ * @brief Per-handle bookkeeping that does not fit in FDeviceContext.
+ *
+ * The input side belongs to the thread that calls read(). The output side is shared with the
+ * audio threads that call write() and process_audio_haptic(), so it is only touched under OutputMutex.
+ */
+struct linux_device_state
+{
+	EDSDeviceType DeviceType = EDSDeviceType::DualSense;
+	EDSDeviceConnection ConnectionType = EDSDeviceConnection::Usb;
+	// Settled by create_handle(), see linux_probe_report_sizes(). Only Reports.Audio changes later,
+	// under OutputMutex, see linux_audio_report_size().
+	linux_report_sizes Reports;
+	linux_device_statistics Statistics;
+	linux_input_timing Timing;
+	// Sensor clock bookkeeping: raw ticks of the previous report, unwrapped tick count and the
+	// smallest host-minus-device offset seen, which is the reference for InputAgeUs.
+	std::uint64_t DetectedAtNs = 0;
+	std::uint32_t LastRawTimestamp = 0;
+	std::uint64_t DeviceTicks = 0;
+	std::int64_t MinClockOffsetNs = 0;
+	// Reports drained by the last read() in EReadMode::DrainAll, oldest first.
+	std::vector<linux_input_report> Backlog;
+
+	// Guards everything below and the output counters of Statistics.
+	mutable gc_lock::mutex OutputMutex;
+
+	// Last output report handed to the device, for change suppression.
+	static constexpr std::size_t kMaxOutputSize = 78;
+	unsigned char LastOutput[kMaxOutputSize] = {0};
+	std::int32_t LastOutputLength = 0;
+	std::chrono::steady_clock::time_point LastOutputTime{};
+
+	// Coalesced output waiting for the next flush. The report is copied at write() time, so the
+	// flush never reads a buffer another thread may be filling.
+	bool bOutputPending = false;
+	unsigned char PendingOutput[kMaxOutputSize] = {0};
+	FDeviceContext* OutputOwner = nullptr;
+	void (*OutputFlush)(FDeviceContext*) = nullptr;
+	std::chrono::steady_clock::time_point NextOutputTime{};
+};
+
+class linux_device_state_registry
+{
+public:
+	static linux_device_state_registry& Get()
+	{
+		static linux_device_state_registry Instance;
+		return Instance;
+	}
+
+	std::shared_ptr<linux_device_state> Attach(FPlatformDeviceHandle Handle, const FDeviceContext* Context = nullptr)
+	{
+		std::shared_ptr<linux_device_state> State = std::make_shared<linux_device_state>();
+		if (Context)
+		{
+			State->DeviceType = Context->DeviceType;
+			State->ConnectionType = Context->ConnectionType;
+			State->Reports = linux_default_report_sizes(Context->DeviceType, Context->ConnectionType);
+		}
+
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		States[Handle] = State;
+		return State;
+	}
+
+	// Only drops the registry's reference: a thread still holding the state keeps it alive.
+	void Detach(FPlatformDeviceHandle Handle)
+	{
+		std::shared_ptr<linux_device_state> Released;
+		{
+			gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+			auto It = States.find(Handle);
+			if (It == States.end())
+			{
+				return;
+			}
+			Released = std::move(It->second);
+			States.erase(It);
+		}
+	}
+
+	std::shared_ptr<linux_device_state> Find(FPlatformDeviceHandle Handle)
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		auto It = States.find(Handle);
+		return It != States.end() ? It->second : nullptr;
+	}
+
+	// Runs the backend flush of every device with a pending output. The flush may invalidate the
+	// handle, so it is called outside the lock on a snapshot. Flushing uses the owners' contexts,
+	// so only the thread that runs the registry loop may call this.
+	void FlushPendingOutputs()
+	{
+		std::vector<std::pair<FDeviceContext*, void (*)(FDeviceContext*)>> PendingFlushes;
+		{
+			gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+			for (auto& [Handle, State] : States)
+			{
+				gc_lock::lock_guard<gc_lock::mutex> OutputLock(State->OutputMutex);
+				if (State->bOutputPending && State->OutputOwner && State->OutputFlush)
+				{
+					PendingFlushes.emplace_back(State->OutputOwner, State->OutputFlush);
+				}
+			}
+		}
+
+		for (const auto& [Owner, Flush] : PendingFlushes)
+		{
+			Flush(Owner);
+		}
+	}
+
+private:
+	gc_lock::mutex Mutex;
+	std::unordered_map<FPlatformDeviceHandle, std::shared_ptr<linux_device_state>> States;
+};
+
+inline std::uint64_t linux_monotonic_ns()
+{
+	timespec Ts{};
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return static_cast<std::uint64_t>(Ts.tv_sec) * 1000000000ull + static_cast<std::uint64_t>(Ts.tv_nsec);
+}
+
+/**
+ * @brief Report counter and sensor clock as found in one input report.
+ */
+struct linux_report_clock
+{
+	std::uint32_t Sequence = 0;
+	std::uint32_t SequenceMask = 0;
+	std::uint32_t RawTimestamp = 0;
+	std::uint32_t TimestampBits = 0;
+	// Microseconds per tick as a fraction: DualSense counts 1/3 us, DualShock 4 counts 16/3 us.
+	std::uint32_t TickNumerator = 1;
+	std::uint32_t TickDenominator = 1;
+};
+
+inline bool linux_parse_report_clock(EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType, const unsigned char* Report, std::int32_t Length, linux_report_clock& Out)
+{
+	const bool bBluetooth = ConnectionType == EDSDeviceConnection::Bluetooth;
+	if (DeviceType == EDSDeviceType::DualShock4)
+	{
+		// Common block at 1 (USB 0x01) or 3 (BT 0x11): counter in the top 6 bits of buttons[2], LE16 timestamp at +9.
+		const std::int32_t Base = bBluetooth ? 3 : 1;
+		if (Report[0] != (bBluetooth ? 0x11 : 0x01) || Length < Base + 11)
+		{
+			return false;
+		}
+		Out.Sequence = Report[Base + 6] >> 2;
+		Out.SequenceMask = 0x3F;
+		Out.RawTimestamp = Report[Base + 9] | (Report[Base + 10] << 8);
+		Out.TimestampBits = 16;
+		Out.TickNumerator = 16;
+		Out.TickDenominator = 3;
+		return true;
+	}
+
+	// Common block at 1 (USB 0x01) or 2 (BT 0x31): sequence at +6, LE32 sensor timestamp at +27.
+	const std::int32_t Base = bBluetooth ? 2 : 1;
+	if (Report[0] != (bBluetooth ? 0x31 : 0x01) || Length < Base + 31)
+	{
+		return false;
+	}
+	Out.Sequence = Report[Base + 6];
+	Out.SequenceMask = 0xFF;
+	Out.RawTimestamp = static_cast<std::uint32_t>(Report[Base + 27]) | (static_cast<std::uint32_t>(Report[Base + 28]) << 8) |
+	                   (static_cast<std::uint32_t>(Report[Base + 29]) << 16) | (static_cast<std::uint32_t>(Report[Base + 30]) << 24);
+	Out.TimestampBits = 32;
+	Out.TickNumerator = 1;
+	Out.TickDenominator = 3;
+	return true;
+}
+
+/**
+ * @brief Stamps the state's timing with one report read at HostTimeNs.
+ *
+ * Counter gaps are counted as dropped reports. The sensor clock is unwrapped to 64 bits; the
+ * DualShock 4 clock wraps every ~350 ms, so a wrap hidden by a long read gap is recovered from
+ * the host clock.
+ */
+inline void linux_track_report(linux_device_state* State, const unsigned char* Report, std::int32_t Length, std::uint64_t HostTimeNs)
+{
+	if (!State || Length <= 0)
+	{
+		return;
+	}
+
+	linux_input_timing& Timing = State->Timing;
+	const bool bHadPrevious = Timing.HostTimeNs != 0;
+	if (!bHadPrevious && State->DetectedAtNs != 0)
+	{
+		State->Statistics.TimeToFirstInputUs = static_cast<std::uint32_t>((HostTimeNs - State->DetectedAtNs) / 1000);
+	}
+	Timing.HostDeltaNs = bHadPrevious ? HostTimeNs - Timing.HostTimeNs : 0;
+	Timing.HostTimeNs = HostTimeNs;
+
+	linux_report_clock Clock;
+	if (!linux_parse_report_clock(State->DeviceType, State->ConnectionType, Report, Length, Clock))
+	{
+		return;
+	}
+
+	const std::uint64_t WrapTicks = 1ull << Clock.TimestampBits;
+	const auto TicksToUs = [&Clock](std::uint64_t Ticks) {
+		return Ticks * Clock.TickNumerator / Clock.TickDenominator;
+	};
+
+	if (Timing.bDeviceClock)
+	{
+		const std::uint32_t SequenceDelta = (Clock.Sequence - Timing.DeviceSequence) & Clock.SequenceMask;
+		if (SequenceDelta > 1)
+		{
+			State->Statistics.DroppedReports += SequenceDelta - 1;
+		}
+
+		std::uint64_t TickDelta = (static_cast<std::uint64_t>(Clock.RawTimestamp) - State->LastRawTimestamp) & (WrapTicks - 1);
+		const std::uint64_t WrapUs = TicksToUs(WrapTicks);
+		const std::uint64_t HostDeltaUs = Timing.HostDeltaNs / 1000;
+		if (HostDeltaUs > TicksToUs(TickDelta) + WrapUs / 2)
+		{
+			TickDelta += ((HostDeltaUs - TicksToUs(TickDelta) + WrapUs / 2) / WrapUs) * WrapTicks;
+		}
+		State->DeviceTicks += TickDelta;
+		Timing.DeviceDeltaUs = static_cast<std::uint32_t>(TicksToUs(TickDelta));
+	}
+	else
+	{
+		State->DeviceTicks = 0;
+		Timing.DeviceDeltaUs = 0;
+	}
+
+	State->LastRawTimestamp = Clock.RawTimestamp;
+	Timing.DeviceSequence = Clock.Sequence;
+	Timing.DeviceTimeUs = TicksToUs(State->DeviceTicks);
+
+	// Host minus device time is transport latency plus queueing; its running minimum is the fastest
+	// delivery seen. The minimum creeps up by 100 ppm of elapsed time so clock skew cannot pin it.
+	const std::int64_t Offset = static_cast<std::int64_t>(HostTimeNs) - static_cast<std::int64_t>(Timing.DeviceTimeUs * 1000);
+	if (!Timing.bDeviceClock || Offset < State->MinClockOffsetNs)
+	{
+		State->MinClockOffsetNs = Offset;
+	}
+	else
+	{
+		State->MinClockOffsetNs += std::min<std::int64_t>(Offset - State->MinClockOffsetNs, static_cast<std::int64_t>(Timing.HostDeltaNs / 10000));
+	}
+	Timing.InputAgeUs = static_cast<std::uint32_t>((Offset - State->MinClockOffsetNs) / 1000);
+	State->Statistics.MaxInputAgeUs = std::max(State->Statistics.MaxInputAgeUs, Timing.InputAgeUs);
+	Timing.bDeviceClock = true;
+}
+
+/**
+ * @brief Replaces the assumed report sizes of a freshly attached device with what it declares.
+ */
+inline void linux_settle_report_sizes(linux_device_state* State, const FDeviceContext* Context)
+{
+	State->Reports = linux_probe_report_sizes(Context->Path, Context->DeviceType, Context->ConnectionType,
+	                                          sizeof(Context->Buffer), sizeof(Context->BufferDS4));
+}
+
+/**
+ * @brief Records when the device was first detected and how long opening it took.
+ */
+inline void linux_record_open(linux_device_state* State, std::uint64_t DetectedAtNs, std::uint64_t ReadyAtNs)
+{
+	if (!State || DetectedAtNs == 0)
+	{
+		return;
+	}
+	State->DetectedAtNs = DetectedAtNs;
+	State->Statistics.OpenLatencyUs = static_cast<std::uint32_t>((ReadyAtNs - DetectedAtNs) / 1000);
+}
+
+inline void linux_record_reads(linux_device_state* State, const linux_device_config& Config, std::uint32_t Drained)
+{
+	if (!State)
+	{
+		return;
+	}
+
+	linux_device_statistics& Stats = State->Statistics;
+	Stats.ReportsRead += Drained;
+	Stats.ReportsSkipped += (Config.ReadMode == EReadMode::DrainToLatest && Drained > 1) ? Drained - 1 : 0;
+	Stats.EmptyReads += (Drained == 0) ? 1 : 0;
+	Stats.LastBacklog = Drained;
+	Stats.MaxBacklog = std::max(Stats.MaxBacklog, Drained);
+}
+
+/**
+ * @brief Starts a tick's backlog; returns whether the read mode keeps every report.
+ *
+ * Sized here rather than at open, so switching to DrainAll or raising MaxDrainPerTick through
+ * configure() applies to devices that are already open. reserve() only allocates when it grows.
+ */
+inline bool linux_begin_backlog(linux_device_state* State, const linux_device_config& Config)
+{
+	if (!State)
+	{
+		return false;
+	}
+
+	State->Backlog.clear();
+	if (Config.ReadMode != EReadMode::DrainAll)
+	{
+		return false;
+	}
+	State->Backlog.reserve(Config.MaxDrainPerTick);
+	return true;
+}
+
+/**
+ * @brief Drains up to Config.MaxDrainPerTick reports through Poll, shared by every Linux transport.
+ *
+ * Reports land straight in Buffer; a poll that finds the queue empty leaves the previous report
+ * untouched, so afterwards Buffer always holds the newest report of the tick.
+ */
+template<typename FPoll>
+EPollResult linux_drain_reports(linux_device_state* State, const linux_device_config& Config, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead, FPoll&& Poll)
+{
+	const bool bKeepAll = linux_begin_backlog(State, Config);
+
+	OutBytesRead = 0;
+	std::uint32_t Drained = 0;
+	EPollResult Result = EPollResult::NoIoThisTick;
+	while (Drained < Config.MaxDrainPerTick)
+	{
+		std::int32_t BytesRead = 0;
+		const EPollResult PollResult = Poll(Buffer, Length, BytesRead);
+		if (PollResult == EPollResult::Disconnected)
+		{
+			return EPollResult::Disconnected;
+		}
+		if (PollResult != EPollResult::ReadOk)
+		{
+			break;
+		}
+
+		++Drained;
+		OutBytesRead = BytesRead;
+		Result = EPollResult::ReadOk;
+		linux_track_report(State, Buffer, BytesRead, linux_monotonic_ns());
+
+		if (bKeepAll && State->Backlog.size() < State->Backlog.capacity())
+		{
+			linux_input_report& Report = State->Backlog.emplace_back();
+			Report.Length = std::min<std::int32_t>(BytesRead, (std::int32_t)linux_input_report::kMaxSize);
+			Report.HostTimeNs = State->Timing.HostTimeNs;
+			Report.DeviceSequence = State->Timing.DeviceSequence;
+			Report.DeviceTimeUs = State->Timing.DeviceTimeUs;
+			std::memcpy(Report.Data, Buffer, Report.Length);
+		}
+	}
+
+	linux_record_reads(State, Config, Drained);
+	return Result;
+}
+
+// Whether Report repeats the last output sent. On Bluetooth the sequence byte and the CRC trailer
+// change on every report, so only the payload between them is compared. Needs OutputMutex.
+inline bool linux_output_unchanged_locked(const linux_device_state* State, const linux_device_config& Config, const unsigned char* Report, std::int32_t Length, bool bBluetooth)
+{
+	const std::int32_t Begin = bBluetooth ? 2 : 0;
+	const std::int32_t End = bBluetooth ? Length - 4 : Length;
+	return Config.bSuppressUnchangedOutput && State->LastOutputLength == Length && End > Begin &&
+	       std::memcmp(State->LastOutput + Begin, Report + Begin, End - Begin) == 0;
+}
+
+/**
+ * @brief Decides whether an output report must reach the device.
+ *
+ * Only decides: the report counts as sent once linux_record_output() confirms the transport took
+ * it, so a write that never happened cannot suppress the identical reports after it.
+ */
+inline bool linux_should_send_output(linux_device_state* State, const linux_device_config& Config, const unsigned char* Report, std::int32_t Length, bool bBluetooth)
+{
+	if (!State)
+	{
+		return true;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(State->OutputMutex);
+	if (!linux_output_unchanged_locked(State, Config, Report, Length, bBluetooth))
+	{
+		return true;
+	}
+	if (Config.OutputKeepalive.count() > 0 && std::chrono::steady_clock::now() - State->LastOutputTime >= Config.OutputKeepalive)
+	{
+		return true;
+	}
+	++State->Statistics.OutputsSuppressed;
+	return false;
+}
+
+/**
+ * @brief Remembers a report the transport accepted (written, or queued on the writer thread or ring).
+ */
+inline void linux_record_output(linux_device_state* State, const linux_device_config& Config, const unsigned char* Report, std::int32_t Length, bool bBluetooth)
+{
+	if (!State)
+	{
+		return;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(State->OutputMutex);
+	linux_device_statistics& Stats = State->Statistics;
+	if (linux_output_unchanged_locked(State, Config, Report, Length, bBluetooth))
+	{
+		++Stats.OutputKeepalives;
+	}
+
+	const std::int32_t Stored = std::min<std::int32_t>(Length, (std::int32_t)linux_device_state::kMaxOutputSize);
+	std::memcpy(State->LastOutput, Report, Stored);
+	State->LastOutputLength = Stored;
+	State->LastOutputTime = std::chrono::steady_clock::now();
+	++Stats.OutputsSent;
+}
+
+/**
+ * @brief Records a write() as pending when output coalescing is on, copying the report out of Context.
+ * @return false when the caller must send the report right away.
+ */
+inline bool linux_defer_output(linux_device_state* State, const linux_device_config& Config, FDeviceContext* Context, void (*Flush)(FDeviceContext*))
+{
+	if (!State || !Config.bCoalesceOutput)
+	{
+		return false;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(State->OutputMutex);
+	if (State->bOutputPending)
+	{
+		++State->Statistics.OutputsCoalesced;
+	}
+	std::memcpy(State->PendingOutput, Context->GetRawOutputBuffer(), std::min<std::size_t>(State->Reports.Output, linux_device_state::kMaxOutputSize));
+	State->bOutputPending = true;
+	State->OutputOwner = Context;
+	State->OutputFlush = Flush;
+	return true;
+}
+
+/**
+ * @brief Claims the pending output for sending if the connection's rate cap allows it now.
+ *
+ * On success the report to send is copied to OutReport, which holds kMaxOutputSize bytes.
+ */
+inline bool linux_claim_pending_output(linux_device_state* State, const linux_device_config& Config, bool bBluetooth, unsigned char* OutReport)
+{
+	if (!State)
+	{
+		return false;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(State->OutputMutex);
+	if (!State->bOutputPending)
+	{
+		return false;
+	}
+
+	const auto Now = std::chrono::steady_clock::now();
+	if (Now < State->NextOutputTime)
+	{
+		++State->Statistics.OutputsDeferred;
+		return false;
+	}
+
+	const std::uint32_t RateHz = bBluetooth ? Config.MaxOutputRateBluetoothHz : Config.MaxOutputRateUsbHz;
+	State->NextOutputTime = RateHz > 0 ? Now + std::chrono::microseconds(1000000 / RateHz) : Now;
+	State->bOutputPending = false;
+	std::memcpy(OutReport, State->PendingOutput, linux_device_state::kMaxOutputSize);
+	return true;
+}
+
+// Size of the next audio-haptic report. A failed write may demote it from another thread.
+inline std::uint16_t linux_audio_report_size(const linux_device_state* State)
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(State->OutputMutex);
+	return State->Reports.Audio;
+}
+
+/**
+ * @brief Handles a failed write of Length bytes: an audio report the device refused at an assumed
+ * size switches the device to the short form for good.
+ *
+ * The failed packet is not retried; the next one goes out at the new size. False when the write
+ * was not a demotable audio report, so the caller treats it as any other write error.
+ */
+inline bool linux_demote_audio_after_error(linux_device_state* State, std::size_t Length)
+{
+	if (!State)
+	{
+		return false;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(State->OutputMutex);
+	return Length == State->Reports.Audio && linux_demote_audio_report(State->Reports);
+}
+
+// linux_hid_writer error hook for audio writes.
+inline bool linux_demote_audio_after_write_error(FPlatformDeviceHandle Handle, std::size_t Length)
+{
+	return linux_demote_audio_after_error(linux_device_state_registry::Get().Find(Handle).get(), Length);
+}
+#endif
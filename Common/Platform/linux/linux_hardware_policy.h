@@ -6,12 +6,28 @@
 #if GAMEPAD_CORE_HAS_AUDIO
 #include "miniaudio.h"
 #endif
+#include "linux_audio_context.h"
 #include "linux_device_info.h"
+#include "linux_hidraw_device_info.h"
+#if GAMEPAD_CORE_HAS_IO_URING
+#include "linux_uring_device_info.h"
+#endif
+#include <iostream>
 #include <string>
 #include <vector>
 
 namespace linux_platform
 {
+	// GAMEPAD_CORE_NATIVE_HIDRAW (CMake: USE_NATIVE_HIDRAW) bypasses SDL_hidapi and uses /dev/hidraw* directly;
+	// GAMEPAD_CORE_IO_URING (CMake: USE_IO_URING) does the same through one io_uring for all devices.
+#if GAMEPAD_CORE_IO_URING
+	using linux_hid_backend = linux_uring_device_info;
+#elif GAMEPAD_CORE_NATIVE_HIDRAW
+	using linux_hid_backend = linux_hidraw_device_info;
+#else
+	using linux_hid_backend = linux_device_info;
+#endif
+
 	struct linux_hardware_policy;
 	using linux_hardware = GamepadCore::TGenericHardwareInfo<linux_hardware_policy>;
 
@@ -21,32 +37,32 @@ namespace linux_platform
 
 		static void Read(FDeviceContext* Context)
 		{
-			linux_device_info::read(Context);
+			linux_hid_backend::read(Context);
 		}
 
 		static void Write(FDeviceContext* Context)
 		{
-			linux_device_info::write(Context);
+			linux_hid_backend::write(Context);
 		}
 
 		static void Detect(std::vector<FDeviceContext>& Devices)
 		{
-			linux_device_info::detect(Devices);
+			linux_hid_backend::detect(Devices);
 		}
 
 		static bool CreateHandle(FDeviceContext* Context)
 		{
-			return linux_device_info::create_handle(Context);
+			return linux_hid_backend::create_handle(Context);
 		}
 
 		static void InvalidateHandle(FDeviceContext* Context)
 		{
-			linux_device_info::invalidate_handle(Context);
+			linux_hid_backend::invalidate_handle(Context);
 		}
 
 		static void ProcessAudioHaptic(FDeviceContext* Context)
 		{
-			linux_device_info::process_audio_haptic(Context);
+			linux_hid_backend::process_audio_haptic(Context);
 		}
 
 		static void InitializeAudioDevice(FDeviceContext* Context)
@@ -57,56 +73,23 @@ namespace linux_platform
 				return;
 			}
 
-			// Initialize miniaudio context for device enumeration
-			ma_context maContext;
-			if (ma_context_init(nullptr, 0, nullptr, &maContext) != MA_SUCCESS)
+			// One context and one enumeration per process, refreshed on sound hotplug, so this is a lookup.
+			ma_device_id DeviceId;
+			std::string DeviceName;
+			const bool bFound = linux_audio_context::Get().find_controller_device(Context->Path, DeviceId, DeviceName);
+			if (bFound)
 			{
-				return;
-			}
-
-			// Get playback devices
-			ma_device_info* pPlaybackInfos;
-			ma_uint32 playbackCount;
-			ma_device_info* pCaptureInfos;
-			ma_uint32 captureCount;
-
-			if (ma_context_get_devices(&maContext, &pPlaybackInfos, &playbackCount, &pCaptureInfos, &captureCount) != MA_SUCCESS)
-			{
-				ma_context_uninit(&maContext);
-				return;
-			}
-
-			// Search for DualSense audio device
-			ma_device_id* pFoundDeviceId = nullptr;
-			ma_device_id foundDeviceId;
-
-			for (ma_uint32 i = 0; i < playbackCount; i++)
-			{
-				std::string deviceName(pPlaybackInfos[i].name);
-
-				// Check if device name contains DualSense identifiers
-				// On Linux, the audio device name might vary (e.g., "DualSense Wireless Controller Analog Stereo")
-				if (deviceName.find("DualSense") != std::string::npos ||
-				    deviceName.find("Wireless Controller") != std::string::npos ||
-				    deviceName.find("Sony") != std::string::npos)
-				{
-					foundDeviceId = pPlaybackInfos[i].id;
-					pFoundDeviceId = &foundDeviceId;
-					std::cout << "[InitializeAudioDevice] Found potential audio device: " << deviceName << std::endl;
-					break;
-				}
+				std::cout << "[InitializeAudioDevice] Found potential audio device: " << DeviceName << std::endl;
 			}
 
 			// Initialize audio context with found device (or default if not found)
 			Context->AudioContext = std::make_shared<FAudioDeviceContext>();
 
-			if (pFoundDeviceId)
+			if (bFound)
 			{
 				// DualSense haptics use 4 channels at 48000 Hz
-				Context->AudioContext->InitializeWithDeviceId(pFoundDeviceId, 48000, 4);
+				Context->AudioContext->InitializeWithDeviceId(&DeviceId, 48000, 4);
 			}
-
-			ma_context_uninit(&maContext);
 #endif
 		}
 	};
@@ -0,0 +1,237 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "linux_hid_writer.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#ifdef __unix__
+#include <cstring>
+
+static void atomic_max(std::atomic<std::uint64_t>& Target, std::uint64_t Value)
+{
+	std::uint64_t Current = Target.load(std::memory_order_relaxed);
+	while (Current < Value && !Target.compare_exchange_weak(Current, Value, std::memory_order_relaxed))
+	{
+	}
+}
+
+linux_hid_writer& linux_hid_writer::Get()
+{
+	static linux_hid_writer Instance;
+	return Instance;
+}
+
+linux_hid_writer::~linux_hid_writer()
+{
+	stop();
+}
+
+void linux_hid_writer::ensure_started()
+{
+	if (bRunning.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(StartMutex);
+	if (!bRunning.load(std::memory_order_relaxed))
+	{
+		bRunning.store(true, std::memory_order_release);
+		Thread = std::thread(&linux_hid_writer::run, this);
+	}
+}
+
+void linux_hid_writer::stop()
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(StartMutex);
+	if (!bRunning.exchange(false))
+	{
+		return;
+	}
+
+	Signal.fetch_add(1, std::memory_order_release);
+	Signal.notify_one();
+	if (Thread.joinable())
+	{
+		Thread.join();
+	}
+}
+
+bool linux_hid_writer::push(const command& Command)
+{
+	if (!Queue.try_push(Command))
+	{
+		return false;
+	}
+
+	atomic_max(MaxQueueDepth, Queue.approximate_size());
+	Signal.fetch_add(1, std::memory_order_release);
+	Signal.notify_one();
+	return true;
+}
+
+bool linux_hid_writer::enqueue(FPlatformDeviceHandle Handle, FWriteFn Write, const unsigned char* Data, std::size_t Length, FErrorFn OnError)
+{
+	if (!Handle || !Write || Length == 0 || Length > kMaxReportSize)
+	{
+		return false;
+	}
+
+	ensure_started();
+
+	command Command;
+	Command.Kind = ECommand::Write;
+	Command.Handle = Handle;
+	Command.Write = Write;
+	Command.OnError = OnError;
+	Command.Length = static_cast<std::uint16_t>(Length);
+	Command.EnqueuedAt = std::chrono::steady_clock::now();
+	std::memcpy(Command.Data, Data, Length);
+
+	if (!push(Command))
+	{
+		Rejected.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	Enqueued.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+bool linux_hid_writer::enqueue_task(FPlatformDeviceHandle Handle, FTaskFn Task, const unsigned char* Data, std::size_t Length)
+{
+	if (!Handle || !Task || Length > kMaxReportSize)
+	{
+		return false;
+	}
+
+	ensure_started();
+
+	command Command;
+	Command.Kind = ECommand::Task;
+	Command.Handle = Handle;
+	Command.Task = Task;
+	Command.Length = static_cast<std::uint16_t>(Length);
+	if (Length > 0)
+	{
+		std::memcpy(Command.Data, Data, Length);
+	}
+	return push(Command);
+}
+
+void linux_hid_writer::retire(FPlatformDeviceHandle Handle)
+{
+	if (!bRunning.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	std::atomic<bool> Done{false};
+	command Fence;
+	Fence.Kind = ECommand::Fence;
+	Fence.Handle = Handle;
+	Fence.FenceDone = &Done;
+
+	// A fence may not be dropped: wait for room instead of reporting back-pressure.
+	while (!push(Fence))
+	{
+		std::this_thread::yield();
+	}
+	Done.wait(false, std::memory_order_acquire);
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(ErrorMutex);
+	if (FailedHandles.erase(Handle) > 0)
+	{
+		ErrorCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+bool linux_hid_writer::take_error(FPlatformDeviceHandle Handle)
+{
+	if (ErrorCount.load(std::memory_order_relaxed) == 0)
+	{
+		return false;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(ErrorMutex);
+	if (FailedHandles.erase(Handle) == 0)
+	{
+		return false;
+	}
+	ErrorCount.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+linux_writer_statistics linux_hid_writer::statistics()
+{
+	linux_writer_statistics Stats;
+	Stats.Enqueued = Enqueued.load(std::memory_order_relaxed);
+	Stats.Written = Written.load(std::memory_order_relaxed);
+	Stats.Rejected = Rejected.load(std::memory_order_relaxed);
+	Stats.WriteErrors = WriteErrors.load(std::memory_order_relaxed);
+	Stats.MaxQueueDepth = MaxQueueDepth.load(std::memory_order_relaxed);
+	Stats.TotalLatencyUs = TotalLatencyUs.load(std::memory_order_relaxed);
+	Stats.MaxLatencyUs = MaxLatencyUs.load(std::memory_order_relaxed);
+	return Stats;
+}
+
+void linux_hid_writer::execute(const command& Command)
+{
+	if (Command.Kind == ECommand::Fence)
+	{
+		// Everything queued before the fence has been written; the device may now be closed.
+		Command.FenceDone->store(true, std::memory_order_release);
+		Command.FenceDone->notify_all();
+		return;
+	}
+	if (Command.Kind == ECommand::Task)
+	{
+		Command.Task(Command.Handle, Command.Data, Command.Length);
+		return;
+	}
+
+	const int Result = Command.Write(Command.Handle, Command.Data, Command.Length);
+	if (Result < 0)
+	{
+		WriteErrors.fetch_add(1, std::memory_order_relaxed);
+		if (Command.OnError && Command.OnError(Command.Handle, Command.Length))
+		{
+			return;
+		}
+		gc_lock::lock_guard<gc_lock::mutex> Lock(ErrorMutex);
+		if (FailedHandles.insert(Command.Handle).second)
+		{
+			ErrorCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		return;
+	}
+
+	Written.fetch_add(1, std::memory_order_relaxed);
+	const std::uint64_t LatencyUs = static_cast<std::uint64_t>(
+	    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Command.EnqueuedAt).count());
+	TotalLatencyUs.fetch_add(LatencyUs, std::memory_order_relaxed);
+	atomic_max(MaxLatencyUs, LatencyUs);
+}
+
+void linux_hid_writer::run()
+{
+	command Command;
+	while (true)
+	{
+		// Read the signal before draining so a push racing with the drain still wakes us.
+		const std::uint32_t Observed = Signal.load(std::memory_order_acquire);
+		bool bDidWork = false;
+		while (Queue.try_pop(Command))
+		{
+			execute(Command);
+			bDidWork = true;
+		}
+
+		if (!bRunning.load(std::memory_order_acquire))
+		{
+			return;
+		}
+		if (!bDidWork)
+		{
+			Signal.wait(Observed, std::memory_order_acquire);
+		}
+	}
+}
+#endif
+#endif
@@ -0,0 +1,194 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "GCore/Utils/SoDefines.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <unordered_set>
+
+/**
+ * @brief Bounded lock-free multi-producer queue (Dmitry Vyukov's sequence-per-cell ring).
+ *
+ * Producers claim a cell with one CAS on the enqueue cursor; the single consumer never
+ * contends with them. Capacity must be a power of two.
+ */
+template<typename T, std::size_t Capacity>
+class linux_bounded_queue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	linux_bounded_queue()
+	{
+		for (std::size_t i = 0; i < Capacity; ++i)
+		{
+			Cells[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	bool try_push(const T& Value)
+	{
+		std::size_t Position = EnqueuePos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell& Cell = Cells[Position & (Capacity - 1)];
+			const std::size_t Sequence = Cell.Sequence.load(std::memory_order_acquire);
+			const std::intptr_t Diff = (std::intptr_t)Sequence - (std::intptr_t)Position;
+			if (Diff == 0)
+			{
+				if (EnqueuePos.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+				{
+					Cell.Value = Value;
+					Cell.Sequence.store(Position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (Diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				Position = EnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Single consumer only.
+	bool try_pop(T& OutValue)
+	{
+		cell& Cell = Cells[DequeuePos & (Capacity - 1)];
+		const std::size_t Sequence = Cell.Sequence.load(std::memory_order_acquire);
+		if ((std::intptr_t)Sequence - (std::intptr_t)(DequeuePos + 1) < 0)
+		{
+			return false;
+		}
+
+		OutValue = Cell.Value;
+		Cell.Sequence.store(DequeuePos + Capacity, std::memory_order_release);
+		++DequeuePos;
+		DequeueCount.store(DequeuePos, std::memory_order_relaxed);
+		return true;
+	}
+
+	std::size_t approximate_size() const
+	{
+		return EnqueuePos.load(std::memory_order_relaxed) - DequeueCount.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct cell
+	{
+		std::atomic<std::size_t> Sequence{0};
+		T Value{};
+	};
+
+	alignas(64) cell Cells[Capacity];
+	alignas(64) std::atomic<std::size_t> EnqueuePos{0};
+	alignas(64) std::size_t DequeuePos = 0;
+	std::atomic<std::size_t> DequeueCount{0};
+};
+
+struct linux_writer_statistics
+{
+	std::uint64_t Enqueued = 0;
+	std::uint64_t Written = 0;
+	// Commands refused because the queue was full (back-pressure); the caller's report is dropped.
+	std::uint64_t Rejected = 0;
+	std::uint64_t WriteErrors = 0;
+	std::uint64_t MaxQueueDepth = 0;
+	// Time from enqueue to the end of the write syscall.
+	std::uint64_t TotalLatencyUs = 0;
+	std::uint64_t MaxLatencyUs = 0;
+};
+
+/**
+ * @brief Single thread that owns every synchronous HID write of the Linux backends.
+ *
+ * Callers copy the report into a fixed-size command and return immediately, so a slow
+ * Bluetooth write never stalls the game loop or the audio worker, and the writer never
+ * touches an FDeviceContext. Failed writes are only flagged here; the thread that owns the
+ * device picks the flag up with take_error() and invalidates the handle itself.
+ */
+class linux_hid_writer
+{
+public:
+	using FWriteFn = int (*)(FPlatformDeviceHandle Handle, const unsigned char* Data, std::size_t Length);
+	// Other blocking device I/O run in order with the writes, such as a feature report read.
+	using FTaskFn = void (*)(FPlatformDeviceHandle Handle, const unsigned char* Data, std::size_t Length);
+	// Called on the writer thread when a write fails; true when it dealt with the failure, so the
+	// handle is not flagged for take_error().
+	using FErrorFn = bool (*)(FPlatformDeviceHandle Handle, std::size_t Length);
+
+	static constexpr std::size_t kMaxReportSize = 147;
+	static constexpr std::size_t kQueueCapacity = 256;
+
+	static linux_hid_writer& Get();
+
+	~linux_hid_writer();
+
+	// Queues one report, written once; a failure goes to OnError when given.
+	bool enqueue(FPlatformDeviceHandle Handle, FWriteFn Write, const unsigned char* Data, std::size_t Length, FErrorFn OnError = nullptr);
+	// Runs Task(Handle, Data, Length) on the writer thread. Like a write, it is finished before retire() returns.
+	bool enqueue_task(FPlatformDeviceHandle Handle, FTaskFn Task, const unsigned char* Data, std::size_t Length);
+	// Blocks until every command queued for Handle so far has been written. Call before closing the device.
+	void retire(FPlatformDeviceHandle Handle);
+	// True once if a write for Handle failed since the last call.
+	bool take_error(FPlatformDeviceHandle Handle);
+
+	linux_writer_statistics statistics();
+	void stop();
+
+private:
+	linux_hid_writer() = default;
+
+	enum class ECommand : std::uint8_t
+	{
+		Write,
+		Task,
+		Fence
+	};
+
+	struct command
+	{
+		ECommand Kind = ECommand::Write;
+		FPlatformDeviceHandle Handle = nullptr;
+		FWriteFn Write = nullptr;
+		FTaskFn Task = nullptr;
+		FErrorFn OnError = nullptr;
+		std::uint16_t Length = 0;
+		std::chrono::steady_clock::time_point EnqueuedAt{};
+		std::atomic<bool>* FenceDone = nullptr;
+		unsigned char Data[kMaxReportSize] = {0};
+	};
+
+	bool push(const command& Command);
+	void ensure_started();
+	void run();
+	void execute(const command& Command);
+
+	linux_bounded_queue<command, kQueueCapacity> Queue;
+	std::atomic<std::uint32_t> Signal{0};
+	std::atomic<bool> bRunning{false};
+	gc_lock::mutex StartMutex;
+	std::thread Thread;
+
+	std::atomic<std::uint64_t> Enqueued{0};
+	std::atomic<std::uint64_t> Written{0};
+	std::atomic<std::uint64_t> Rejected{0};
+	std::atomic<std::uint64_t> WriteErrors{0};
+	std::atomic<std::uint64_t> MaxQueueDepth{0};
+	std::atomic<std::uint64_t> TotalLatencyUs{0};
+	std::atomic<std::uint64_t> MaxLatencyUs{0};
+
+	// Written only on failure; ErrorCount keeps take_error() lock-free in the common case.
+	std::atomic<std::uint32_t> ErrorCount{0};
+	gc_lock::mutex ErrorMutex;
+	std::unordered_set<FPlatformDeviceHandle> FailedHandles;
+};
+#endif
@@ -0,0 +1,448 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "linux_hidraw_device_info.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#ifdef __unix__
+#include "GCore/Types/ECoreGamepad.h"
+#include "GCore/Types/Structs/Config/GamepadCalibration.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "linux_calibration_cache.h"
+#include "linux_hid_writer.h"
+#include "linux_hotplug_monitor.h"
+#include "linux_input_reactor.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/hidraw.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+static constexpr std::uint32_t kBusUsb = 0x03;
+static constexpr std::uint32_t kBusBluetooth = 0x05;
+
+static linux_hidraw_handle* to_hidraw(FPlatformDeviceHandle Handle)
+{
+	return static_cast<linux_hidraw_handle*>(Handle);
+}
+
+// Controllers seen by the last enumeration and the hotplug generation they belong to.
+static linux_device_tracker GTracker;
+static std::vector<linux_hidraw_node> GNodes;
+static std::vector<linux_detected_device> GAdded;
+static std::vector<linux_detected_device> GRemoved;
+static std::vector<linux_detected_device> GPublished;
+static std::uint64_t GDetectedGeneration = 0;
+
+// linux_device_opener worker: the blocking part of create_handle().
+static bool hidraw_open_prepared(const std::string& Path, linux_prepared_device& Out)
+{
+	const int Fd = open(Path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (Fd < 0)
+	{
+		return false;
+	}
+
+	linux_hidraw_handle* Device = new linux_hidraw_handle();
+	Device->Fd = Fd;
+	Out.Handle = Device;
+	Out.bCalibrated = linux_hidraw_device_info::resolve_calibration(Path, Out);
+	return true;
+}
+
+// Writer-thread entry point: transient errors are not reported as failures.
+static int hidraw_write(FPlatformDeviceHandle Handle, const unsigned char* Data, std::size_t Length)
+{
+	const ssize_t Result = ::write(to_hidraw(Handle)->Fd, Data, Length);
+	if (Result < 0)
+	{
+		return linux_hidraw_device_info::should_treat_as_disconnected(errno) ? -1 : 0;
+	}
+	return static_cast<int>(Result);
+}
+
+bool linux_hidraw_device_info::should_treat_as_disconnected(const int Error)
+{
+	return Error != EAGAIN && Error != EWOULDBLOCK && Error != EINTR;
+}
+
+int linux_hidraw_device_info::get_fd(FPlatformDeviceHandle Handle)
+{
+	const linux_hidraw_handle* Device = to_hidraw(Handle);
+	return Device ? Device->Fd : -1;
+}
+
+void linux_hidraw_device_info::read(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	const linux_device_config& Config = linux_device_info::get_config();
+	if (Config.bAsyncWriter && linux_hid_writer::Get().take_error(Context->Handle))
+	{
+		invalidate_handle(Context);
+		return;
+	}
+	linux_calibration_cache::Get().take_update(Context->Handle, Context->Calibration);
+
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	if (!State)
+	{
+		return;
+	}
+	unsigned char* Buffer = State->Reports.bLargeInput ? Context->BufferDS4 : Context->Buffer;
+	const std::int32_t InputReportLength = State->Reports.Input;
+
+	std::int32_t BytesRead = 0;
+	EPollResult Result = EPollResult::NoIoThisTick;
+	if (Config.ReadMode == EReadMode::Single)
+	{
+		Result = poll_tick(Context->Handle, Buffer, InputReportLength, BytesRead);
+		if (Result == EPollResult::ReadOk)
+		{
+			linux_track_report(State.get(), Buffer, BytesRead, linux_monotonic_ns());
+		}
+		linux_record_reads(State.get(), Config, Result == EPollResult::ReadOk ? 1 : 0);
+	}
+	else
+	{
+		Result = drain_tick(Context->Handle, Buffer, InputReportLength, BytesRead);
+	}
+
+	if (Result == EPollResult::Disconnected)
+	{
+		invalidate_handle(Context);
+		return;
+	}
+
+	flush_output(Context);
+}
+
+void linux_hidraw_device_info::process_audio_haptic(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	const std::uint16_t AudioReportLength = State ? linux_audio_report_size(State.get()) : 0;
+	if (AudioReportLength == 0)
+	{
+		return;
+	}
+
+	if (linux_device_info::get_config().bAsyncWriter)
+	{
+		linux_hid_writer::Get().enqueue(Context->Handle, &hidraw_write, Context->BufferAudio, AudioReportLength, &linux_demote_audio_after_write_error);
+		return;
+	}
+
+	if (::write(get_fd(Context->Handle), Context->BufferAudio, AudioReportLength) < 0)
+	{
+		linux_demote_audio_after_error(State.get(), AudioReportLength);
+	}
+}
+
+bool linux_hidraw_device_info::configure_features(FDeviceContext* Context)
+{
+	linux_prepared_device Prepared;
+	Prepared.Handle = Context->Handle;
+	if (!resolve_calibration(Context->Path, Prepared))
+	{
+		return false;
+	}
+
+	Context->Calibration = Prepared.Calibration;
+	if (Prepared.bCalibrationCached)
+	{
+		linux_calibration_cache::schedule_validation(Context->Handle, Prepared.Identity, &validate_calibration);
+	}
+	return true;
+}
+
+bool linux_hidraw_device_info::read_calibration_report(FPlatformDeviceHandle Handle, unsigned char* Report, std::size_t Length)
+{
+	const int Fd = get_fd(Handle);
+	return Fd >= 0 && ioctl(Fd, HIDIOCGFEATURE(Length), Report) >= 0;
+}
+
+bool linux_hidraw_device_info::resolve_calibration(const std::string& Path, linux_prepared_device& Prepared)
+{
+	return linux_calibration_cache::Get().resolve(Path, Prepared.Handle, &read_calibration_report,
+	                                              Prepared.Calibration, Prepared.Identity, Prepared.bCalibrationCached);
+}
+
+void linux_hidraw_device_info::validate_calibration(FPlatformDeviceHandle Handle, const unsigned char* Data, std::size_t Length)
+{
+	linux_calibration_cache::Get().validate(Handle, std::string_view(reinterpret_cast<const char*>(Data), Length), &read_calibration_report);
+}
+
+void linux_hidraw_device_info::close_prepared(FPlatformDeviceHandle Handle)
+{
+	linux_hidraw_handle* Device = to_hidraw(Handle);
+	if (Device)
+	{
+		close(Device->Fd);
+		delete Device;
+	}
+}
+
+void linux_hidraw_device_info::write(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	if (!linux_defer_output(linux_device_state_registry::Get().Find(Context->Handle).get(), linux_device_info::get_config(), Context, &flush_output))
+	{
+		send_output(Context);
+	}
+}
+
+void linux_hidraw_device_info::flush_output(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	unsigned char Report[linux_device_state::kMaxOutputSize];
+	if (linux_claim_pending_output(State.get(), linux_device_info::get_config(), Context->ConnectionType == EDSDeviceConnection::Bluetooth, Report))
+	{
+		send_report(Context, State.get(), Report);
+	}
+}
+
+void linux_hidraw_device_info::send_output(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	send_report(Context, linux_device_state_registry::Get().Find(Context->Handle).get(), Context->GetRawOutputBuffer());
+}
+
+void linux_hidraw_device_info::send_report(FDeviceContext* Context, linux_device_state* State, const unsigned char* Report)
+{
+	if (!State)
+	{
+		return;
+	}
+	const linux_device_config& Config = linux_device_info::get_config();
+	const size_t OutputReportLength = State->Reports.Output;
+	const bool bBluetooth = Context->ConnectionType == EDSDeviceConnection::Bluetooth;
+	if (!linux_should_send_output(State, Config, Report, (std::int32_t)OutputReportLength, bBluetooth))
+	{
+		return;
+	}
+
+	if (Config.bAsyncWriter)
+	{
+		if (linux_hid_writer::Get().enqueue(Context->Handle, &hidraw_write, Report, OutputReportLength))
+		{
+			linux_record_output(State, Config, Report, (std::int32_t)OutputReportLength, bBluetooth);
+		}
+		return;
+	}
+
+	const ssize_t BytesWritten = ::write(get_fd(Context->Handle), Report, OutputReportLength);
+	if (BytesWritten >= 0)
+	{
+		linux_record_output(State, Config, Report, (std::int32_t)OutputReportLength, bBluetooth);
+	}
+	else if (should_treat_as_disconnected(errno))
+	{
+		invalidate_handle(Context);
+	}
+}
+
+void linux_hidraw_device_info::detect(std::vector<FDeviceContext>& Devices)
+{
+	detect_with(Devices, &hidraw_open_prepared, &close_prepared);
+}
+
+void linux_hidraw_device_info::detect_with(std::vector<FDeviceContext>& Devices, linux_device_opener::FOpenFn Open, linux_device_opener::FCloseFn Close)
+{
+	detect_changes(GAdded, GRemoved);
+	if (!linux_device_info::get_config().bAsyncOpen)
+	{
+		linux_reconcile_devices(GTracker.devices(), Devices);
+		return;
+	}
+
+	linux_device_opener::Get().publish(GTracker.devices(), GRemoved, Open, Close, GPublished);
+	linux_reconcile_devices(GPublished, Devices);
+}
+
+bool linux_hidraw_device_info::detect_changes(std::vector<linux_detected_device>& Added, std::vector<linux_detected_device>& Removed)
+{
+	linux_hotplug_monitor& Monitor = linux_hotplug_monitor::Get();
+	if (linux_device_info::get_config().bHotplugMonitor && Monitor.start())
+	{
+		// Steady state: nothing was plugged or unplugged, so no syscall at all.
+		if (Monitor.generation() == GDetectedGeneration)
+		{
+			Added.clear();
+			Removed.clear();
+			return false;
+		}
+		GDetectedGeneration = Monitor.snapshot(GNodes);
+	}
+	else
+	{
+		linux_hotplug_monitor::scan(GNodes);
+	}
+
+	GTracker.begin();
+	for (const linux_hidraw_node& Node : GNodes)
+	{
+		EDSDeviceType DeviceType;
+		if (Node.Vendor != SONY_VENDOR_ID || (Node.Bus != kBusUsb && Node.Bus != kBusBluetooth) ||
+		    !linux_find_device_type(static_cast<std::uint16_t>(Node.Product), DeviceType))
+		{
+			continue;
+		}
+		GTracker.add(Node.Path.c_str(), DeviceType, (Node.Bus == kBusBluetooth) ? EDSDeviceConnection::Bluetooth : EDSDeviceConnection::Usb);
+	}
+	return GTracker.commit(Added, Removed, linux_monotonic_ns());
+}
+
+std::uint64_t linux_hidraw_device_info::detected_at(const std::string& Path)
+{
+	return GTracker.detected_at(Path.c_str());
+}
+
+bool linux_hidraw_device_info::create_handle(FDeviceContext* Context)
+{
+	if (!Context)
+	{
+		return false;
+	}
+
+	const linux_device_config& Config = linux_device_info::get_config();
+	linux_prepared_device Prepared;
+	const bool bPrepared = Config.bAsyncOpen && linux_device_opener::Get().take(Context->Path, Prepared);
+	if (!bPrepared)
+	{
+		Prepared.DetectedAtNs = detected_at(Context->Path);
+		const int Fd = open(Context->Path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+		if (Fd < 0)
+		{
+			return false;
+		}
+		linux_hidraw_handle* Device = new linux_hidraw_handle();
+		Device->Fd = Fd;
+		Prepared.Handle = Device;
+	}
+
+	const int Fd = to_hidraw(Prepared.Handle)->Fd;
+	Context->Handle = Prepared.Handle;
+
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Attach(Context->Handle, Context);
+	linux_settle_report_sizes(State.get(), Context);
+
+	if (Config.bInputReactor)
+	{
+		// We own the descriptor, so the reactor can watch it directly instead of opening a second one.
+		linux_input_reactor::Get().watch_fd(Context->Handle, Fd);
+	}
+
+	if (!bPrepared)
+	{
+		configure_features(Context);
+		Prepared.ReadyAtNs = linux_monotonic_ns();
+	}
+	else if (Prepared.bCalibrated)
+	{
+		Context->Calibration = Prepared.Calibration;
+		if (Prepared.bCalibrationCached)
+		{
+			linux_calibration_cache::schedule_validation(Context->Handle, Prepared.Identity, &validate_calibration);
+		}
+	}
+	linux_record_open(State.get(), Prepared.DetectedAtNs, Prepared.ReadyAtNs);
+	return true;
+}
+
+void linux_hidraw_device_info::invalidate_handle(FDeviceContext* Context)
+{
+	if (Context)
+	{
+		linux_hidraw_handle* Device = to_hidraw(Context->Handle);
+		if (Device != nullptr)
+		{
+			linux_input_reactor::Get().unwatch(Context->Handle);
+			linux_device_state_registry::Get().Detach(Context->Handle);
+			linux_hid_writer::Get().retire(Context->Handle);
+			linux_calibration_cache::Get().forget(Context->Handle);
+			linux_device_opener::Get().release(Context->Path);
+			close(Device->Fd);
+			delete Device;
+		}
+
+		Context->Handle = INVALID_PLATFORM_HANDLE;
+		Context->IsConnected = false;
+
+		Context->Path.clear();
+		std::memset(Context->Buffer, 0, sizeof(Context->Buffer));
+		std::memset(Context->BufferDS4, 0, sizeof(Context->BufferDS4));
+		std::memset(Context->BufferAudio, 0, sizeof(Context->BufferAudio));
+
+		unsigned char* RawOutput = Context->GetRawOutputBuffer();
+		std::memset(RawOutput, 0, 78);
+	}
+}
+
+std::string linux_hidraw_device_info::get_container_id(const std::string& DevicePath)
+{
+	return linux_device_info::get_container_id(DevicePath);
+}
+
+std::string linux_hidraw_device_info::get_audio_container_id(const std::string& AudioDeviceId)
+{
+	return linux_device_info::get_audio_container_id(AudioDeviceId);
+}
+
+EPollResult linux_hidraw_device_info::poll_tick(FPlatformDeviceHandle Handle, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead)
+{
+	OutBytesRead = 0;
+	const int Fd = get_fd(Handle);
+	if (Fd < 0)
+	{
+		return EPollResult::Disconnected;
+	}
+
+	// One syscall per report: SDL_hidapi issues a poll() before every read() even in non-blocking mode.
+	const ssize_t Result = ::read(Fd, Buffer, Length);
+	if (Result < 0)
+	{
+		if (!should_treat_as_disconnected(errno))
+		{
+			return EPollResult::NoIoThisTick;
+		}
+		return EPollResult::Disconnected;
+	}
+
+	if (Result == 0)
+	{
+		return EPollResult::NoIoThisTick;
+	}
+
+	OutBytesRead = (std::int32_t)Result;
+	return EPollResult::ReadOk;
+}
+
+EPollResult linux_hidraw_device_info::drain_tick(FPlatformDeviceHandle Handle, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead)
+{
+	return linux_drain_reports(linux_device_state_registry::Get().Find(Handle).get(), linux_device_info::get_config(), Buffer, Length, OutBytesRead,
+	                           [Handle](unsigned char* Target, std::int32_t TargetLength, std::int32_t& BytesRead) {
+		                           return poll_tick(Handle, Target, TargetLength, BytesRead);
+	                           });
+}
+#endif
+#endif
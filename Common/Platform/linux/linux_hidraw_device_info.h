@@ -0,0 +1,63 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "linux_device_info.h"
+#include "linux_device_opener.h"
+#include "linux_device_state.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Handle behind FPlatformDeviceHandle for the native hidraw backend.
+ */
+struct linux_hidraw_handle
+{
+	int Fd = -1;
+};
+
+/**
+ * @brief Linux backend that talks to /dev/hidraw* directly instead of going through SDL_hidapi.
+ *
+ * Enumeration reads the HID uevent of every node under /sys/class/hidraw, reads and writes are
+ * plain read()/write() on a non-blocking descriptor and feature reports use HIDIOCGFEATURE.
+ * Read modes, statistics and the input reactor are shared with linux_device_info, and
+ * linux_device_info::configure() tunes both backends.
+ */
+class linux_hidraw_device_info
+{
+public:
+	virtual ~linux_hidraw_device_info() = default;
+	static void process_audio_haptic(FDeviceContext* Context);
+	static bool configure_features(FDeviceContext* Context);
+	static void read(FDeviceContext* Context);
+	static void write(FDeviceContext* Context);
+	static void send_output(FDeviceContext* Context);
+	static void send_report(FDeviceContext* Context, linux_device_state* State, const unsigned char* Report);
+	static void flush_output(FDeviceContext* Context);
+	static void detect(std::vector<FDeviceContext>& Devices);
+	static bool detect_changes(std::vector<linux_detected_device>& Added, std::vector<linux_detected_device>& Removed);
+	// When detect_changes() first saw the controller at Path; 0 when it is not present.
+	static std::uint64_t detected_at(const std::string& Path);
+	// detect() for backends built on hidraw nodes that prepare their devices with their own Open.
+	static void detect_with(std::vector<FDeviceContext>& Devices, linux_device_opener::FOpenFn Open, linux_device_opener::FCloseFn Close);
+	// linux_calibration_cache::FReadReportFn for hidraw descriptors (HIDIOCGFEATURE).
+	static bool read_calibration_report(FPlatformDeviceHandle Handle, unsigned char* Report, std::size_t Length);
+	// Calibration of a just opened device through linux_calibration_cache.
+	static bool resolve_calibration(const std::string& Path, linux_prepared_device& Prepared);
+	// linux_hid_writer task that re-checks a cached calibration; Data is the cache identity.
+	static void validate_calibration(FPlatformDeviceHandle Handle, const unsigned char* Data, std::size_t Length);
+	// Closes a prepared linux_hidraw_handle that was never adopted.
+	static void close_prepared(FPlatformDeviceHandle Handle);
+	static bool create_handle(FDeviceContext* Context);
+	static void invalidate_handle(FDeviceContext* Context);
+	static std::string get_container_id(const std::string& DevicePath);
+	static std::string get_audio_container_id(const std::string& AudioDeviceId);
+	static EPollResult poll_tick(FPlatformDeviceHandle Handle, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead);
+	static EPollResult drain_tick(FPlatformDeviceHandle Handle, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead);
+	static int get_fd(FPlatformDeviceHandle Handle);
+	static bool should_treat_as_disconnected(const int Error);
+};
+#endif
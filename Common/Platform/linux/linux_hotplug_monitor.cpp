@@ -0,0 +1,402 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "linux_hotplug_monitor.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#ifdef __unix__
+#include "linux_input_reactor.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static constexpr const char* kHidrawClassPath = "/sys/class/hidraw";
+// Multicast groups of NETLINK_KOBJECT_UEVENT: raw kernel events and udev's processed re-broadcast.
+static constexpr std::uint32_t kKernelGroup = 1;
+static constexpr std::uint32_t kUdevGroup = 2;
+static constexpr std::uint32_t kUdevMagic = 0xfeedcafe;
+
+// Prefix of udev's re-broadcast messages (libudev's udev_monitor_netlink_header).
+struct udev_netlink_header
+{
+	char Prefix[8];
+	std::uint32_t Magic;
+	std::uint32_t HeaderSize;
+	std::uint32_t PropertiesOffset;
+	std::uint32_t PropertiesLength;
+};
+
+// Reads HID_ID=<bus>:<vendor>:<product> from the uevent of the HID device behind a hidraw sysfs dir.
+static bool read_hid_id(const char* NodeDir, std::uint32_t& OutBus, std::uint32_t& OutVendor, std::uint32_t& OutProduct)
+{
+	char UeventPath[PATH_MAX];
+	if (std::snprintf(UeventPath, sizeof(UeventPath), "%s/device/uevent", NodeDir) >= (int)sizeof(UeventPath))
+	{
+		return false;
+	}
+	FILE* File = std::fopen(UeventPath, "r");
+	if (!File)
+	{
+		return false;
+	}
+
+	bool bFound = false;
+	char Line[256];
+	while (std::fgets(Line, sizeof(Line), File))
+	{
+		if (std::sscanf(Line, "HID_ID=%x:%x:%x", &OutBus, &OutVendor, &OutProduct) == 3)
+		{
+			bFound = true;
+			break;
+		}
+	}
+	std::fclose(File);
+	return bFound;
+}
+
+// The HID device directory is named <bus>:<vendor>:<product>.<instance>, right above "/hidraw/".
+static bool parse_hid_id_from_devpath(const std::string& DevPath, std::uint32_t& OutBus, std::uint32_t& OutVendor, std::uint32_t& OutProduct)
+{
+	const std::size_t HidrawDir = DevPath.rfind("/hidraw/");
+	if (HidrawDir == std::string::npos || HidrawDir == 0)
+	{
+		return false;
+	}
+
+	const std::size_t NameStart = DevPath.rfind('/', HidrawDir - 1);
+	if (NameStart == std::string::npos)
+	{
+		return false;
+	}
+	const std::string Name = DevPath.substr(NameStart + 1, HidrawDir - NameStart - 1);
+	return std::sscanf(Name.c_str(), "%x:%x:%x.", &OutBus, &OutVendor, &OutProduct) == 3;
+}
+
+linux_hotplug_monitor& linux_hotplug_monitor::Get()
+{
+	static linux_hotplug_monitor Instance;
+	return Instance;
+}
+
+linux_hotplug_monitor::~linux_hotplug_monitor()
+{
+	stop();
+}
+
+void linux_hotplug_monitor::scan(std::vector<linux_hidraw_node>& OutNodes)
+{
+	// Entries are reused rather than cleared so a repeated scan does not reallocate their paths.
+	std::size_t Count = 0;
+	DIR* ClassDir = opendir(kHidrawClassPath);
+	if (ClassDir)
+	{
+		char NodeDir[PATH_MAX];
+		while (const dirent* Entry = readdir(ClassDir))
+		{
+			std::uint32_t Bus = 0;
+			std::uint32_t Vendor = 0;
+			std::uint32_t Product = 0;
+			if (std::strncmp(Entry->d_name, "hidraw", 6) != 0 ||
+			    std::snprintf(NodeDir, sizeof(NodeDir), "%s/%s", kHidrawClassPath, Entry->d_name) >= (int)sizeof(NodeDir) ||
+			    !read_hid_id(NodeDir, Bus, Vendor, Product))
+			{
+				continue;
+			}
+
+			if (Count == OutNodes.size())
+			{
+				OutNodes.emplace_back();
+			}
+			linux_hidraw_node& Node = OutNodes[Count++];
+			Node.Path.assign("/dev/").append(Entry->d_name);
+			Node.Bus = Bus;
+			Node.Vendor = Vendor;
+			Node.Product = Product;
+		}
+		closedir(ClassDir);
+	}
+	OutNodes.resize(Count);
+}
+
+bool linux_hotplug_monitor::read_node(const std::string& DevicePath, linux_hidraw_node& OutNode)
+{
+	const std::size_t NameStart = DevicePath.rfind('/');
+	const char* Name = DevicePath.c_str() + (NameStart == std::string::npos ? 0 : NameStart + 1);
+	char NodeDir[PATH_MAX];
+	if (std::strncmp(Name, "hidraw", 6) != 0 || std::snprintf(NodeDir, sizeof(NodeDir), "%s/%s", kHidrawClassPath, Name) >= (int)sizeof(NodeDir) ||
+	    !read_hid_id(NodeDir, OutNode.Bus, OutNode.Vendor, OutNode.Product))
+	{
+		return false;
+	}
+	OutNode.Path = DevicePath;
+	return true;
+}
+
+bool linux_hotplug_monitor::start()
+{
+	if (bRunning.load(std::memory_order_acquire))
+	{
+		return true;
+	}
+	if (bUnavailable.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(StartMutex);
+	if (bRunning.load(std::memory_order_relaxed))
+	{
+		return true;
+	}
+
+	Socket = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+	if (Socket < 0)
+	{
+		bUnavailable.store(true, std::memory_order_relaxed);
+		return false;
+	}
+
+	// Credentials let run() drop events that were not sent by root (the kernel or udevd).
+	const int On = 1;
+	setsockopt(Socket, SOL_SOCKET, SO_PASSCRED, &On, sizeof(On));
+	const int ReceiveBuffer = 1 << 20;
+	setsockopt(Socket, SOL_SOCKET, SO_RCVBUF, &ReceiveBuffer, sizeof(ReceiveBuffer));
+
+	// Without udevd nobody re-broadcasts on the udev group; /run/udev/control is how libudev tells.
+	sockaddr_nl Address{};
+	Address.nl_family = AF_NETLINK;
+	Address.nl_groups = (access("/run/udev/control", F_OK) == 0) ? kUdevGroup : kKernelGroup;
+	StopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (bind(Socket, reinterpret_cast<sockaddr*>(&Address), sizeof(Address)) < 0 || StopFd < 0)
+	{
+		close(Socket);
+		Socket = -1;
+		if (StopFd >= 0)
+		{
+			close(StopFd);
+			StopFd = -1;
+		}
+		bUnavailable.store(true, std::memory_order_relaxed);
+		return false;
+	}
+
+	// Bound before scanning: a device plugged in between is both scanned and reported, never lost.
+	{
+		gc_lock::lock_guard<gc_lock::mutex> NodesLock(Mutex);
+		scan(Nodes);
+	}
+	Generation.fetch_add(1, std::memory_order_release);
+
+	bRunning.store(true, std::memory_order_release);
+	Thread = std::thread(&linux_hotplug_monitor::run, this);
+	return true;
+}
+
+void linux_hotplug_monitor::stop()
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(StartMutex);
+	if (!bRunning.exchange(false))
+	{
+		return;
+	}
+
+	const std::uint64_t One = 1;
+	[[maybe_unused]] const ssize_t Written = ::write(StopFd, &One, sizeof(One));
+	if (Thread.joinable())
+	{
+		Thread.join();
+	}
+	close(Socket);
+	close(StopFd);
+	Socket = -1;
+	StopFd = -1;
+}
+
+std::uint64_t linux_hotplug_monitor::snapshot(std::vector<linux_hidraw_node>& OutNodes)
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	OutNodes = Nodes;
+	return Generation.load(std::memory_order_acquire);
+}
+
+void linux_hotplug_monitor::run()
+{
+	pollfd Fds[2] = {{Socket, POLLIN, 0}, {StopFd, POLLIN, 0}};
+	while (bRunning.load(std::memory_order_acquire))
+	{
+		if (poll(Fds, 2, -1) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return;
+		}
+		if (Fds[1].revents & POLLIN)
+		{
+			return;
+		}
+		if (Fds[0].revents & POLLIN)
+		{
+			receive_all();
+		}
+	}
+}
+
+void linux_hotplug_monitor::receive_all()
+{
+	char Buffer[8192];
+	alignas(cmsghdr) char Control[CMSG_SPACE(sizeof(ucred))];
+	while (true)
+	{
+		iovec Vector{Buffer, sizeof(Buffer) - 1};
+		sockaddr_nl Sender{};
+		msghdr Message{};
+		Message.msg_name = &Sender;
+		Message.msg_namelen = sizeof(Sender);
+		Message.msg_iov = &Vector;
+		Message.msg_iovlen = 1;
+		Message.msg_control = Control;
+		Message.msg_controllen = sizeof(Control);
+
+		const ssize_t Length = recvmsg(Socket, &Message, 0);
+		if (Length < 0)
+		{
+			if (errno == ENOBUFS)
+			{
+				// The socket overflowed and events were lost: resynchronise from sysfs.
+				{
+					gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+					scan(Nodes);
+				}
+				Generation.fetch_add(1, std::memory_order_release);
+				SoundGeneration.fetch_add(1, std::memory_order_release);
+				linux_input_reactor::Get().wake();
+				continue;
+			}
+			return;
+		}
+
+		const cmsghdr* Header = CMSG_FIRSTHDR(&Message);
+		if (!Header || Header->cmsg_level != SOL_SOCKET || Header->cmsg_type != SCM_CREDENTIALS)
+		{
+			continue;
+		}
+		ucred Credentials;
+		std::memcpy(&Credentials, CMSG_DATA(Header), sizeof(Credentials));
+		if (Credentials.uid != 0)
+		{
+			continue;
+		}
+
+		Buffer[Length] = '\0';
+		apply(Buffer, static_cast<std::size_t>(Length));
+	}
+}
+
+void linux_hotplug_monitor::apply(const char* Message, std::size_t Length)
+{
+	// Kernel events start with "<action>@<devpath>", udev events with a binary header; both
+	// continue with NUL-separated KEY=VALUE properties.
+	const char* Properties = Message;
+	const char* End = Message + Length;
+	if (Length >= sizeof(udev_netlink_header) && std::memcmp(Message, "libudev", 8) == 0)
+	{
+		udev_netlink_header Header;
+		std::memcpy(&Header, Message, sizeof(Header));
+		if (ntohl(Header.Magic) != kUdevMagic || Header.PropertiesOffset >= Length ||
+		    Header.PropertiesLength > Length - Header.PropertiesOffset)
+		{
+			return;
+		}
+		Properties = Message + Header.PropertiesOffset;
+		End = Properties + Header.PropertiesLength;
+	}
+	else
+	{
+		Properties += std::strlen(Message) + 1;
+	}
+
+	std::string Action;
+	std::string Subsystem;
+	std::string DevName;
+	std::string DevPath;
+	for (const char* Cursor = Properties; Cursor < End; Cursor += std::strlen(Cursor) + 1)
+	{
+		if (std::strncmp(Cursor, "ACTION=", 7) == 0)
+		{
+			Action = Cursor + 7;
+		}
+		else if (std::strncmp(Cursor, "SUBSYSTEM=", 10) == 0)
+		{
+			Subsystem = Cursor + 10;
+		}
+		else if (std::strncmp(Cursor, "DEVNAME=", 8) == 0)
+		{
+			DevName = Cursor + 8;
+		}
+		else if (std::strncmp(Cursor, "DEVPATH=", 8) == 0)
+		{
+			DevPath = Cursor + 8;
+		}
+	}
+
+	if (Subsystem == "sound" && (Action == "add" || Action == "remove"))
+	{
+		// Only counted: linux_audio_context re-enumerates playback devices when this moves.
+		SoundGeneration.fetch_add(1, std::memory_order_release);
+		return;
+	}
+	if (Subsystem != "hidraw" || DevName.empty() || (Action != "add" && Action != "remove"))
+	{
+		return;
+	}
+
+	// The kernel reports DEVNAME relative to /dev, udev as an absolute path.
+	linux_hidraw_node Node;
+	Node.Path = (DevName[0] == '/') ? DevName : "/dev/" + DevName;
+	if (Action == "add" && !parse_hid_id_from_devpath(DevPath, Node.Bus, Node.Vendor, Node.Product) &&
+	    !read_hid_id(("/sys" + DevPath).c_str(), Node.Bus, Node.Vendor, Node.Product))
+	{
+		return;
+	}
+
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		const auto Existing = std::find_if(Nodes.begin(), Nodes.end(), [&Node](const linux_hidraw_node& Other) {
+			return Other.Path == Node.Path;
+		});
+		if (Action == "add")
+		{
+			if (Existing != Nodes.end())
+			{
+				*Existing = std::move(Node);
+			}
+			else
+			{
+				Nodes.push_back(std::move(Node));
+			}
+		}
+		else if (Existing != Nodes.end())
+		{
+			Nodes.erase(Existing);
+		}
+		else
+		{
+			return;
+		}
+	}
+
+	EventsApplied.fetch_add(1, std::memory_order_relaxed);
+	Generation.fetch_add(1, std::memory_order_release);
+	// Loops blocked in wait_until() pick the new controller up now rather than at the next frame.
+	linux_input_reactor::Get().wake();
+}
+#endif
+#endif
@@ -0,0 +1,80 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Utils/SoDefines.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief One /dev/hidraw* node and the HID id of the device behind it.
+ */
+struct linux_hidraw_node
+{
+	std::string Path;
+	std::uint32_t Bus = 0;
+	std::uint32_t Vendor = 0;
+	std::uint32_t Product = 0;
+};
+
+/**
+ * @brief Event-driven view of the hidraw nodes present on the system.
+ *
+ * start() takes one sysfs snapshot, then a thread blocks on a NETLINK_KOBJECT_UEVENT socket
+ * and applies hidraw add/remove events to it. It listens to udev's multicast group when
+ * udevd is running, so a node is only announced once its permissions are set, and to the
+ * kernel group otherwise. Every change bumps generation() and wakes linux_input_reactor,
+ * so detect() can return its cached list without any syscall until something is plugged.
+ * Sound subsystem events only bump sound_generation().
+ */
+class linux_hotplug_monitor
+{
+public:
+	static linux_hotplug_monitor& Get();
+
+	~linux_hotplug_monitor();
+
+	// Idempotent; false when the netlink socket cannot be opened (callers fall back to enumeration).
+	// A failed start is remembered so fallback callers do not retry the socket every tick.
+	bool start();
+	void stop();
+	bool is_running() const { return bRunning.load(std::memory_order_acquire); }
+
+	// Bumped on every applied add/remove; starts at 1 once running.
+	std::uint64_t generation() const { return Generation.load(std::memory_order_acquire); }
+	// Copies the current node list and returns the generation it belongs to.
+	std::uint64_t snapshot(std::vector<linux_hidraw_node>& OutNodes);
+	std::uint64_t events_applied() const { return EventsApplied.load(std::memory_order_relaxed); }
+	// Bumped whenever a sound card or PCM node comes or goes (and after event loss).
+	std::uint64_t sound_generation() const { return SoundGeneration.load(std::memory_order_acquire); }
+
+	// Full enumeration of /sys/class/hidraw; used for the initial snapshot, after event loss and
+	// by the polling fallback. Reuses OutNodes' entries, so steady-state polling does not allocate.
+	static void scan(std::vector<linux_hidraw_node>& OutNodes);
+	// Looks up one /dev/hidraw* path in sysfs; false for other paths or a node that is already gone.
+	static bool read_node(const std::string& DevicePath, linux_hidraw_node& OutNode);
+
+private:
+	linux_hotplug_monitor() = default;
+
+	void run();
+	void receive_all();
+	void apply(const char* Message, std::size_t Length);
+
+	int Socket = -1;
+	int StopFd = -1;
+	std::thread Thread;
+	std::atomic<bool> bRunning{false};
+	std::atomic<bool> bUnavailable{false};
+	std::atomic<std::uint64_t> Generation{0};
+	std::atomic<std::uint64_t> EventsApplied{0};
+	std::atomic<std::uint64_t> SoundGeneration{0};
+
+	gc_lock::mutex StartMutex;
+	gc_lock::mutex Mutex;
+	std::vector<linux_hidraw_node> Nodes;
+};
+#endif
@@ -0,0 +1,205 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "linux_input_reactor.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#ifdef __unix__
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+
+static constexpr int kMaxEventsPerWait = 32;
+
+linux_input_reactor& linux_input_reactor::Get()
+{
+	static linux_input_reactor Instance;
+	return Instance;
+}
+
+linux_input_reactor::linux_input_reactor()
+{
+	EpollFd = epoll_create1(EPOLL_CLOEXEC);
+	WakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (EpollFd >= 0 && WakeFd >= 0)
+	{
+		epoll_event Event{};
+		Event.events = EPOLLIN;
+		Event.data.ptr = nullptr;
+		epoll_ctl(EpollFd, EPOLL_CTL_ADD, WakeFd, &Event);
+	}
+}
+
+linux_input_reactor::~linux_input_reactor()
+{
+	for (auto& [Handle, Entry] : Entries)
+	{
+		if (Entry->bOwnsFd)
+		{
+			close(Entry->Fd);
+		}
+	}
+	Entries.clear();
+
+	if (WakeFd >= 0)
+	{
+		close(WakeFd);
+	}
+	if (EpollFd >= 0)
+	{
+		close(EpollFd);
+	}
+}
+
+bool linux_input_reactor::add_entry(FPlatformDeviceHandle Handle, int Fd, bool bOwnsFd)
+{
+	if (EpollFd < 0 || Fd < 0)
+	{
+		return false;
+	}
+
+	unwatch(Handle);
+
+	auto Entry = std::make_unique<watch_entry>();
+	Entry->Handle = Handle;
+	Entry->Fd = Fd;
+	Entry->bOwnsFd = bOwnsFd;
+
+	epoll_event Event{};
+	Event.events = EPOLLIN | EPOLLET;
+	Event.data.ptr = Entry.get();
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	if (epoll_ctl(EpollFd, EPOLL_CTL_ADD, Fd, &Event) != 0)
+	{
+		return false;
+	}
+	Entries[Handle] = std::move(Entry);
+	return true;
+}
+
+bool linux_input_reactor::watch(FPlatformDeviceHandle Handle, const std::string& Path)
+{
+	const int Fd = open(Path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if (Fd < 0)
+	{
+		return false;
+	}
+
+	if (!add_entry(Handle, Fd, true))
+	{
+		close(Fd);
+		return false;
+	}
+	return true;
+}
+
+bool linux_input_reactor::watch_fd(FPlatformDeviceHandle Handle, int Fd)
+{
+	return add_entry(Handle, Fd, false);
+}
+
+void linux_input_reactor::unwatch(FPlatformDeviceHandle Handle)
+{
+	std::unique_ptr<watch_entry> Entry;
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		auto It = Entries.find(Handle);
+		if (It == Entries.end())
+		{
+			return;
+		}
+		Entry = std::move(It->second);
+		Entries.erase(It);
+		epoll_ctl(EpollFd, EPOLL_CTL_DEL, Entry->Fd, nullptr);
+	}
+
+	if (Entry->bOwnsFd)
+	{
+		close(Entry->Fd);
+	}
+}
+
+std::size_t linux_input_reactor::watched_count()
+{
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+	return Entries.size();
+}
+
+int linux_input_reactor::wait_until(std::chrono::steady_clock::time_point Deadline, std::vector<FPlatformDeviceHandle>* OutReady)
+{
+	if (EpollFd < 0)
+	{
+		std::this_thread::sleep_until(Deadline);
+		return 0;
+	}
+
+	epoll_event Events[kMaxEventsPerWait];
+	int Ready = 0;
+	while (true)
+	{
+		const auto Now = std::chrono::steady_clock::now();
+		const auto Remaining = std::chrono::duration_cast<std::chrono::microseconds>(Deadline - Now);
+		if (Remaining.count() <= 0)
+		{
+			return 0;
+		}
+
+		// epoll_wait only takes milliseconds; round up so a short deadline does not become a busy loop.
+		const int TimeoutMs = static_cast<int>((Remaining.count() + 999) / 1000);
+		const int Count = epoll_wait(EpollFd, Events, kMaxEventsPerWait, TimeoutMs);
+		if (Count < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return 0;
+		}
+		if (Count == 0)
+		{
+			return 0;
+		}
+
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		for (int i = 0; i < Count; ++i)
+		{
+			const watch_entry* Entry = static_cast<const watch_entry*>(Events[i].data.ptr);
+			if (!Entry)
+			{
+				std::uint64_t Counter = 0;
+				[[maybe_unused]] const ssize_t Drained = read(WakeFd, &Counter, sizeof(Counter));
+				continue;
+			}
+
+			// An entry removed while we were waiting may still be reported once; ignore stale pointers.
+			auto It = Entries.find(Entry->Handle);
+			if (It == Entries.end() || It->second.get() != Entry)
+			{
+				continue;
+			}
+
+			++Ready;
+			if (OutReady)
+			{
+				OutReady->push_back(Entry->Handle);
+			}
+		}
+
+		Wakeups.fetch_add(1, std::memory_order_relaxed);
+		return Ready;
+	}
+}
+
+void linux_input_reactor::wake()
+{
+	if (WakeFd >= 0)
+	{
+		const std::uint64_t One = 1;
+		[[maybe_unused]] const ssize_t Written = write(WakeFd, &One, sizeof(One));
+	}
+}
+#endif
+#endif
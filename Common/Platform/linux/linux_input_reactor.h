@@ -0,0 +1,66 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "GCore/Utils/SoDefines.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief epoll-based readiness reactor over the controllers' hidraw file descriptors.
+ *
+ * Instead of sleeping a fixed frame and polling every device, callers block in wait_until()
+ * and are woken as soon as any watched controller delivers a report (or wake() is called
+ * from another thread through the internal eventfd).
+ *
+ * SDL_hidapi does not expose its descriptor, so watch() opens a second read-only descriptor
+ * on the same hidraw node. hidraw queues every report for every reader and wakes all of them,
+ * so that descriptor is registered edge-triggered and never read: each new report produces
+ * exactly one wakeup, and its private queue simply saturates at 64 reports.
+ */
+class linux_input_reactor
+{
+public:
+	static linux_input_reactor& Get();
+
+	~linux_input_reactor();
+
+	// Watches the hidraw node at Path on behalf of Handle through a private read-only descriptor.
+	bool watch(FPlatformDeviceHandle Handle, const std::string& Path);
+	// Watches a descriptor owned by the backend itself; it is not closed by unwatch().
+	bool watch_fd(FPlatformDeviceHandle Handle, int Fd);
+	void unwatch(FPlatformDeviceHandle Handle);
+	std::size_t watched_count();
+
+	// Blocks until a watched device has input, wake() is called or Deadline passes.
+	// Ready handles are appended to OutReady when provided; returns the number of ready devices.
+	int wait_until(std::chrono::steady_clock::time_point Deadline, std::vector<FPlatformDeviceHandle>* OutReady = nullptr);
+	void wake();
+
+	std::uint64_t wakeups() const { return Wakeups.load(std::memory_order_relaxed); }
+
+private:
+	linux_input_reactor();
+
+	struct watch_entry
+	{
+		FPlatformDeviceHandle Handle = nullptr;
+		int Fd = -1;
+		bool bOwnsFd = false;
+	};
+
+	bool add_entry(FPlatformDeviceHandle Handle, int Fd, bool bOwnsFd);
+
+	int EpollFd = -1;
+	int WakeFd = -1;
+	gc_lock::mutex Mutex;
+	std::unordered_map<FPlatformDeviceHandle, std::unique_ptr<watch_entry>> Entries;
+
+	std::atomic<std::uint64_t> Wakeups{0};
+};
+#endif
@@ -0,0 +1,78 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "linux_report_sizes.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#ifdef __unix__
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+// HID_MAX_DESCRIPTOR_SIZE in the kernel.
+static constexpr std::size_t kMaxDescriptorSize = 4096;
+
+static std::size_t read_report_descriptor(std::string_view Path, unsigned char* Descriptor, std::size_t Capacity)
+{
+	const std::size_t NameStart = Path.rfind('/');
+	if (NameStart == std::string_view::npos || Path.substr(NameStart + 1, 6) != "hidraw")
+	{
+		return 0;
+	}
+
+	char DescriptorPath[PATH_MAX];
+	const std::string_view Name = Path.substr(NameStart + 1);
+	if (std::snprintf(DescriptorPath, sizeof(DescriptorPath), "/sys/class/hidraw/%.*s/device/report_descriptor", (int)Name.size(), Name.data()) >=
+	    (int)sizeof(DescriptorPath))
+	{
+		return 0;
+	}
+
+	const int Fd = open(DescriptorPath, O_RDONLY | O_CLOEXEC);
+	if (Fd < 0)
+	{
+		return 0;
+	}
+	std::size_t Total = 0;
+	while (Total < Capacity)
+	{
+		const ssize_t Read = ::read(Fd, Descriptor + Total, Capacity - Total);
+		if (Read <= 0)
+		{
+			break;
+		}
+		Total += static_cast<std::size_t>(Read);
+	}
+	close(Fd);
+	return Total;
+}
+
+linux_report_sizes linux_probe_report_sizes(std::string_view Path, EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType,
+                                            std::size_t InputCapacity, std::size_t LargeInputCapacity)
+{
+	linux_report_sizes Sizes = linux_default_report_sizes(DeviceType, ConnectionType);
+
+	unsigned char Descriptor[kMaxDescriptorSize];
+	const std::size_t Length = read_report_descriptor(Path, Descriptor, sizeof(Descriptor));
+	const std::size_t MaxInput = Length ? linux_max_report_size(Descriptor, Length, EHidReportKind::Input) : 0;
+	const std::size_t MaxOutput = Length ? linux_max_report_size(Descriptor, Length, EHidReportKind::Output) : 0;
+	if (MaxInput == 0 || MaxOutput == 0)
+	{
+		return Sizes;
+	}
+
+	// The parser reads whichever buffer bLargeInput names, so that choice stays the device type's; the
+	// descriptor may only shorten the read. A DualSense declares BT inputs up to 547 bytes but its
+	// state arrives in the 78-byte one.
+	const std::size_t Capacity = Sizes.bLargeInput ? LargeInputCapacity : InputCapacity;
+	Sizes.Input = static_cast<std::uint16_t>(std::min({static_cast<std::size_t>(Sizes.Input), MaxInput, Capacity}));
+	// Writing past the declared report is never valid; a shorter one is what the device expects.
+	Sizes.Output = static_cast<std::uint16_t>(std::min<std::size_t>(Sizes.Output, MaxOutput));
+	if (Sizes.Audio > MaxOutput)
+	{
+		Sizes.Audio = MaxOutput >= linux_report_sizes::kShortAudio ? linux_report_sizes::kShortAudio : 0;
+	}
+	Sizes.bFromDescriptor = true;
+	return Sizes;
+}
+#endif
+#endif
@@ -0,0 +1,176 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/ECoreGamepad.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief Report sizes of one device, settled once by create_handle().
+ *
+ * read(), send_output() and process_audio_haptic() use them as is, so the hot path does one
+ * correctly sized transfer instead of deriving the size or retrying a shorter one per packet.
+ */
+struct linux_report_sizes
+{
+	// Short form of the Bluetooth audio-haptic report.
+	static constexpr std::uint16_t kShortAudio = 78;
+
+	// Bytes requested per read; bLargeInput selects FDeviceContext::BufferDS4 over Buffer.
+	std::uint16_t Input = 0;
+	bool bLargeInput = false;
+	std::uint16_t Output = 0;
+	// Audio-haptic report, 0 when the connection carries none (USB audio goes through the sound card).
+	std::uint16_t Audio = 0;
+	// Sizes were checked against the device's report descriptor rather than only assumed.
+	bool bFromDescriptor = false;
+};
+
+// A long audio report the device refused, with sizes that were only assumed: fall back to the short
+// form for good. True when the size changed.
+constexpr bool linux_demote_audio_report(linux_report_sizes& Sizes)
+{
+	if (Sizes.bFromDescriptor || Sizes.Audio <= linux_report_sizes::kShortAudio)
+	{
+		return false;
+	}
+	Sizes.Audio = linux_report_sizes::kShortAudio;
+	return true;
+}
+
+enum class EHidReportKind : std::uint8_t
+{
+	Input,
+	Output,
+	Feature
+};
+
+// What the backends always assumed; used as is when the descriptor cannot be read.
+constexpr linux_report_sizes linux_default_report_sizes(EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType)
+{
+	linux_report_sizes Sizes;
+	const bool bBluetooth = ConnectionType == EDSDeviceConnection::Bluetooth;
+	const bool bDualShock4 = DeviceType == EDSDeviceType::DualShock4;
+	Sizes.Input = bBluetooth ? (bDualShock4 ? 547 : 78) : 64;
+	Sizes.bLargeInput = bBluetooth && bDualShock4;
+	Sizes.Output = bBluetooth ? 78 : (bDualShock4 ? 32 : 74);
+	Sizes.Audio = bBluetooth ? 147 : 0;
+	return Sizes;
+}
+
+/**
+ * @brief Largest report of Kind declared by a HID report descriptor, report ID byte included.
+ *
+ * Walks the short items, tracking Report ID, Report Size and Report Count (with Push/Pop) and
+ * summing the bits each Input/Output/Feature main item adds to its report. Returns 0 when the
+ * descriptor declares no report of that kind or is malformed.
+ */
+constexpr std::size_t linux_max_report_size(const unsigned char* Descriptor, std::size_t Length, EHidReportKind Kind)
+{
+	constexpr std::size_t kMaxReports = 256;
+	constexpr std::size_t kMaxStack = 4;
+	struct globals
+	{
+		std::uint32_t ReportSize = 0;
+		std::uint32_t ReportCount = 0;
+		std::uint32_t ReportId = 0;
+	};
+
+	std::uint32_t Bits[kMaxReports] = {};
+	globals Stack[kMaxStack] = {};
+	std::size_t Depth = 0;
+	globals Current;
+	bool bUsesIds = false;
+	const std::uint8_t MainTag = Kind == EHidReportKind::Input ? 0x8 : (Kind == EHidReportKind::Output ? 0x9 : 0xB);
+
+	std::size_t Offset = 0;
+	while (Offset < Length)
+	{
+		const std::uint8_t Prefix = Descriptor[Offset];
+		if (Prefix == 0xFE)
+		{
+			// Long item: skip it, none of the items we track can be long.
+			if (Offset + 2 >= Length)
+			{
+				return 0;
+			}
+			Offset += 3 + Descriptor[Offset + 1];
+			continue;
+		}
+
+		const std::size_t DataSize = (Prefix & 0x3) == 3 ? 4 : (Prefix & 0x3);
+		if (Offset + 1 + DataSize > Length)
+		{
+			return 0;
+		}
+		std::uint32_t Data = 0;
+		for (std::size_t i = 0; i < DataSize; ++i)
+		{
+			Data |= static_cast<std::uint32_t>(Descriptor[Offset + 1 + i]) << (8 * i);
+		}
+		Offset += 1 + DataSize;
+
+		const std::uint8_t Type = (Prefix >> 2) & 0x3;
+		const std::uint8_t Tag = Prefix >> 4;
+		if (Type == 0 && Tag == MainTag)
+		{
+			Bits[Current.ReportId] += Current.ReportSize * Current.ReportCount;
+		}
+		else if (Type == 1)
+		{
+			switch (Tag)
+			{
+				case 0x7: Current.ReportSize = Data; break;
+				case 0x8:
+					if (Data == 0 || Data >= kMaxReports)
+					{
+						return 0;
+					}
+					Current.ReportId = Data;
+					bUsesIds = true;
+					break;
+				case 0x9: Current.ReportCount = Data; break;
+				case 0xA:
+					if (Depth == kMaxStack)
+					{
+						return 0;
+					}
+					Stack[Depth++] = Current;
+					break;
+				case 0xB:
+					if (Depth == 0)
+					{
+						return 0;
+					}
+					Current = Stack[--Depth];
+					break;
+				default: break;
+			}
+		}
+	}
+
+	std::size_t Largest = 0;
+	for (std::size_t Id = 0; Id < kMaxReports; ++Id)
+	{
+		if (Bits[Id] > 0)
+		{
+			const std::size_t Bytes = (Bits[Id] + 7) / 8 + (bUsesIds ? 1 : 0);
+			Largest = Bytes > Largest ? Bytes : Largest;
+		}
+	}
+	return Largest;
+}
+
+/**
+ * @brief Settles the report sizes of the device behind a /dev/hidrawN path.
+ *
+ * Starts from linux_default_report_sizes() and narrows it with the report descriptor sysfs
+ * exposes for the node: reads never ask for more than the largest input report nor the buffer
+ * the device type reads into, and the audio report shrinks to the short 78-byte form when the
+ * device declares no output report able to carry the long one. InputCapacity and LargeInputCapacity are the sizes of the two read buffers.
+ */
+linux_report_sizes linux_probe_report_sizes(std::string_view Path, EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType,
+                                            std::size_t InputCapacity, std::size_t LargeInputCapacity);
+#endif
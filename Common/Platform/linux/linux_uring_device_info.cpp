@@ -0,0 +1,664 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "linux_uring_device_info.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#ifdef __unix__
+#include "GCore/Types/ECoreGamepad.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "GCore/Utils/SoDefines.h"
+#include "linux_calibration_cache.h"
+#include "linux_hid_writer.h"
+#include "linux_input_reactor.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <liburing.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+static constexpr unsigned kQueueDepth = 256;
+static constexpr int kWriteSlots = 8;
+static constexpr std::uint32_t kPendingReports = 16;
+static constexpr int kCancelTimeoutMs = 200;
+
+namespace
+{
+	struct uring_device;
+
+	enum class EUringRequest : std::uint8_t
+	{
+		Read,
+		Write
+	};
+
+	struct uring_request
+	{
+		uring_device* Device = nullptr;
+		EUringRequest Kind = EUringRequest::Read;
+		bool bInFlight = false;
+		// Submit epoch the request was queued in; equal to the current epoch while it still sits in the SQ.
+		std::uint64_t QueuedEpoch = 0;
+		std::int32_t Length = 0;
+		unsigned char Data[linux_input_report::kMaxSize] = {0};
+	};
+
+	// Derives from the hidraw handle so linux_hidraw_device_info can still reach the descriptor.
+	struct uring_device : linux_hidraw_handle
+	{
+		// One read per device: reads on one blocking hidraw descriptor may complete out of order, so
+		// the next one is posted only once the previous one completed.
+		uring_request Read;
+		uring_request Writes[kWriteSlots];
+		int InFlight = 0;
+		bool bDisconnected = false;
+		// Set by invalidate_handle(): completions stop re-arming reads.
+		bool bClosing = false;
+		// Handle already released while requests were still in the kernel; the last completion frees it.
+		bool bOrphaned = false;
+
+		// Completed reports not yet handed to read(), oldest first.
+		linux_input_report Pending[kPendingReports];
+		std::uint32_t PendingHead = 0;
+		std::uint32_t PendingCount = 0;
+	};
+
+	struct uring_context
+	{
+		gc_lock::mutex Mutex;
+		io_uring Ring{};
+		bool bInitialized = false;
+		bool bAvailable = false;
+		int EventFd = -1;
+		std::uint64_t Epoch = 1;
+		linux_uring_statistics Statistics;
+
+		~uring_context()
+		{
+			if (bAvailable)
+			{
+				io_uring_queue_exit(&Ring);
+			}
+			if (EventFd >= 0)
+			{
+				close(EventFd);
+			}
+		}
+	};
+} // namespace
+
+static uring_context& get_context()
+{
+	static uring_context Context;
+	return Context;
+}
+
+static bool ensure_ring_locked(uring_context& Ring)
+{
+	if (!Ring.bInitialized)
+	{
+		Ring.bInitialized = true;
+		Ring.bAvailable = io_uring_queue_init(kQueueDepth, &Ring.Ring, 0) == 0;
+	}
+	return Ring.bAvailable;
+}
+
+static uring_device* to_device(FPlatformDeviceHandle Handle)
+{
+	return static_cast<uring_device*>(static_cast<linux_hidraw_handle*>(Handle));
+}
+
+static int submit_locked(uring_context& Ring)
+{
+	if (io_uring_sq_ready(&Ring.Ring) == 0)
+	{
+		return 0;
+	}
+
+	const int Submitted = io_uring_submit(&Ring.Ring);
+	++Ring.Epoch;
+	++Ring.Statistics.Submits;
+	if (Submitted > 0)
+	{
+		Ring.Statistics.SqesSubmitted += Submitted;
+	}
+	return Submitted;
+}
+
+static io_uring_sqe* get_sqe_locked(uring_context& Ring)
+{
+	io_uring_sqe* Sqe = io_uring_get_sqe(&Ring.Ring);
+	if (!Sqe)
+	{
+		// SQ full: flush early rather than lose the request.
+		submit_locked(Ring);
+		Sqe = io_uring_get_sqe(&Ring.Ring);
+	}
+	return Sqe;
+}
+
+static bool queue_request_locked(uring_context& Ring, uring_request& Request, bool bWrite)
+{
+	io_uring_sqe* Sqe = get_sqe_locked(Ring);
+	if (!Sqe)
+	{
+		return false;
+	}
+
+	// Offset -1 means "current position", the only meaningful one for a character device.
+	if (bWrite)
+	{
+		io_uring_prep_write(Sqe, Request.Device->Fd, Request.Data, Request.Length, (__u64)-1);
+	}
+	else
+	{
+		io_uring_prep_read(Sqe, Request.Device->Fd, Request.Data, Request.Length, (__u64)-1);
+	}
+	io_uring_sqe_set_data(Sqe, &Request);
+	Request.bInFlight = true;
+	Request.QueuedEpoch = Ring.Epoch;
+	++Request.Device->InFlight;
+	return true;
+}
+
+static void arm_read_locked(uring_context& Ring, uring_device* Device)
+{
+	if (Device->bDisconnected || Device->bClosing || Device->Read.bInFlight)
+	{
+		return;
+	}
+	queue_request_locked(Ring, Device->Read, false);
+}
+
+// True while the re-armed read of the device still sits in the SQ.
+static bool has_queued_read_locked(const uring_context& Ring, const uring_device* Device)
+{
+	return Device->Read.bInFlight && Device->Read.QueuedEpoch == Ring.Epoch;
+}
+
+static void push_pending(uring_device* Device, const unsigned char* Data, std::int32_t Length)
+{
+	if (Device->PendingCount == kPendingReports)
+	{
+		// Keep the newest reports; the oldest one is the least useful.
+		Device->PendingHead = (Device->PendingHead + 1) % kPendingReports;
+		--Device->PendingCount;
+	}
+
+	linux_input_report& Report = Device->Pending[(Device->PendingHead + Device->PendingCount) % kPendingReports];
+	Report.Length = std::min<std::int32_t>(Length, (std::int32_t)linux_input_report::kMaxSize);
+	// Stamped at completion, not at delivery, so InputAgeUs includes the time spent in this queue.
+	Report.HostTimeNs = linux_monotonic_ns();
+	std::memcpy(Report.Data, Data, Report.Length);
+	++Device->PendingCount;
+}
+
+static void complete_locked(uring_context& Ring, uring_request& Request, int Result)
+{
+	uring_device* Device = Request.Device;
+	Request.bInFlight = false;
+	--Device->InFlight;
+
+	if (Device->bClosing)
+	{
+		if (Device->bOrphaned && Device->InFlight == 0)
+		{
+			delete Device;
+		}
+		return;
+	}
+
+	if (Request.Kind == EUringRequest::Read)
+	{
+		if (Result > 0)
+		{
+			++Ring.Statistics.ReadsCompleted;
+			push_pending(Device, Request.Data, Result);
+		}
+		else if (Result != -EAGAIN && Result != -EINTR && Result != -ECANCELED)
+		{
+			Device->bDisconnected = true;
+			return;
+		}
+		arm_read_locked(Ring, Device);
+		return;
+	}
+
+	if (Result >= 0)
+	{
+		++Ring.Statistics.WritesCompleted;
+		return;
+	}
+
+	++Ring.Statistics.WriteErrors;
+	if (linux_demote_audio_after_error(linux_device_state_registry::Get().Find(static_cast<linux_hidraw_handle*>(Device)).get(), Request.Length))
+	{
+		return;
+	}
+	if (linux_hidraw_device_info::should_treat_as_disconnected(-Result))
+	{
+		Device->bDisconnected = true;
+	}
+}
+
+static void reap_locked(uring_context& Ring)
+{
+	io_uring_cqe* Cqes[64];
+	while (true)
+	{
+		const unsigned Count = io_uring_peek_batch_cqe(&Ring.Ring, Cqes, 64);
+		if (Count == 0)
+		{
+			return;
+		}
+
+		for (unsigned i = 0; i < Count; ++i)
+		{
+			uring_request* Request = static_cast<uring_request*>(io_uring_cqe_get_data(Cqes[i]));
+			if (Request)
+			{
+				complete_locked(Ring, *Request, Cqes[i]->res);
+			}
+		}
+		io_uring_cq_advance(&Ring.Ring, Count);
+		Ring.Statistics.CqesReaped += Count;
+	}
+}
+
+// Output reports carry state, so a newer one may replace a queued one; audio packets are a stream and never do.
+// False when the report was dropped.
+static bool queue_write_locked(uring_context& Ring, uring_device* Device, const unsigned char* Data, std::int32_t Length, bool bCoalesce)
+{
+	reap_locked(Ring);
+
+	uring_request* Slot = nullptr;
+	for (uring_request& Candidate : Device->Writes)
+	{
+		if (bCoalesce && Candidate.bInFlight && Candidate.QueuedEpoch == Ring.Epoch && Candidate.Length == Length)
+		{
+			// Still in the SQ, so the kernel has not looked at the buffer yet: overwrite in place.
+			std::memcpy(Candidate.Data, Data, Length);
+			++Ring.Statistics.WritesCoalesced;
+			return true;
+		}
+		if (!Slot && !Candidate.bInFlight)
+		{
+			Slot = &Candidate;
+		}
+	}
+
+	if (!Slot)
+	{
+		++Ring.Statistics.WritesDropped;
+		return false;
+	}
+
+	Slot->Length = Length;
+	std::memcpy(Slot->Data, Data, Length);
+	return queue_request_locked(Ring, *Slot, true);
+}
+
+bool linux_uring_device_info::is_available()
+{
+	uring_context& Ring = get_context();
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Ring.Mutex);
+	return ensure_ring_locked(Ring);
+}
+
+linux_uring_statistics linux_uring_device_info::get_uring_statistics()
+{
+	uring_context& Ring = get_context();
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Ring.Mutex);
+	return Ring.Statistics;
+}
+
+int linux_uring_device_info::submit()
+{
+	uring_context& Ring = get_context();
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Ring.Mutex);
+	if (!Ring.bAvailable)
+	{
+		return 0;
+	}
+	return submit_locked(Ring);
+}
+
+void linux_uring_device_info::read(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	uring_device* Device = to_device(Context->Handle);
+	const linux_device_config& Config = linux_device_info::get_config();
+	linux_calibration_cache::Get().take_update(Context->Handle, Context->Calibration);
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	if (!State)
+	{
+		return;
+	}
+	unsigned char* Buffer = State->Reports.bLargeInput ? Context->BufferDS4 : Context->Buffer;
+	const bool bKeepAll = linux_begin_backlog(State.get(), Config);
+
+	bool bDisconnected = false;
+	std::uint32_t Delivered = 0;
+	{
+		uring_context& Ring = get_context();
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Ring.Mutex);
+		reap_locked(Ring);
+
+		const std::uint32_t Limit = (Config.ReadMode == EReadMode::Single) ? 1 : Config.MaxDrainPerTick;
+		while (Delivered < Limit)
+		{
+			if (Device->PendingCount == 0)
+			{
+				// The completed read was re-armed but still sits in the SQ, while the device may have
+				// queued more reports since. Submitting it now lets the kernel complete the next one
+				// inline instead of one report per device per read().
+				if (Device->bDisconnected || !has_queued_read_locked(Ring, Device) || submit_locked(Ring) <= 0)
+				{
+					break;
+				}
+				reap_locked(Ring);
+				if (Device->PendingCount == 0)
+				{
+					break;
+				}
+			}
+
+			const linux_input_report& Report = Device->Pending[Device->PendingHead];
+			std::memcpy(Buffer, Report.Data, Report.Length);
+			linux_track_report(State.get(), Report.Data, Report.Length, Report.HostTimeNs);
+			if (bKeepAll && State->Backlog.size() < State->Backlog.capacity())
+			{
+				linux_input_report& Kept = State->Backlog.emplace_back(Report);
+				Kept.DeviceSequence = State->Timing.DeviceSequence;
+				Kept.DeviceTimeUs = State->Timing.DeviceTimeUs;
+			}
+			Device->PendingHead = (Device->PendingHead + 1) % kPendingReports;
+			--Device->PendingCount;
+			++Delivered;
+		}
+		bDisconnected = Device->bDisconnected && Device->PendingCount == 0;
+	}
+
+	linux_record_reads(State.get(), Config, Delivered);
+	if (bDisconnected)
+	{
+		invalidate_handle(Context);
+		return;
+	}
+
+	flush_output(Context);
+}
+
+void linux_uring_device_info::write(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	if (!linux_defer_output(linux_device_state_registry::Get().Find(Context->Handle).get(), linux_device_info::get_config(), Context, &flush_output))
+	{
+		send_output(Context);
+	}
+}
+
+void linux_uring_device_info::flush_output(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	unsigned char Report[linux_device_state::kMaxOutputSize];
+	if (linux_claim_pending_output(State.get(), linux_device_info::get_config(), Context->ConnectionType == EDSDeviceConnection::Bluetooth, Report))
+	{
+		send_report(Context, State.get(), Report);
+	}
+}
+
+void linux_uring_device_info::send_output(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	send_report(Context, linux_device_state_registry::Get().Find(Context->Handle).get(), Context->GetRawOutputBuffer());
+}
+
+void linux_uring_device_info::send_report(FDeviceContext* Context, linux_device_state* State, const unsigned char* Report)
+{
+	if (!State)
+	{
+		return;
+	}
+	const linux_device_config& Config = linux_device_info::get_config();
+	const std::int32_t OutputReportLength = State->Reports.Output;
+	const bool bBluetooth = Context->ConnectionType == EDSDeviceConnection::Bluetooth;
+	if (!linux_should_send_output(State, Config, Report, OutputReportLength, bBluetooth))
+	{
+		return;
+	}
+
+	uring_context& Ring = get_context();
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Ring.Mutex);
+	if (queue_write_locked(Ring, to_device(Context->Handle), Report, OutputReportLength, true))
+	{
+		linux_record_output(State, Config, Report, OutputReportLength, bBluetooth);
+	}
+}
+
+void linux_uring_device_info::process_audio_haptic(FDeviceContext* Context)
+{
+	if (!Context || !Context->Handle)
+	{
+		return;
+	}
+
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Find(Context->Handle);
+	const std::uint16_t AudioReportLength = State ? linux_audio_report_size(State.get()) : 0;
+	if (AudioReportLength == 0)
+	{
+		return;
+	}
+
+	uring_context& Ring = get_context();
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Ring.Mutex);
+	queue_write_locked(Ring, to_device(Context->Handle), Context->BufferAudio, AudioReportLength, false);
+}
+
+// linux_device_opener worker. Blocking descriptor on purpose: io_uring honours O_NONBLOCK by
+// completing reads with -EAGAIN instead of waiting for the next report.
+static bool uring_open_prepared(const std::string& Path, linux_prepared_device& Out)
+{
+	const int Fd = open(Path.c_str(), O_RDWR | O_CLOEXEC);
+	if (Fd < 0)
+	{
+		return false;
+	}
+
+	linux_hidraw_handle* Device = new linux_hidraw_handle();
+	Device->Fd = Fd;
+	Out.Handle = Device;
+	Out.bCalibrated = linux_hidraw_device_info::resolve_calibration(Path, Out);
+	return true;
+}
+
+bool linux_uring_device_info::configure_features(FDeviceContext* Context)
+{
+	return linux_hidraw_device_info::configure_features(Context);
+}
+
+void linux_uring_device_info::detect(std::vector<FDeviceContext>& Devices)
+{
+	linux_hidraw_device_info::detect_with(Devices, &uring_open_prepared, &linux_hidraw_device_info::close_prepared);
+}
+
+bool linux_uring_device_info::detect_changes(std::vector<linux_detected_device>& Added, std::vector<linux_detected_device>& Removed)
+{
+	return linux_hidraw_device_info::detect_changes(Added, Removed);
+}
+
+bool linux_uring_device_info::create_handle(FDeviceContext* Context)
+{
+	if (!Context)
+	{
+		return false;
+	}
+
+	uring_context& Ring = get_context();
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Ring.Mutex);
+		if (!ensure_ring_locked(Ring))
+		{
+			return false;
+		}
+	}
+
+	const linux_device_config& Config = linux_device_info::get_config();
+	linux_prepared_device Prepared;
+	const bool bPrepared = Config.bAsyncOpen && linux_device_opener::Get().take(Context->Path, Prepared);
+	if (!bPrepared)
+	{
+		Prepared.DetectedAtNs = linux_hidraw_device_info::detected_at(Context->Path);
+		if (!uring_open_prepared(Context->Path, Prepared))
+		{
+			return false;
+		}
+		Prepared.ReadyAtNs = linux_monotonic_ns();
+	}
+
+	// Adopt the prepared descriptor; only the uring_device around it is created here.
+	linux_hidraw_handle* PreparedDevice = static_cast<linux_hidraw_handle*>(Prepared.Handle);
+	const int Fd = PreparedDevice->Fd;
+	delete PreparedDevice;
+
+	uring_device* Device = new uring_device();
+	Device->Fd = Fd;
+	Device->Read.Device = Device;
+	Device->Read.Kind = EUringRequest::Read;
+	for (uring_request& Slot : Device->Writes)
+	{
+		Slot.Device = Device;
+		Slot.Kind = EUringRequest::Write;
+	}
+	Context->Handle = static_cast<linux_hidraw_handle*>(Device);
+
+	const std::shared_ptr<linux_device_state> State = linux_device_state_registry::Get().Attach(Context->Handle, Context);
+	linux_settle_report_sizes(State.get(), Context);
+	Device->Read.Length = State->Reports.Input;
+
+	if (Prepared.bCalibrated)
+	{
+		Context->Calibration = Prepared.Calibration;
+		if (Prepared.bCalibrationCached)
+		{
+			// Feature reports are ioctls on the same descriptor, so the hidraw validation applies as is.
+			linux_calibration_cache::schedule_validation(Context->Handle, Prepared.Identity, &linux_hidraw_device_info::validate_calibration);
+		}
+	}
+	linux_record_open(State.get(), Prepared.DetectedAtNs, Prepared.ReadyAtNs);
+
+	gc_lock::lock_guard<gc_lock::mutex> Lock(Ring.Mutex);
+	if (Config.bInputReactor && Ring.EventFd < 0)
+	{
+		// Reads complete inside the kernel before epoll could see the hidraw node readable, so the
+		// reactor watches the ring's completion eventfd instead of the device descriptors.
+		Ring.EventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if (Ring.EventFd >= 0 && io_uring_register_eventfd(&Ring.Ring, Ring.EventFd) == 0)
+		{
+			linux_input_reactor::Get().watch_fd(&Ring, Ring.EventFd);
+		}
+	}
+	arm_read_locked(Ring, Device);
+	submit_locked(Ring);
+	return true;
+}
+
+void linux_uring_device_info::invalidate_handle(FDeviceContext* Context)
+{
+	if (Context)
+	{
+		uring_device* Device = Context->Handle ? to_device(Context->Handle) : nullptr;
+		if (Device != nullptr)
+		{
+			linux_device_state_registry::Get().Detach(Context->Handle);
+			// A calibration check may still be running on the writer thread against this descriptor.
+			linux_hid_writer::Get().retire(Context->Handle);
+			linux_calibration_cache::Get().forget(Context->Handle);
+			linux_device_opener::Get().release(Context->Path);
+
+			uring_context& Ring = get_context();
+			gc_lock::lock_guard<gc_lock::mutex> Lock(Ring.Mutex);
+			// Flush whatever is still queued, then cancel everything that reached the kernel.
+			Device->bClosing = true;
+			submit_locked(Ring);
+			reap_locked(Ring);
+			const auto Cancel = [&Ring](uring_request& Request) {
+				if (!Request.bInFlight)
+				{
+					return;
+				}
+				if (io_uring_sqe* Sqe = get_sqe_locked(Ring))
+				{
+					io_uring_prep_cancel(Sqe, &Request, 0);
+					io_uring_sqe_set_data(Sqe, nullptr);
+				}
+			};
+			Cancel(Device->Read);
+			for (uring_request& Slot : Device->Writes)
+			{
+				Cancel(Slot);
+			}
+			submit_locked(Ring);
+
+			const auto Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kCancelTimeoutMs);
+			while (Device->InFlight > 0 && std::chrono::steady_clock::now() < Deadline)
+			{
+				io_uring_cqe* Cqe = nullptr;
+				__kernel_timespec Timeout{0, 10 * 1000 * 1000};
+				io_uring_wait_cqe_timeout(&Ring.Ring, &Cqe, &Timeout);
+				reap_locked(Ring);
+			}
+
+			close(Device->Fd);
+			if (Device->InFlight == 0)
+			{
+				delete Device;
+			}
+			else
+			{
+				// The kernel still holds buffers of this device; the last completion frees it.
+				Device->bOrphaned = true;
+			}
+		}
+
+		Context->Handle = INVALID_PLATFORM_HANDLE;
+		Context->IsConnected = false;
+
+		Context->Path.clear();
+		std::memset(Context->Buffer, 0, sizeof(Context->Buffer));
+		std::memset(Context->BufferDS4, 0, sizeof(Context->BufferDS4));
+		std::memset(Context->BufferAudio, 0, sizeof(Context->BufferAudio));
+
+		unsigned char* RawOutput = Context->GetRawOutputBuffer();
+		std::memset(RawOutput, 0, 78);
+	}
+}
+
+std::string linux_uring_device_info::get_container_id(const std::string& DevicePath)
+{
+	return linux_device_info::get_container_id(DevicePath);
+}
+
+std::string linux_uring_device_info::get_audio_container_id(const std::string& AudioDeviceId)
+{
+	return linux_device_info::get_audio_container_id(AudioDeviceId);
+}
+#endif
+#endif
@@ -0,0 +1,62 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "linux_device_state.h"
+#include "linux_hidraw_device_info.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct linux_uring_statistics
+{
+	// io_uring_enter() calls made by submit(); reaping completions never enters the kernel.
+	std::uint64_t Submits = 0;
+	std::uint64_t SqesSubmitted = 0;
+	std::uint64_t CqesReaped = 0;
+	std::uint64_t ReadsCompleted = 0;
+	std::uint64_t WritesCompleted = 0;
+	// Writes of the same device queued in one tick that replaced a not yet submitted one.
+	std::uint64_t WritesCoalesced = 0;
+	// Writes rejected because every write slot of the device was still in flight.
+	std::uint64_t WritesDropped = 0;
+	std::uint64_t WriteErrors = 0;
+};
+
+/**
+ * @brief hidraw backend that moves every report through a single shared io_uring.
+ *
+ * Each device keeps a few reads permanently posted on its hidraw node; read() reaps the
+ * completion queue (shared memory, no syscall) and re-queues the reads. When that runs dry
+ * before the read mode is satisfied, read() submits the re-armed reads itself so reports that
+ * queued up in the kernel since the last tick are not held back until the next one. write()
+ * and process_audio_haptic() copy the report into a per-device slot and queue it; those only
+ * reach the kernel at submit() (or with an early read() submit), which flushes everything
+ * queued with one io_uring_enter(), so call it once per tick after the outputs are updated.
+ *
+ * Enumeration and calibration are shared with linux_hidraw_device_info.
+ */
+class linux_uring_device_info
+{
+public:
+	virtual ~linux_uring_device_info() = default;
+	static void process_audio_haptic(FDeviceContext* Context);
+	static bool configure_features(FDeviceContext* Context);
+	static void read(FDeviceContext* Context);
+	static void write(FDeviceContext* Context);
+	static void send_output(FDeviceContext* Context);
+	static void send_report(FDeviceContext* Context, linux_device_state* State, const unsigned char* Report);
+	static void flush_output(FDeviceContext* Context);
+	static void detect(std::vector<FDeviceContext>& Devices);
+	static bool detect_changes(std::vector<linux_detected_device>& Added, std::vector<linux_detected_device>& Removed);
+	static bool create_handle(FDeviceContext* Context);
+	static void invalidate_handle(FDeviceContext* Context);
+	static std::string get_container_id(const std::string& DevicePath);
+	static std::string get_audio_container_id(const std::string& AudioDeviceId);
+	// Hands every queued read and write to the kernel in one io_uring_enter(). Returns the SQE count.
+	static int submit();
+	static bool is_available();
+	static linux_uring_statistics get_uring_statistics();
+};
+#endif
@@ -0,0 +1,578 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#include "virtual_device_info.h"
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "GCore/Types/Structs/Config/GamepadCalibration.h"
+#include "GCore/Utils/SoDefines.h"
+#include "GImplementations/Utils/GamepadSensors.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace virtual_platform
+{
+	static std::uint32_t crc32_update(std::uint32_t Crc, const unsigned char* Data, std::size_t Length)
+	{
+		for (std::size_t i = 0; i < Length; ++i)
+		{
+			Crc ^= Data[i];
+			for (int Bit = 0; Bit < 8; ++Bit)
+			{
+				Crc = (Crc >> 1) ^ (0xEDB88320u & (0u - (Crc & 1u)));
+			}
+		}
+		return Crc;
+	}
+
+	static void write_le16(unsigned char* Dst, std::uint16_t Value)
+	{
+		Dst[0] = static_cast<unsigned char>(Value & 0xFF);
+		Dst[1] = static_cast<unsigned char>((Value >> 8) & 0xFF);
+	}
+
+	static void write_le32(unsigned char* Dst, std::uint32_t Value)
+	{
+		write_le16(Dst, static_cast<std::uint16_t>(Value & 0xFFFF));
+		write_le16(Dst + 2, static_cast<std::uint16_t>(Value >> 16));
+	}
+
+	virtual_hid_bus& virtual_hid_bus::Get()
+	{
+		static virtual_hid_bus Instance;
+		return Instance;
+	}
+
+	virtual_hid_bus::virtual_hid_bus()
+	{
+		const char* Env = std::getenv("GAMEPAD_CORE_VIRTUAL_HID");
+		if (!Env || !*Env)
+		{
+			plug(virtual_device_script{});
+			return;
+		}
+
+		std::stringstream Stream(Env);
+		std::string Entry;
+		while (std::getline(Stream, Entry, ','))
+		{
+			virtual_device_script Script;
+			if (parse_script(Entry, Script))
+			{
+				plug(Script);
+			}
+		}
+	}
+
+	bool virtual_hid_bus::parse_script(const std::string& Spec, virtual_device_script& OutScript)
+	{
+		std::stringstream Stream(Spec);
+		std::string Token;
+		std::size_t Position = 0;
+		while (std::getline(Stream, Token, ':'))
+		{
+			if (Position == 0)
+			{
+				if (Token == "dualsense")
+				{
+					OutScript.DeviceType = EDSDeviceType::DualSense;
+				}
+				else if (Token == "edge")
+				{
+					OutScript.DeviceType = EDSDeviceType::DualSenseEdge;
+				}
+				else if (Token == "ds4")
+				{
+					OutScript.DeviceType = EDSDeviceType::DualShock4;
+				}
+				else
+				{
+					return false;
+				}
+			}
+			else if (Position == 1)
+			{
+				if (Token == "usb")
+				{
+					OutScript.ConnectionType = EDSDeviceConnection::Usb;
+				}
+				else if (Token == "bt")
+				{
+					OutScript.ConnectionType = EDSDeviceConnection::Bluetooth;
+				}
+				else
+				{
+					return false;
+				}
+			}
+			else
+			{
+				const std::size_t Separator = Token.find('=');
+				if (Separator == std::string::npos)
+				{
+					return false;
+				}
+
+				const std::string Key = Token.substr(0, Separator);
+				const double Value = std::strtod(Token.c_str() + Separator + 1, nullptr);
+				if (Key == "rate" && Value > 0.0)
+				{
+					OutScript.ReportRateHz = static_cast<std::uint32_t>(Value);
+				}
+				else if (Key == "latency")
+				{
+					OutScript.LinkLatency = std::chrono::microseconds(static_cast<std::int64_t>(Value * 1000.0));
+				}
+				else if (Key == "connect")
+				{
+					OutScript.ConnectAfter = std::chrono::milliseconds(static_cast<std::int64_t>(Value));
+				}
+				else if (Key == "disconnect")
+				{
+					OutScript.DisconnectAfter = std::chrono::milliseconds(static_cast<std::int64_t>(Value));
+				}
+				else if (Key == "reconnect")
+				{
+					OutScript.ReconnectAfter = std::chrono::milliseconds(static_cast<std::int64_t>(Value));
+				}
+				else
+				{
+					return false;
+				}
+			}
+			++Position;
+		}
+		return Position >= 2;
+	}
+
+	std::uint32_t virtual_hid_bus::plug(const virtual_device_script& Script)
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		auto Device = std::make_unique<virtual_device>();
+		Device->Index = static_cast<std::uint32_t>(Devices.size());
+		Device->Path = "virtual://hid/" + std::to_string(Device->Index);
+		Device->Script = Script;
+		if (Device->Script.ReportRateHz == 0)
+		{
+			Device->Script.ReportRateHz = 1;
+		}
+		Device->PluggedAt = std::chrono::steady_clock::now() + Script.ConnectAfter;
+		Devices.push_back(std::move(Device));
+		return Devices.back()->Index;
+	}
+
+	void virtual_hid_bus::unplug(std::uint32_t Index)
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		if (Index < Devices.size())
+		{
+			Devices[Index]->bUnplugged = true;
+		}
+	}
+
+	void virtual_hid_bus::clear()
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		for (auto& Device : Devices)
+		{
+			Device->bUnplugged = true;
+		}
+	}
+
+	std::size_t virtual_hid_bus::size()
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		return Devices.size();
+	}
+
+	virtual_device_statistics virtual_hid_bus::statistics(std::uint32_t Index)
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		virtual_device_statistics Stats;
+		if (Index >= Devices.size())
+		{
+			return Stats;
+		}
+
+		const virtual_device& Device = *Devices[Index];
+		Stats.Opens = Device.Opens.load();
+		Stats.Disconnects = Device.Disconnects.load();
+		Stats.ReportsRead = Device.ReportsRead.load();
+		Stats.ReportsDropped = Device.ReportsDropped.load();
+		Stats.EmptyReads = Device.EmptyReads.load();
+		Stats.OutputWrites = Device.OutputWrites.load();
+		Stats.OutputBytes = Device.OutputBytes.load();
+		Stats.AudioWrites = Device.AudioWrites.load();
+		Stats.AudioBytes = Device.AudioBytes.load();
+		return Stats;
+	}
+
+	std::vector<unsigned char> virtual_hid_bus::last_output(std::uint32_t Index)
+	{
+		virtual_device* Device = nullptr;
+		{
+			gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+			if (Index >= Devices.size())
+			{
+				return {};
+			}
+			Device = Devices[Index].get();
+		}
+
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Device->OutputMutex);
+		return Device->LastOutput;
+	}
+
+	virtual_device* virtual_hid_bus::find(const std::string& Path)
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		for (auto& Device : Devices)
+		{
+			if (Device->Path == Path && !Device->bUnplugged)
+			{
+				return Device.get();
+			}
+		}
+		return nullptr;
+	}
+
+	void virtual_hid_bus::enumerate(std::vector<virtual_device*>& OutDevices)
+	{
+		gc_lock::lock_guard<gc_lock::mutex> Lock(Mutex);
+		const auto Now = std::chrono::steady_clock::now();
+		for (auto& Device : Devices)
+		{
+			if (!Device->bUnplugged && Now >= Device->PluggedAt)
+			{
+				OutDevices.push_back(Device.get());
+			}
+		}
+	}
+
+	std::size_t virtual_device_info::input_report_length(EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType)
+	{
+		(void)DeviceType;
+		return (ConnectionType == EDSDeviceConnection::Bluetooth) ? 78 : 64;
+	}
+
+	std::uint32_t virtual_device_info::report_crc32(unsigned char Seed, const unsigned char* Data, std::size_t Length)
+	{
+		std::uint32_t Crc = crc32_update(0xFFFFFFFFu, &Seed, 1);
+		return ~crc32_update(Crc, Data, Length);
+	}
+
+	void virtual_device_info::write_report_crc32(unsigned char Seed, unsigned char* Report, std::size_t Length)
+	{
+		write_le32(Report + Length - 4, report_crc32(Seed, Report, Length - 4));
+	}
+
+	void virtual_device_info::synthesize_report(const virtual_device_script& Script, std::uint64_t Sequence, std::uint64_t TimestampUs, unsigned char* Buffer, std::size_t Length)
+	{
+		const std::size_t ReportLength = input_report_length(Script.DeviceType, Script.ConnectionType);
+		if (Length < ReportLength)
+		{
+			return;
+		}
+		std::memset(Buffer, 0, ReportLength);
+
+		const bool bBluetooth = Script.ConnectionType == EDSDeviceConnection::Bluetooth;
+		if (Script.DeviceType == EDSDeviceType::DualShock4)
+		{
+			// USB 0x01 carries the common block right after the report ID, BT 0x11 after two extra header bytes.
+			Buffer[0] = bBluetooth ? 0x11 : 0x01;
+			if (bBluetooth)
+			{
+				Buffer[1] = 0xC0;
+			}
+			unsigned char* Common = Buffer + (bBluetooth ? 3 : 1);
+			Common[0] = Common[1] = Common[2] = Common[3] = 0x80;
+			Common[4] = 0x08;
+			Common[6] = static_cast<unsigned char>((Sequence & 0x3F) << 2);
+			// Sensor timestamp ticks are 16/3 us.
+			write_le16(Common + 9, static_cast<std::uint16_t>((TimestampUs * 3) / 16));
+		}
+		else
+		{
+			Buffer[0] = bBluetooth ? 0x31 : 0x01;
+			unsigned char* Common = Buffer + (bBluetooth ? 2 : 1);
+			Common[0] = Common[1] = Common[2] = Common[3] = 0x80;
+			Common[6] = static_cast<unsigned char>(Sequence & 0xFF);
+			Common[7] = 0x08;
+			// Sensor timestamp ticks are 1/3 us.
+			write_le32(Common + 27, static_cast<std::uint32_t>(TimestampUs * 3));
+		}
+
+		if (bBluetooth)
+		{
+			write_report_crc32(0xA1, Buffer, ReportLength);
+		}
+	}
+
+	EVirtualPollResult virtual_device_info::poll_tick(FPlatformDeviceHandle Handle, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead)
+	{
+		OutBytesRead = 0;
+		virtual_device* Device = static_cast<virtual_device*>(Handle);
+		if (Handle == INVALID_PLATFORM_HANDLE || !Device->bOpen.load(std::memory_order_acquire))
+		{
+			return EVirtualPollResult::Disconnected;
+		}
+
+		// The script never changes after plug(); the open/plug bookkeeping is shared with
+		// create_handle() and detect() on other threads and only touched under the bus lock.
+		const virtual_device_script& Script = Device->Script;
+		const auto Now = std::chrono::steady_clock::now();
+		std::uint64_t Sequence = 0;
+		{
+			gc_lock::lock_guard<gc_lock::mutex> Lock(virtual_hid_bus::Get().Mutex);
+			if (!Device->bOpen.load(std::memory_order_relaxed))
+			{
+				return EVirtualPollResult::Disconnected;
+			}
+			const auto SinceOpen = Now - Device->OpenedAt;
+
+			if (Script.DisconnectAfter.count() > 0 && SinceOpen >= Script.DisconnectAfter)
+			{
+				Device->bOpen.store(false, std::memory_order_release);
+				Device->Disconnects.fetch_add(1, std::memory_order_relaxed);
+				if (Script.ReconnectAfter.count() > 0)
+				{
+					Device->PluggedAt = Now + Script.ReconnectAfter;
+				}
+				else
+				{
+					Device->bUnplugged = true;
+				}
+				return EVirtualPollResult::Disconnected;
+			}
+
+			const auto Visible = std::chrono::duration_cast<std::chrono::microseconds>(SinceOpen) - Script.LinkLatency;
+			if (Visible.count() < 0)
+			{
+				Device->EmptyReads.fetch_add(1, std::memory_order_relaxed);
+				return EVirtualPollResult::NoIoThisTick;
+			}
+
+			// Report N leaves the device N / rate after open and lands on the host LinkLatency later.
+			const std::uint64_t Arrived = static_cast<std::uint64_t>(Visible.count()) * Script.ReportRateHz / 1000000 + 1;
+			if (Arrived > Device->NextArrival)
+			{
+				// Nothing was read since the last call, so the reports landed in between fill the
+				// free slots in order and, as in hidraw, the newest ones are dropped once it is full.
+				const std::uint64_t Landed = Arrived - Device->NextArrival;
+				const std::uint64_t Accepted = std::min<std::uint64_t>(Landed, virtual_device::kHostQueueDepth - Device->QueueCount);
+				for (std::uint64_t i = 0; i < Accepted; ++i)
+				{
+					Device->HostQueue[(Device->QueueHead + Device->QueueCount++) % virtual_device::kHostQueueDepth] = Device->NextArrival + i;
+				}
+				Device->ReportsDropped.fetch_add(Landed - Accepted, std::memory_order_relaxed);
+				Device->NextArrival = Arrived;
+			}
+
+			if (Device->QueueCount == 0)
+			{
+				Device->EmptyReads.fetch_add(1, std::memory_order_relaxed);
+				return EVirtualPollResult::NoIoThisTick;
+			}
+
+			Sequence = Device->HostQueue[Device->QueueHead];
+			Device->QueueHead = (Device->QueueHead + 1) % virtual_device::kHostQueueDepth;
+			--Device->QueueCount;
+		}
+		if (!Script.Reports.empty())
+		{
+			const std::vector<unsigned char>& Report = Script.Reports[Sequence % Script.Reports.size()];
+			const std::size_t Copied = std::min(Report.size(), static_cast<std::size_t>(Length));
+			std::memcpy(Buffer, Report.data(), Copied);
+			OutBytesRead = static_cast<std::int32_t>(Copied);
+		}
+		else
+		{
+			const std::uint64_t TimestampUs = Sequence * 1000000 / Script.ReportRateHz;
+			synthesize_report(Script, Sequence, TimestampUs, Buffer, static_cast<std::size_t>(Length));
+			OutBytesRead = static_cast<std::int32_t>(input_report_length(Script.DeviceType, Script.ConnectionType));
+		}
+
+		Device->ReportsRead.fetch_add(1, std::memory_order_relaxed);
+		return EVirtualPollResult::ReadOk;
+	}
+
+	void virtual_device_info::read(FDeviceContext* Context)
+	{
+		if (!Context || !Context->Handle)
+		{
+			return;
+		}
+
+		std::int32_t BytesRead = 0;
+		if (Context->ConnectionType == EDSDeviceConnection::Bluetooth && Context->DeviceType == EDSDeviceType::DualShock4)
+		{
+			if (poll_tick(Context->Handle, Context->BufferDS4, (std::int32_t)sizeof(Context->BufferDS4), BytesRead) == EVirtualPollResult::Disconnected)
+			{
+				invalidate_handle(Context);
+			}
+			return;
+		}
+
+		const size_t InputReportLength = input_report_length(Context->DeviceType, Context->ConnectionType);
+		if (poll_tick(Context->Handle, Context->Buffer, (std::int32_t)InputReportLength, BytesRead) == EVirtualPollResult::Disconnected)
+		{
+			invalidate_handle(Context);
+		}
+	}
+
+	void virtual_device_info::write(FDeviceContext* Context)
+	{
+		if (!Context || !Context->Handle)
+		{
+			return;
+		}
+
+		virtual_device* Device = static_cast<virtual_device*>(Context->Handle);
+		if (!Device->bOpen.load(std::memory_order_acquire))
+		{
+			invalidate_handle(Context);
+			return;
+		}
+
+		const size_t InReportLength = (Context->DeviceType == EDSDeviceType::DualShock4) ? 32 : 74;
+		const size_t OutputReportLength = (Context->ConnectionType == EDSDeviceConnection::Bluetooth) ? 78 : InReportLength;
+
+		const unsigned char* RawOutput = Context->GetRawOutputBuffer();
+		{
+			gc_lock::lock_guard<gc_lock::mutex> Lock(Device->OutputMutex);
+			Device->LastOutput.assign(RawOutput, RawOutput + OutputReportLength);
+		}
+		Device->OutputWrites.fetch_add(1, std::memory_order_relaxed);
+		Device->OutputBytes.fetch_add(OutputReportLength, std::memory_order_relaxed);
+	}
+
+	void virtual_device_info::process_audio_haptic(FDeviceContext* Context)
+	{
+		if (!Context || !Context->Handle || Context->ConnectionType != EDSDeviceConnection::Bluetooth)
+		{
+			return;
+		}
+
+		virtual_device* Device = static_cast<virtual_device*>(Context->Handle);
+		if (!Device->bOpen.load(std::memory_order_acquire))
+		{
+			return;
+		}
+
+		constexpr size_t ReportSize = 147;
+		Device->AudioWrites.fetch_add(1, std::memory_order_relaxed);
+		Device->AudioBytes.fetch_add(std::min(ReportSize, sizeof(Context->BufferAudio)), std::memory_order_relaxed);
+	}
+
+	void virtual_device_info::synthesize_calibration(EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType, unsigned char* FeatureBuffer)
+	{
+		const std::int16_t GyroRange = 8192;
+		const std::int16_t SpeedRange = 540;
+		const std::int16_t AccelRange = 8192;
+
+		// DS4 over USB groups the three gyro "plus" values before the "minus" ones, every other layout interleaves them.
+		const bool bGrouped = DeviceType == EDSDeviceType::DualShock4 && ConnectionType == EDSDeviceConnection::Usb;
+		std::memset(FeatureBuffer + 1, 0, 34);
+		for (int Axis = 0; Axis < 3; ++Axis)
+		{
+			const int PlusOffset = bGrouped ? 7 + Axis * 2 : 7 + Axis * 4;
+			const int MinusOffset = bGrouped ? 13 + Axis * 2 : 9 + Axis * 4;
+			write_le16(FeatureBuffer + PlusOffset, static_cast<std::uint16_t>(GyroRange));
+			write_le16(FeatureBuffer + MinusOffset, static_cast<std::uint16_t>(-GyroRange));
+			write_le16(FeatureBuffer + 23 + Axis * 4, static_cast<std::uint16_t>(AccelRange));
+			write_le16(FeatureBuffer + 25 + Axis * 4, static_cast<std::uint16_t>(-AccelRange));
+		}
+		write_le16(FeatureBuffer + 19, static_cast<std::uint16_t>(SpeedRange));
+		write_le16(FeatureBuffer + 21, static_cast<std::uint16_t>(SpeedRange));
+	}
+
+	bool virtual_device_info::configure_features(FDeviceContext* Context)
+	{
+		unsigned char FeatureBuffer[41] = {0};
+		FeatureBuffer[0] = 0x05;
+		synthesize_calibration(EDSDeviceType::DualSense, Context->ConnectionType, FeatureBuffer);
+
+		using namespace FGamepadSensors;
+		FGamepadCalibration Calibration;
+		DualSenseCalibrationSensors(FeatureBuffer, Calibration);
+
+		Context->Calibration = Calibration;
+		return true;
+	}
+
+	void virtual_device_info::detect(std::vector<FDeviceContext>& Devices)
+	{
+		Devices.clear();
+
+		std::vector<virtual_device*> Present;
+		virtual_hid_bus::Get().enumerate(Present);
+
+		for (virtual_device* Device : Present)
+		{
+			FDeviceContext NewDeviceContext;
+			NewDeviceContext.Path = Device->Path;
+			NewDeviceContext.DeviceType = Device->Script.DeviceType;
+			NewDeviceContext.ConnectionType = Device->Script.ConnectionType;
+			NewDeviceContext.IsConnected = true;
+			NewDeviceContext.Handle = nullptr;
+			Devices.push_back(NewDeviceContext);
+		}
+	}
+
+	bool virtual_device_info::create_handle(FDeviceContext* Context)
+	{
+		if (!Context)
+		{
+			return false;
+		}
+
+		virtual_hid_bus& Bus = virtual_hid_bus::Get();
+		virtual_device* Device = Bus.find(Context->Path);
+		if (!Device)
+		{
+			return false;
+		}
+
+		{
+			gc_lock::lock_guard<gc_lock::mutex> Lock(Bus.Mutex);
+			if (std::chrono::steady_clock::now() < Device->PluggedAt)
+			{
+				return false;
+			}
+			Device->bOpen.store(true, std::memory_order_release);
+			Device->OpenedAt = std::chrono::steady_clock::now();
+			Device->NextArrival = 0;
+			Device->QueueHead = 0;
+			Device->QueueCount = 0;
+		}
+		Device->Opens.fetch_add(1, std::memory_order_relaxed);
+
+		Context->Handle = Device;
+		configure_features(Context);
+		return true;
+	}
+
+	void virtual_device_info::invalidate_handle(FDeviceContext* Context)
+	{
+		if (Context)
+		{
+			virtual_device* Device = static_cast<virtual_device*>(Context->Handle);
+			if (Device != nullptr)
+			{
+				gc_lock::lock_guard<gc_lock::mutex> Lock(virtual_hid_bus::Get().Mutex);
+				Device->bOpen.store(false, std::memory_order_release);
+			}
+
+			Context->Handle = INVALID_PLATFORM_HANDLE;
+			Context->IsConnected = false;
+
+			Context->Path.clear();
+			std::memset(Context->Buffer, 0, sizeof(Context->Buffer));
+			std::memset(Context->BufferDS4, 0, sizeof(Context->BufferDS4));
+			std::memset(Context->BufferAudio, 0, sizeof(Context->BufferAudio));
+
+			unsigned char* RawOutput = Context->GetRawOutputBuffer();
+			std::memset(RawOutput, 0, 78);
+		}
+	}
+} // namespace virtual_platform
+#endif
@@ -0,0 +1,155 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+
+#include "GCore/Types/ECoreGamepad.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "GCore/Utils/SoDefines.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace virtual_platform
+{
+	enum class EVirtualPollResult
+	{
+		ReadOk,
+		NoIoThisTick,
+		Disconnected
+	};
+
+	/**
+	 * @brief Describes one scripted controller on the in-memory bus.
+	 *
+	 * Reports are produced at ReportRateHz from the moment the handle is opened and become
+	 * readable LinkLatency later. When Reports is empty an idle report (centered sticks,
+	 * neutral d-pad, running counter and sensor timestamp) is synthesized for the device type,
+	 * otherwise the scripted reports are replayed in a loop.
+	 */
+	struct virtual_device_script
+	{
+		EDSDeviceType DeviceType = EDSDeviceType::DualSense;
+		EDSDeviceConnection ConnectionType = EDSDeviceConnection::Usb;
+		std::uint32_t ReportRateHz = 250;
+		std::chrono::microseconds LinkLatency{0};
+		// Time after the bus starts before the device shows up in detect().
+		std::chrono::milliseconds ConnectAfter{0};
+		// Time after open before the link drops; zero keeps the device connected forever.
+		std::chrono::milliseconds DisconnectAfter{0};
+		// Time after a drop before the device is enumerable again; zero keeps it unplugged.
+		std::chrono::milliseconds ReconnectAfter{0};
+		std::vector<std::vector<unsigned char>> Reports;
+	};
+
+	struct virtual_device_statistics
+	{
+		std::uint64_t Opens = 0;
+		std::uint64_t Disconnects = 0;
+		std::uint64_t ReportsRead = 0;
+		std::uint64_t ReportsDropped = 0;
+		std::uint64_t EmptyReads = 0;
+		std::uint64_t OutputWrites = 0;
+		std::uint64_t OutputBytes = 0;
+		std::uint64_t AudioWrites = 0;
+		std::uint64_t AudioBytes = 0;
+	};
+
+	struct virtual_device
+	{
+		std::uint32_t Index = 0;
+		std::string Path;
+		virtual_device_script Script;
+
+		// Written under virtual_hid_bus::Mutex. bOpen is also checked without it by the write and
+		// audio paths, which may run on other threads; everything else is only read under the lock.
+		bool bUnplugged = false;
+		std::atomic<bool> bOpen{false};
+		std::chrono::steady_clock::time_point PluggedAt;
+		std::chrono::steady_clock::time_point OpenedAt;
+		// Sequence of the next report to land on the host.
+		std::uint64_t NextArrival = 0;
+		// Reports landed but not read yet, oldest first. Like hidraw's per-reader list it holds
+		// kHostQueueDepth reports; reports landing while it is full are lost.
+		static constexpr std::uint32_t kHostQueueDepth = 64;
+		std::uint64_t HostQueue[kHostQueueDepth] = {};
+		std::uint32_t QueueHead = 0;
+		std::uint32_t QueueCount = 0;
+
+		std::atomic<std::uint64_t> Opens{0};
+		std::atomic<std::uint64_t> Disconnects{0};
+		std::atomic<std::uint64_t> ReportsRead{0};
+		std::atomic<std::uint64_t> ReportsDropped{0};
+		std::atomic<std::uint64_t> EmptyReads{0};
+		std::atomic<std::uint64_t> OutputWrites{0};
+		std::atomic<std::uint64_t> OutputBytes{0};
+		std::atomic<std::uint64_t> AudioWrites{0};
+		std::atomic<std::uint64_t> AudioBytes{0};
+
+		gc_lock::mutex OutputMutex;
+		std::vector<unsigned char> LastOutput;
+	};
+
+	/**
+	 * @brief Process-wide in-memory HID bus backing virtual_device_info.
+	 *
+	 * On first use the bus is populated from the GAMEPAD_CORE_VIRTUAL_HID environment variable,
+	 * a comma separated list of "<type>:<connection>[:key=value...]" entries, e.g.
+	 * "dualsense:bt:rate=250:latency=4,ds4:usb:rate=1000:disconnect=5000:reconnect=1000".
+	 * Types are dualsense, edge and ds4; connections are usb and bt; durations are milliseconds
+	 * except latency, which accepts fractional milliseconds. Without the variable a single
+	 * DualSense on USB at 250 Hz is plugged.
+	 */
+	class virtual_hid_bus
+	{
+	public:
+		static virtual_hid_bus& Get();
+
+		std::uint32_t plug(const virtual_device_script& Script);
+		void unplug(std::uint32_t Index);
+		void clear();
+		std::size_t size();
+
+		virtual_device_statistics statistics(std::uint32_t Index);
+		std::vector<unsigned char> last_output(std::uint32_t Index);
+
+		static bool parse_script(const std::string& Spec, virtual_device_script& OutScript);
+
+	private:
+		virtual_hid_bus();
+
+		friend class virtual_device_info;
+		virtual_device* find(const std::string& Path);
+		void enumerate(std::vector<virtual_device*>& OutDevices);
+
+		gc_lock::mutex Mutex;
+		// Devices are never erased so that open handles stay valid after an unplug.
+		std::vector<std::unique_ptr<virtual_device>> Devices;
+	};
+
+	class virtual_device_info
+	{
+	public:
+		virtual ~virtual_device_info() = default;
+		static void process_audio_haptic(FDeviceContext* Context);
+		static bool configure_features(FDeviceContext* Context);
+		static void read(FDeviceContext* Context);
+		static void write(FDeviceContext* Context);
+		static void detect(std::vector<FDeviceContext>& Devices);
+		static bool create_handle(FDeviceContext* Context);
+		static void invalidate_handle(FDeviceContext* Context);
+		static EVirtualPollResult poll_tick(FPlatformDeviceHandle Handle, unsigned char* Buffer, std::int32_t Length, std::int32_t& OutBytesRead);
+
+		static std::size_t input_report_length(EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType);
+		// CRC32 used by Bluetooth reports: seeded with the HID transaction byte (0xA1 input, 0xA2 output, 0xA3 feature).
+		static std::uint32_t report_crc32(unsigned char Seed, const unsigned char* Data, std::size_t Length);
+		// Stores report_crc32 of the first Length - 4 bytes little-endian in the last four bytes of the report.
+		static void write_report_crc32(unsigned char Seed, unsigned char* Report, std::size_t Length);
+		static void synthesize_report(const virtual_device_script& Script, std::uint64_t Sequence, std::uint64_t TimestampUs, unsigned char* Buffer, std::size_t Length);
+		// Fills bytes 1..34 of a calibration feature report (0x05, or 0x02 for DS4 on USB) with zero bias and nominal ranges.
+		static void synthesize_calibration(EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType, unsigned char* FeatureBuffer);
+	};
+} // namespace virtual_platform
+#endif
@@ -0,0 +1,69 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+#pragma once
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "GCore/Templates/TGenericHardwareInfo.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "virtual_device_info.h"
+#include <memory>
+#include <vector>
+
+namespace virtual_platform
+{
+	struct virtual_hardware_policy;
+	using virtual_hardware = GamepadCore::TGenericHardwareInfo<virtual_hardware_policy>;
+
+	/**
+	 * @brief Hardware policy backed by the in-memory virtual_hid_bus.
+	 *
+	 * Lets the integration executables and benchmarks exercise every path behind
+	 * TGenericHardwareInfo on machines without controllers attached.
+	 */
+	struct virtual_hardware_policy
+	{
+		virtual_hardware_policy() = default;
+
+		static void Read(FDeviceContext* Context)
+		{
+			virtual_device_info::read(Context);
+		}
+
+		static void Write(FDeviceContext* Context)
+		{
+			virtual_device_info::write(Context);
+		}
+
+		static void Detect(std::vector<FDeviceContext>& Devices)
+		{
+			virtual_device_info::detect(Devices);
+		}
+
+		static bool CreateHandle(FDeviceContext* Context)
+		{
+			return virtual_device_info::create_handle(Context);
+		}
+
+		static void InvalidateHandle(FDeviceContext* Context)
+		{
+			virtual_device_info::invalidate_handle(Context);
+		}
+
+		static void ProcessAudioHaptic(FDeviceContext* Context)
+		{
+			virtual_device_info::process_audio_haptic(Context);
+		}
+
+		static void InitializeAudioDevice(FDeviceContext* Context)
+		{
+#if GAMEPAD_CORE_HAS_AUDIO
+			if (!Context)
+			{
+				return;
+			}
+
+			// There is no playback endpoint behind a virtual controller; USB haptics stay disabled.
+			Context->AudioContext = std::make_shared<FAudioDeviceContext>();
+#endif
+		}
+	};
+} // namespace virtual_platform
+#endif
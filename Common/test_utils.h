@@ -4,15 +4,22 @@
 
 #include "GCore/Interfaces/IPlatformHardwareInfo.h"
 #include "GCore/Templates/TBasicDeviceRegistry.h"
+#include <chrono>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
-#ifdef _WIN32
+#if defined(GAMEPAD_CORE_VIRTUAL_HID)
+#include "Platform/virtual/virtual_hardware_policy.h"
+using platform_hardware = virtual_platform::virtual_hardware;
+#elif defined(_WIN32)
 #include "Platform/windows/windows_hardware_policy.h"
 using platform_hardware = windows_platform::windows_hardware;
 #else
 #include "Platform/linux/linux_hardware_policy.h"
+#include "Platform/linux/linux_input_reactor.h"
 using platform_hardware = linux_platform::linux_hardware;
 #endif
 
@@ -69,6 +76,155 @@ namespace test_utils
 
 		std::cout << "[test_utils] Environment initialized." << std::endl;
 	}
+
+	/**
+	 * @brief Check harness of the hardware-free tests: every check is printed, failures are counted.
+	 */
+	inline int& failure_count()
+	{
+		static int Failures = 0;
+		return Failures;
+	}
+
+	inline void expect(bool bCondition, const std::string& What)
+	{
+		std::cout << (bCondition ? "[ OK ] " : "[FAIL] ") << What << std::endl;
+		failure_count() += bCondition ? 0 : 1;
+	}
+
+	/** @brief Prints the summary line and returns the process exit code. */
+	inline int finish_checks()
+	{
+		std::cout << (failure_count() == 0 ? "All checks passed" : "Some checks failed") << std::endl;
+		return failure_count() == 0 ? 0 : 1;
+	}
+
+	/**
+	 * @brief Makes devices opened from now on wake wait_for_input() when they deliver a report.
+	 * @return false when the platform has no input reactor and wait_for_input() just sleeps.
+	 */
+	inline bool enable_input_reactor()
+	{
+#if defined(__linux__) && !defined(GAMEPAD_CORE_VIRTUAL_HID)
+		linux_device_config Config = linux_device_info::get_config();
+		Config.bInputReactor = true;
+		linux_device_info::configure(Config);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * @brief Moves every HID output and audio write to the dedicated writer thread.
+	 * @return false when the platform writes synchronously regardless.
+	 */
+	inline bool enable_async_writer()
+	{
+#if defined(__linux__) && !defined(GAMEPAD_CORE_VIRTUAL_HID)
+		linux_device_config Config = linux_device_info::get_config();
+		Config.bAsyncWriter = true;
+		linux_device_info::configure(Config);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * @brief Merges the output changes of a tick into one report sent at end_tick().
+	 * @return false when the platform sends every write as is.
+	 */
+	inline bool enable_output_coalescing()
+	{
+#if defined(__linux__) && !defined(GAMEPAD_CORE_VIRTUAL_HID)
+		linux_device_config Config = linux_device_info::get_config();
+		Config.bCoalesceOutput = true;
+		linux_device_info::configure(Config);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * @brief Reuses the calibration of controllers seen before instead of reading it on every connect.
+	 * @return false when the platform has no calibration cache.
+	 */
+	inline bool enable_calibration_cache()
+	{
+#if defined(__linux__) && !defined(GAMEPAD_CORE_VIRTUAL_HID)
+		linux_device_config Config = linux_device_info::get_config();
+		Config.bCalibrationCache = true;
+		linux_device_info::configure(Config);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * @brief Waits until Deadline, returning early as soon as a watched controller has input.
+	 * @return true when woken by input, false when the deadline was reached.
+	 */
+	inline bool wait_for_input(std::chrono::steady_clock::time_point Deadline)
+	{
+#if defined(__linux__) && !defined(GAMEPAD_CORE_VIRTUAL_HID)
+		return linux_input_reactor::Get().wait_until(Deadline) > 0;
+#else
+		std::this_thread::sleep_until(Deadline);
+		return false;
+#endif
+	}
+
+	/**
+	 * @brief Measures the real time between ticks instead of assuming a fixed frame rate.
+	 */
+	class frame_clock
+	{
+	public:
+		/** @brief Seconds since the previous call, clamped to [0, 0.1]; 0 on the first call. */
+		float tick()
+		{
+			const auto Now = std::chrono::steady_clock::now();
+			const float Seconds = bStarted ? std::chrono::duration<float>(Now - Last).count() : 0.0f;
+			Last = Now;
+			bStarted = true;
+			return Seconds < 0.0f ? 0.0f : (Seconds > 0.1f ? 0.1f : Seconds);
+		}
+
+	private:
+		std::chrono::steady_clock::time_point Last{};
+		bool bStarted = false;
+	};
+
+	/**
+	 * @brief Lets backends that queue I/O (io_uring) hand what is queued to the kernel.
+	 *
+	 * Touches no device context, so per-controller worker threads call this after queuing audio
+	 * instead of end_tick(). A no-op on other backends.
+	 */
+	inline void submit_io()
+	{
+#if GAMEPAD_CORE_IO_URING
+		linux_uring_device_info::submit();
+#endif
+	}
+
+	/**
+	 * @brief Call once per tick after inputs were read and outputs updated, from the thread that
+	 * runs the registry loop.
+	 *
+	 * Sends the output changes coalesced during the tick through the owning contexts, then
+	 * submits queued I/O. A no-op on other platforms.
+	 */
+	inline void end_tick()
+	{
+#if defined(__linux__) && !defined(GAMEPAD_CORE_VIRTUAL_HID)
+		linux_device_info::flush_outputs();
+#endif
+		submit_io();
+	}
 } // namespace test_utils
 
 #endif
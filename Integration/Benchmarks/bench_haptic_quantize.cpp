@@ -0,0 +1,117 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Cost of turning float haptic samples into payload integers, in ns per sample. The
+// per-sample loops haptic_processor used before are compared with haptic_quantize_int16/int8, with
+// and without dither, on the block sizes the processor hands them: 512 samples (a 256-frame USB
+// chunk) and 64 samples (one Bluetooth packet).
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Audio/haptic_quantize.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// The conversions haptic_processor did inline, one sample at a time.
+static void loop_int16(const float* In, std::size_t Count, std::int16_t* Out)
+{
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		Out[i] = static_cast<std::int16_t>(std::clamp(In[i], -1.0f, 1.0f) * 32767.0f);
+	}
+}
+
+static void loop_int8(const float* In, std::size_t Count, std::int8_t* Out)
+{
+	for (std::size_t i = 0; i < Count; ++i)
+	{
+		Out[i] = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(In[i] * 127.0f)), -128, 127));
+	}
+}
+
+// Quantizes Input in Block-sized calls Passes times over and returns ns per sample.
+template<typename TSample, typename FKernel>
+static double measure(FKernel Kernel, const std::vector<float>& Input, std::size_t Block, std::uint32_t Passes)
+{
+	std::vector<TSample> Output(Input.size());
+	volatile int Sink = 0;
+	const auto Start = Clock::now();
+	for (std::uint32_t Pass = 0; Pass < Passes; ++Pass)
+	{
+		for (std::size_t First = 0; First + Block <= Input.size(); First += Block)
+		{
+			Kernel(&Input[First], Block, &Output[First]);
+		}
+		Sink = Sink + Output[Pass % Output.size()];
+	}
+	const double Elapsed = std::chrono::duration<double>(Clock::now() - Start).count();
+	return Elapsed * 1e9 / (static_cast<double>(Passes) * static_cast<double>(Input.size() / Block * Block));
+}
+
+static void print_row(const char* Name, std::size_t Block, double Loop, double Kernel, double Dithered)
+{
+	std::cout << std::left << std::setw(8) << Name << std::right
+	          << std::setw(8) << Block
+	          << std::fixed << std::setprecision(3)
+	          << std::setw(12) << Loop
+	          << std::setw(12) << Kernel
+	          << std::setw(12) << Dithered
+	          << std::setprecision(1)
+	          << std::setw(10) << Loop / Kernel
+	          << std::defaultfloat << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	std::uint32_t Passes = 2000;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view Arg(argv[i]);
+		if (Arg == "--passes" && i + 1 < argc)
+		{
+			Passes = static_cast<std::uint32_t>(std::max(1ul, std::strtoul(argv[++i], nullptr, 10)));
+		}
+		else
+		{
+			std::cout << "Usage: bench-haptic-quantize [--passes <passes over 64k samples>]" << std::endl;
+			return Arg == "--help" || Arg == "-h" ? 0 : 1;
+		}
+	}
+
+	// 64k samples of a tone that clips now and then, so saturation is exercised too.
+	std::vector<float> Input(65536);
+	for (std::size_t i = 0; i < Input.size(); ++i)
+	{
+		Input[i] = static_cast<float>(1.2 * std::sin(static_cast<double>(i) * 0.0137));
+	}
+
+	haptic_dither Dither;
+	std::cout << "Quantize kernels: " << haptic_quantize_simd_path() << std::endl;
+	std::cout << std::left << std::setw(8) << "format" << std::right
+	          << std::setw(8) << "block"
+	          << std::setw(12) << "loop ns"
+	          << std::setw(12) << "kernel ns"
+	          << std::setw(12) << "dither ns"
+	          << std::setw(10) << "speedup" << std::endl;
+
+	for (const std::size_t Block : {512u, 64u})
+	{
+		print_row("int16", Block,
+		          measure<std::int16_t>(loop_int16, Input, Block, Passes),
+		          measure<std::int16_t>([](const float* In, std::size_t Count, std::int16_t* Out) { haptic_quantize_int16(In, Count, Out); }, Input, Block, Passes),
+		          measure<std::int16_t>([&Dither](const float* In, std::size_t Count, std::int16_t* Out) { haptic_quantize_int16(In, Count, Out, &Dither); }, Input, Block, Passes));
+		print_row("int8", Block,
+		          measure<std::int8_t>(loop_int8, Input, Block, Passes),
+		          measure<std::int8_t>([](const float* In, std::size_t Count, std::int8_t* Out) { haptic_quantize_int8(In, Count, Out); }, Input, Block, Passes),
+		          measure<std::int8_t>([&Dither](const float* In, std::size_t Count, std::int8_t* Out) { haptic_quantize_int8(In, Count, Out, &Dither); }, Input, Block, Passes));
+	}
+	return 0;
+}
+#endif
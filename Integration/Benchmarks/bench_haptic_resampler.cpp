@@ -0,0 +1,120 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Throughput of the Bluetooth haptics downsampling, 48 kHz stereo to 3 kHz, for the
+// linear haptic_resampler and the anti-aliased haptic_fir_decimator, with 1 to 16 controllers each
+// fed their own stream in 480-frame callbacks. Reports ns per input frame and how many times
+// faster than real time all controllers together are processed on one core.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Audio/haptic_fir_decimator.h"
+#include "Audio/haptic_resampler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t kInputRate = 48000;
+static constexpr std::size_t kCallbackFrames = 480;
+
+struct resample_cost
+{
+	double NanosecondsPerFrame = 0.0;
+	double RealTimeFactor = 0.0;
+};
+
+// Runs Seconds of audio through every resampler in turn, one callback at a time.
+template<typename FResampler>
+static resample_cost measure(std::vector<std::unique_ptr<FResampler>>& Resamplers, const std::vector<float>& Input, std::uint32_t Seconds)
+{
+	std::vector<float> Output(Resamplers.front()->max_output(kCallbackFrames) * 2);
+	const std::size_t Callbacks = Seconds * kInputRate / kCallbackFrames;
+	const std::size_t InputCallbacks = Input.size() / 2 / kCallbackFrames;
+
+	volatile float Sink = 0.0f;
+	const auto Start = Clock::now();
+	for (std::size_t c = 0; c < Callbacks; ++c)
+	{
+		const float* Block = &Input[(c % InputCallbacks) * kCallbackFrames * 2];
+		for (auto& Resampler : Resamplers)
+		{
+			if (Resampler->process(Block, kCallbackFrames, Output.data()) > 0)
+			{
+				Sink = Sink + Output[0];
+			}
+		}
+	}
+	const double Elapsed = std::chrono::duration<double>(Clock::now() - Start).count();
+
+	const double Frames = static_cast<double>(Callbacks) * kCallbackFrames * Resamplers.size();
+	resample_cost Cost;
+	Cost.NanosecondsPerFrame = Elapsed * 1e9 / Frames;
+	Cost.RealTimeFactor = static_cast<double>(Seconds) / Elapsed;
+	return Cost;
+}
+
+static void print_row(const char* Name, std::size_t Controllers, const resample_cost& Cost)
+{
+	std::cout << std::left << std::setw(10) << Name << std::right
+	          << std::setw(8) << Controllers
+	          << std::fixed << std::setprecision(2)
+	          << std::setw(14) << Cost.NanosecondsPerFrame
+	          << std::setprecision(0)
+	          << std::setw(14) << Cost.RealTimeFactor
+	          << std::defaultfloat << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	std::uint32_t Seconds = 20;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view Arg(argv[i]);
+		if (Arg == "--seconds" && i + 1 < argc)
+		{
+			Seconds = static_cast<std::uint32_t>(std::max(1ul, std::strtoul(argv[++i], nullptr, 10)));
+		}
+		else
+		{
+			std::cout << "Usage: bench-haptic-resampler [--seconds <audio seconds per run>]" << std::endl;
+			return Arg == "--help" || Arg == "-h" ? 0 : 1;
+		}
+	}
+
+	// One second of a two-tone signal, replayed.
+	std::vector<float> Input(kInputRate * 2);
+	for (std::size_t i = 0; i < kInputRate; ++i)
+	{
+		const double Time = static_cast<double>(i) / kInputRate;
+		Input[i * 2] = static_cast<float>(0.5 * std::sin(2.0 * 3.14159265358979 * 160.0 * Time) + 0.2 * std::sin(2.0 * 3.14159265358979 * 5000.0 * Time));
+		Input[i * 2 + 1] = -Input[i * 2];
+	}
+
+	std::cout << "FIR dot product: " << haptic_fir_decimator::simd_path() << ", " << haptic_fir_decimator(16).taps() << " taps" << std::endl;
+	std::cout << std::left << std::setw(10) << "resampler" << std::right
+	          << std::setw(8) << "pads"
+	          << std::setw(14) << "ns/frame"
+	          << std::setw(14) << "x realtime" << std::endl;
+
+	for (const std::size_t Controllers : {1u, 4u, 8u, 16u})
+	{
+		std::vector<std::unique_ptr<haptic_resampler>> Linear;
+		std::vector<std::unique_ptr<haptic_fir_decimator>> Fir;
+		for (std::size_t i = 0; i < Controllers; ++i)
+		{
+			Linear.push_back(std::make_unique<haptic_resampler>(kInputRate, 3000));
+			Fir.push_back(std::make_unique<haptic_fir_decimator>(kInputRate / 3000));
+		}
+		print_row("linear", Controllers, measure(Linear, Input, Seconds));
+		print_row("fir", Controllers, measure(Fir, Input, Seconds));
+	}
+	return 0;
+}
+#endif
@@ -0,0 +1,257 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Producer-side cost of handing USB haptic frames from an audio callback to a consumer
+// thread that drains as fast as it can, i.e. under maximum contention. Callbacks are paced at 100x
+// real time by default so the ring is sized as in the tests; --period-us 0 runs them back to back.
+// "queue" is the mutex-guarded std::queue of per-frame vectors the haptics tests used, "ring" pushes
+// the same frames one by one into spsc_ring and "ring bulk" pushes a whole callback at once.
+// Reported per simulated callback: latency percentiles and heap allocations on the producer thread.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Audio/haptic_frames.h"
+#include "GCore/Utils/SoDefines.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <queue>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// Only allocations made by the producer thread count; the consumer is allowed to allocate.
+static std::atomic<std::uint64_t> GAllocations{0};
+static thread_local bool GCountAllocations = false;
+
+void* operator new(std::size_t Size)
+{
+	if (GCountAllocations)
+	{
+		GAllocations.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (void* Memory = std::malloc(Size ? Size : 1))
+	{
+		return Memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* Memory) noexcept
+{
+	std::free(Memory);
+}
+
+void operator delete(void* Memory, std::size_t) noexcept
+{
+	std::free(Memory);
+}
+
+// The queue the haptics tests shared between the audio callback and the worker thread.
+template<typename T>
+class thread_safe_queue
+{
+public:
+	void push(const T& item)
+	{
+		gc_lock::lock_guard<gc_lock::mutex> lock(mMutex);
+		mQueue.push(item);
+	}
+
+	bool pop(T& item)
+	{
+		gc_lock::lock_guard<gc_lock::mutex> lock(mMutex);
+		if (mQueue.empty())
+		{
+			return false;
+		}
+		item = mQueue.front();
+		mQueue.pop();
+		return true;
+	}
+
+private:
+	std::queue<T> mQueue;
+	gc_lock::mutex mMutex;
+};
+
+struct transport_cost
+{
+	double P50Us = 0.0;
+	double P99Us = 0.0;
+	double MaxUs = 0.0;
+	double FramesPerSecond = 0.0;
+	double AllocationsPerCallback = 0.0;
+	std::uint64_t Dropped = 0;
+};
+
+static haptic_usb_frame make_frame(std::uint32_t Index)
+{
+	haptic_usb_frame Frame;
+	Frame.Left = static_cast<std::int16_t>(Index);
+	Frame.Right = static_cast<std::int16_t>(~Index);
+	return Frame;
+}
+
+struct bench_config
+{
+	std::uint32_t Callbacks = 20000;
+	std::uint32_t FramesPerCallback = 480;
+	std::uint32_t PeriodUs = 100;
+};
+
+// Runs Config.Callbacks producer calls, one every PeriodUs, while Drain runs on a second thread.
+template<typename FProduce, typename FDrain>
+static transport_cost measure(const bench_config& Config, FProduce&& Produce, FDrain&& Drain)
+{
+	std::atomic<bool> bDone{false};
+	std::thread Consumer([&] {
+		while (!bDone.load(std::memory_order_acquire))
+		{
+			Drain();
+			// Keeps a single-core machine usable; on more cores this is still a busy consumer.
+			std::this_thread::yield();
+		}
+		Drain();
+	});
+
+	std::vector<double> Latencies(Config.Callbacks);
+	const std::uint64_t AllocationsBefore = GAllocations.load(std::memory_order_relaxed);
+	const auto Start = Clock::now();
+	GCountAllocations = true;
+	for (std::uint32_t i = 0; i < Config.Callbacks; ++i)
+	{
+		std::this_thread::sleep_until(Start + std::chrono::microseconds(static_cast<std::uint64_t>(i) * Config.PeriodUs));
+		const auto CallbackStart = Clock::now();
+		Produce(i * Config.FramesPerCallback, Config.FramesPerCallback);
+		Latencies[i] = std::chrono::duration<double, std::micro>(Clock::now() - CallbackStart).count();
+	}
+	GCountAllocations = false;
+	const double Elapsed = std::chrono::duration<double>(Clock::now() - Start).count();
+	const std::uint64_t Allocations = GAllocations.load(std::memory_order_relaxed) - AllocationsBefore;
+
+	bDone.store(true, std::memory_order_release);
+	Consumer.join();
+
+	std::sort(Latencies.begin(), Latencies.end());
+	transport_cost Cost;
+	Cost.P50Us = Latencies[Latencies.size() / 2];
+	Cost.P99Us = Latencies[std::min<std::size_t>(Latencies.size() - 1, Latencies.size() * 99 / 100)];
+	Cost.MaxUs = Latencies.back();
+	Cost.FramesPerSecond = static_cast<double>(Config.Callbacks) * Config.FramesPerCallback / Elapsed;
+	Cost.AllocationsPerCallback = static_cast<double>(Allocations) / Config.Callbacks;
+	return Cost;
+}
+
+static void print_row(const char* Name, const transport_cost& Cost)
+{
+	std::cout << std::left << std::setw(12) << Name << std::right
+	          << std::fixed << std::setprecision(2)
+	          << std::setw(10) << Cost.P50Us
+	          << std::setw(10) << Cost.P99Us
+	          << std::setw(10) << Cost.MaxUs
+	          << std::setprecision(1)
+	          << std::setw(14) << Cost.FramesPerSecond / 1e6
+	          << std::setprecision(2)
+	          << std::setw(14) << Cost.AllocationsPerCallback
+	          << std::setw(10) << Cost.Dropped
+	          << std::defaultfloat << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	bench_config Config;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view Arg(argv[i]);
+		if (Arg == "--callbacks" && i + 1 < argc)
+		{
+			Config.Callbacks = static_cast<std::uint32_t>(std::max(1ul, std::strtoul(argv[++i], nullptr, 10)));
+		}
+		else if (Arg == "--frames" && i + 1 < argc)
+		{
+			Config.FramesPerCallback = static_cast<std::uint32_t>(std::clamp(std::strtoul(argv[++i], nullptr, 10), 1ul, static_cast<unsigned long>(haptic_usb_ring::capacity())));
+		}
+		else if (Arg == "--period-us" && i + 1 < argc)
+		{
+			Config.PeriodUs = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			std::cout << "Usage: bench-haptic-ring [--callbacks <n>] [--frames <per callback>] [--period-us <us>]\n"
+			          << "  Defaults: 20000 callbacks of 480 frames (10 ms at 48 kHz), one every 100 us." << std::endl;
+			return Arg == "--help" || Arg == "-h" ? 0 : 1;
+		}
+	}
+
+	std::cout << std::left << std::setw(12) << "transport" << std::right
+	          << std::setw(10) << "p50 us"
+	          << std::setw(10) << "p99 us"
+	          << std::setw(10) << "max us"
+	          << std::setw(14) << "Mframes/s"
+	          << std::setw(14) << "allocs/call"
+	          << std::setw(10) << "dropped" << std::endl;
+
+	{
+		thread_safe_queue<std::vector<int16_t>> Queue;
+		std::vector<int16_t> Sample;
+		const auto Produce = [&Queue](std::uint32_t First, std::uint32_t Count) {
+			for (std::uint32_t i = 0; i < Count; ++i)
+			{
+				const haptic_usb_frame Frame = make_frame(First + i);
+				std::vector<int16_t> stereoSample = {Frame.Left, Frame.Right};
+				Queue.push(stereoSample);
+			}
+		};
+		const auto Drain = [&Queue, &Sample] {
+			while (Queue.pop(Sample))
+			{
+			}
+		};
+		print_row("queue", measure(Config, Produce, Drain));
+	}
+
+	// Heap-allocated: the ring holds its slots inline.
+	auto Ring = std::make_unique<haptic_usb_ring>();
+	haptic_usb_frame Drained[512];
+	const auto DrainRing = [&Ring, &Drained] {
+		while (Ring->pop(Drained, 512))
+		{
+		}
+	};
+
+	{
+		const auto Produce = [&Ring](std::uint32_t First, std::uint32_t Count) {
+			for (std::uint32_t i = 0; i < Count; ++i)
+			{
+				Ring->try_push(make_frame(First + i));
+			}
+		};
+		transport_cost Cost = measure(Config, Produce, DrainRing);
+		Cost.Dropped = Ring->dropped();
+		print_row("ring", Cost);
+	}
+
+	{
+		const std::uint64_t DroppedBefore = Ring->dropped();
+		std::vector<haptic_usb_frame> Callback(Config.FramesPerCallback);
+		const auto Produce = [&Ring, &Callback](std::uint32_t First, std::uint32_t Count) {
+			for (std::uint32_t i = 0; i < Count; ++i)
+			{
+				Callback[i] = make_frame(First + i);
+			}
+			Ring->push(Callback.data(), Count);
+		};
+		transport_cost Cost = measure(Config, Produce, DrainRing);
+		Cost.Dropped = Ring->dropped() - DroppedBefore;
+		print_row("ring bulk", Cost);
+	}
+	return 0;
+}
+#endif
@@ -0,0 +1,223 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Cost of one detect() call for 1, 8 and 32 controllers.
+// "rebuild" is the previous detect(): clear the list, build the PID set and copy a full context per
+// controller. "poll" re-enumerates every call but diffs by path into a persistent list, and
+// "hotplug" is the steady state with linux_hotplug_monitor, where nothing changed since last call.
+// Enumeration itself is synthetic so the numbers isolate detect() from the kernel; --live adds the
+// real backends on whatever controllers are connected.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "GCore/Types/ECoreGamepad.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "Platform/linux/linux_device_detection.h"
+#include "Platform/linux/linux_device_info.h"
+#include "Platform/linux/linux_hidraw_device_info.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<std::uint64_t> GAllocations{0};
+
+void* operator new(std::size_t Size)
+{
+	GAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* Memory = std::malloc(Size ? Size : 1))
+	{
+		return Memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* Memory) noexcept
+{
+	std::free(Memory);
+}
+
+void operator delete(void* Memory, std::size_t) noexcept
+{
+	std::free(Memory);
+}
+
+// Stand-in for one SDL_hid_device_info entry.
+struct synthetic_device
+{
+	char Path[32];
+	std::uint16_t ProductId;
+	int InterfaceNumber;
+};
+
+struct detect_cost
+{
+	double NanosecondsPerCall = 0.0;
+	double AllocationsPerCall = 0.0;
+};
+
+template<typename FDetect>
+static detect_cost measure(std::uint32_t Iterations, FDetect&& Detect)
+{
+	// One untimed call so first-use allocations (reserve, persistent lists) are not counted.
+	Detect();
+
+	const std::uint64_t AllocationsBefore = GAllocations.load(std::memory_order_relaxed);
+	const auto Start = Clock::now();
+	for (std::uint32_t i = 0; i < Iterations; ++i)
+	{
+		Detect();
+	}
+	const double Elapsed = std::chrono::duration<double, std::nano>(Clock::now() - Start).count();
+
+	detect_cost Cost;
+	Cost.NanosecondsPerCall = Elapsed / Iterations;
+	Cost.AllocationsPerCall = static_cast<double>(GAllocations.load(std::memory_order_relaxed) - AllocationsBefore) / Iterations;
+	return Cost;
+}
+
+static void rebuild_detect(const std::vector<synthetic_device>& Enumeration, std::vector<FDeviceContext>& Devices)
+{
+	Devices.clear();
+
+	const std::unordered_set<uint16_t> SupportedPIDs = {
+	    DUALSHOCK4_PID_V1,
+	    DUALSHOCK4_PID_V2,
+	    DUALSENSE_PID,
+	    DUALSENSE_EDGE_PID};
+
+	for (const synthetic_device& Device : Enumeration)
+	{
+		if (SupportedPIDs.contains(Device.ProductId))
+		{
+			FDeviceContext NewDeviceContext;
+			NewDeviceContext.Path = std::string(Device.Path);
+			NewDeviceContext.DeviceType = Device.ProductId == DUALSENSE_EDGE_PID ? EDSDeviceType::DualSenseEdge : EDSDeviceType::DualSense;
+			NewDeviceContext.IsConnected = true;
+			NewDeviceContext.ConnectionType = Device.InterfaceNumber == -1 ? EDSDeviceConnection::Bluetooth : EDSDeviceConnection::Usb;
+			NewDeviceContext.Handle = nullptr;
+			Devices.push_back(NewDeviceContext);
+		}
+	}
+}
+
+static void poll_detect(const std::vector<synthetic_device>& Enumeration, linux_device_tracker& Tracker, std::vector<linux_detected_device>& Added,
+                        std::vector<linux_detected_device>& Removed, std::vector<FDeviceContext>& Devices)
+{
+	Tracker.begin();
+	for (const synthetic_device& Device : Enumeration)
+	{
+		EDSDeviceType DeviceType;
+		if (linux_find_device_type(Device.ProductId, DeviceType))
+		{
+			Tracker.add(Device.Path, DeviceType, Device.InterfaceNumber == -1 ? EDSDeviceConnection::Bluetooth : EDSDeviceConnection::Usb);
+		}
+	}
+	Tracker.commit(Added, Removed, linux_monotonic_ns());
+	linux_reconcile_devices(Tracker.devices(), Devices);
+}
+
+static void print_row(const char* Name, std::uint32_t Count, const detect_cost& Cost)
+{
+	std::cout << std::left << std::setw(18) << Name << std::right
+	          << std::setw(8) << Count
+	          << std::fixed << std::setprecision(1)
+	          << std::setw(14) << Cost.NanosecondsPerCall
+	          << std::setprecision(2)
+	          << std::setw(14) << Cost.AllocationsPerCall
+	          << std::defaultfloat << std::endl;
+}
+
+template<typename FBackend>
+static void run_live(const char* Name, std::uint32_t Iterations, bool bHotplugMonitor)
+{
+	linux_device_config Config = linux_device_info::get_config();
+	Config.bHotplugMonitor = bHotplugMonitor;
+	linux_device_info::configure(Config);
+
+	std::vector<FDeviceContext> Devices;
+	const detect_cost Cost = measure(Iterations, [&Devices] {
+		FBackend::detect(Devices);
+	});
+	print_row(Name, static_cast<std::uint32_t>(Devices.size()), Cost);
+}
+
+int main(int argc, char* argv[])
+{
+	std::uint32_t Iterations = 100000;
+	bool bLive = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view Arg(argv[i]);
+		if (Arg == "--iterations" && i + 1 < argc)
+		{
+			Iterations = static_cast<std::uint32_t>(std::max(1ul, std::strtoul(argv[++i], nullptr, 10)));
+		}
+		else if (Arg == "--live")
+		{
+			bLive = true;
+		}
+		else
+		{
+			std::cout << "Usage: bench-linux-detect [--iterations <n>] [--live]\n"
+			          << "  --live   Also time the real SDL and hidraw detect() with and without the hotplug monitor." << std::endl;
+			return Arg == "--help" || Arg == "-h" ? 0 : 1;
+		}
+	}
+
+	std::cout << std::left << std::setw(18) << "detect" << std::right
+	          << std::setw(8) << "pads"
+	          << std::setw(14) << "ns/call"
+	          << std::setw(14) << "allocs/call" << std::endl;
+
+	for (std::uint32_t Count : {1u, 8u, 32u})
+	{
+		std::vector<synthetic_device> Enumeration(Count);
+		for (std::uint32_t i = 0; i < Count; ++i)
+		{
+			std::snprintf(Enumeration[i].Path, sizeof(Enumeration[i].Path), "/dev/hidraw%u", i);
+			Enumeration[i].ProductId = (i % 2) ? DUALSENSE_EDGE_PID : DUALSENSE_PID;
+			Enumeration[i].InterfaceNumber = (i % 3) ? 3 : -1;
+		}
+
+		std::vector<FDeviceContext> Devices;
+		print_row("rebuild", Count, measure(Iterations, [&] {
+			          rebuild_detect(Enumeration, Devices);
+		          }));
+
+		linux_device_tracker Tracker;
+		std::vector<linux_detected_device> Added;
+		std::vector<linux_detected_device> Removed;
+		Added.reserve(linux_device_tracker::kReserved);
+		Removed.reserve(linux_device_tracker::kReserved);
+		Devices.clear();
+		print_row("poll", Count, measure(Iterations, [&] {
+			          poll_detect(Enumeration, Tracker, Added, Removed, Devices);
+		          }));
+
+		// What detect() does while the hotplug generation is unchanged.
+		print_row("hotplug", Count, measure(Iterations, [&] {
+			          linux_reconcile_devices(Tracker.devices(), Devices);
+		          }));
+	}
+
+	if (bLive)
+	{
+		const std::uint32_t LiveIterations = std::max(1u, Iterations / 100);
+		run_live<linux_device_info>("live sdl poll", LiveIterations, false);
+		run_live<linux_device_info>("live sdl hotplug", LiveIterations, true);
+		run_live<linux_hidraw_device_info>("live hidraw poll", LiveIterations, false);
+		run_live<linux_hidraw_device_info>("live hidraw hotplug", LiveIterations, true);
+	}
+	return 0;
+}
+#endif
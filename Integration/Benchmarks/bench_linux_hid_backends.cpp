@@ -0,0 +1,259 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Compares the SDL_hidapi and native hidraw Linux backends on the same controller:
+// reports per second delivered, and per-call latency of empty reads, successful reads and writes.
+// Works on real hardware or against uhid-gamepad-emulator (e.g. "dualsense:usb:rate=4000").
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "GCore/Types/ECoreGamepad.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "Platform/linux/linux_device_info.h"
+#include "Platform/linux/linux_hidraw_device_info.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t kMaxSamples = 1 << 20;
+
+struct latency_samples
+{
+	std::vector<std::uint32_t> Nanoseconds;
+
+	latency_samples() { Nanoseconds.reserve(kMaxSamples); }
+
+	void add(Clock::duration Elapsed)
+	{
+		if (Nanoseconds.size() < Nanoseconds.capacity())
+		{
+			Nanoseconds.push_back(static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Elapsed).count()));
+		}
+	}
+
+	void print(const char* Label)
+	{
+		std::cout << "  " << std::left << std::setw(12) << Label << std::right;
+		if (Nanoseconds.empty())
+		{
+			std::cout << " (no samples)" << std::endl;
+			return;
+		}
+
+		std::sort(Nanoseconds.begin(), Nanoseconds.end());
+		std::uint64_t Sum = 0;
+		for (std::uint32_t Value : Nanoseconds)
+		{
+			Sum += Value;
+		}
+		const auto Percentile = [this](double P) {
+			return Nanoseconds[std::min(Nanoseconds.size() - 1, static_cast<std::size_t>(P * Nanoseconds.size()))];
+		};
+
+		std::cout << " n=" << std::setw(8) << Nanoseconds.size()
+		          << "  avg=" << std::setw(7) << Sum / Nanoseconds.size() << "ns"
+		          << "  p50=" << std::setw(7) << Percentile(0.50) << "ns"
+		          << "  p99=" << std::setw(7) << Percentile(0.99) << "ns"
+		          << "  max=" << std::setw(8) << Nanoseconds.back() << "ns" << std::endl;
+	}
+};
+
+static std::int32_t input_report_length(const FDeviceContext& Context)
+{
+	if (Context.ConnectionType == EDSDeviceConnection::Bluetooth)
+	{
+		return Context.DeviceType == EDSDeviceType::DualShock4 ? 547 : 78;
+	}
+	return 64;
+}
+
+static unsigned char output_report_id(const FDeviceContext& Context)
+{
+	const bool bBluetooth = Context.ConnectionType == EDSDeviceConnection::Bluetooth;
+	if (Context.DeviceType == EDSDeviceType::DualShock4)
+	{
+		return bBluetooth ? 0x11 : 0x05;
+	}
+	return bBluetooth ? 0x31 : 0x02;
+}
+
+static const char* connection_name(const FDeviceContext& Context)
+{
+	return Context.ConnectionType == EDSDeviceConnection::Bluetooth ? "Bluetooth" : "USB";
+}
+
+// Enumeration order differs between backends, so the same controller is matched by its hidraw node.
+static FDeviceContext* find_by_path(std::vector<FDeviceContext>& Devices, const std::string& Path)
+{
+	const auto Found = std::find_if(Devices.begin(), Devices.end(), [&Path](const FDeviceContext& Device) { return Device.Path == Path; });
+	return Found != Devices.end() ? &*Found : nullptr;
+}
+
+template<typename TBackend>
+static bool run_backend(const char* Name, FDeviceContext& Context, double DurationSeconds, std::uint32_t Writes)
+{
+	if (!TBackend::create_handle(&Context))
+	{
+		std::cerr << "[" << Name << "] Failed to open " << Context.Path << std::endl;
+		return false;
+	}
+
+	const std::int32_t Length = input_report_length(Context);
+	unsigned char Buffer[547] = {0};
+
+	// Let the kernel queue fill once and drain it, so the timed run starts from steady state.
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	std::int32_t BytesRead = 0;
+	while (TBackend::poll_tick(Context.Handle, Buffer, Length, BytesRead) == EPollResult::ReadOk)
+	{
+	}
+
+	latency_samples EmptyReads;
+	latency_samples Reports;
+	std::uint64_t Calls = 0;
+	std::uint64_t Delivered = 0;
+	bool bDisconnected = false;
+
+	const Clock::time_point Start = Clock::now();
+	const Clock::time_point End = Start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(DurationSeconds));
+	Clock::time_point Now = Start;
+	while (Now < End)
+	{
+		const EPollResult Result = TBackend::poll_tick(Context.Handle, Buffer, Length, BytesRead);
+		const Clock::time_point After = Clock::now();
+		++Calls;
+
+		if (Result == EPollResult::ReadOk)
+		{
+			++Delivered;
+			Reports.add(After - Now);
+		}
+		else if (Result == EPollResult::Disconnected)
+		{
+			bDisconnected = true;
+			break;
+		}
+		else
+		{
+			EmptyReads.add(After - Now);
+		}
+		Now = After;
+	}
+	const double Elapsed = std::chrono::duration<double>(Clock::now() - Start).count();
+
+	latency_samples WriteSamples;
+	if (Writes > 0 && !bDisconnected)
+	{
+		// Report ID only, every flag cleared: the controller accepts it and changes nothing.
+		unsigned char* Output = Context.GetRawOutputBuffer();
+		Output[0] = output_report_id(Context);
+		for (std::uint32_t i = 0; i < Writes && Context.Handle; ++i)
+		{
+			const Clock::time_point Before = Clock::now();
+			TBackend::send_output(&Context);
+			WriteSamples.add(Clock::now() - Before);
+		}
+	}
+
+	std::cout << "[" << Name << "] " << Context.Path << " (" << connection_name(Context) << ")" << std::endl;
+	std::cout << "  calls=" << Calls << "  reports=" << Delivered
+	          << "  reports/s=" << std::fixed << std::setprecision(1) << (Elapsed > 0.0 ? Delivered / Elapsed : 0.0)
+	          << "  calls/s=" << (Elapsed > 0.0 ? Calls / Elapsed : 0.0) << std::defaultfloat << std::endl;
+	EmptyReads.print("empty read");
+	Reports.print("report read");
+	if (Writes > 0)
+	{
+		WriteSamples.print("write");
+	}
+	if (bDisconnected)
+	{
+		std::cout << "  Device disconnected during the run." << std::endl;
+	}
+
+	TBackend::invalidate_handle(&Context);
+	return !bDisconnected;
+}
+
+static void print_help()
+{
+	std::cout << "Usage: bench-linux-hid-backends [--duration <seconds>] [--device <index>] [--writes <count>]\n"
+	          << "  Spins on non-blocking reads of one controller through SDL_hidapi, then through /dev/hidraw,\n"
+	          << "  and prints delivered reports/s plus read and write latency percentiles for each backend.\n"
+	          << "  --device counts in hidraw enumeration order; SDL_hidapi opens the same node by path.\n"
+	          << "  Without hardware, start e.g. 'uhid-gamepad-emulator dualsense:usb:rate=4000' first." << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	double DurationSeconds = 5.0;
+	std::size_t DeviceIndex = 0;
+	std::uint32_t Writes = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view Arg(argv[i]);
+		if (Arg == "--duration" && i + 1 < argc)
+		{
+			DurationSeconds = std::strtod(argv[++i], nullptr);
+		}
+		else if (Arg == "--device" && i + 1 < argc)
+		{
+			DeviceIndex = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (Arg == "--writes" && i + 1 < argc)
+		{
+			Writes = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			print_help();
+			return Arg == "--help" || Arg == "-h" ? 0 : 1;
+		}
+	}
+
+	// Time the transport itself: every write must reach the device.
+	linux_device_config Config = linux_device_info::get_config();
+	Config.bSuppressUnchangedOutput = false;
+	Config.bCoalesceOutput = false;
+	// Devices are opened straight from one detect(), so do not hold them back for async open.
+	Config.bAsyncOpen = false;
+	linux_device_info::configure(Config);
+
+	std::vector<FDeviceContext> HidrawDevices;
+	linux_hidraw_device_info::detect(HidrawDevices);
+	if (DeviceIndex >= HidrawDevices.size())
+	{
+		std::cerr << "Controller #" << DeviceIndex << " not found (" << HidrawDevices.size() << " detected)" << std::endl;
+		return 1;
+	}
+	FDeviceContext& Hidraw = HidrawDevices[DeviceIndex];
+
+	std::vector<FDeviceContext> SdlDevices;
+	linux_device_info::detect(SdlDevices);
+	FDeviceContext* Sdl = find_by_path(SdlDevices, Hidraw.Path);
+	if (!Sdl)
+	{
+		std::cerr << "[SDL_hidapi] " << Hidraw.Path << " not found (" << SdlDevices.size() << " detected)" << std::endl;
+		return 1;
+	}
+	// Bluetooth and USB reports differ in size and rate, so a mismatch would compare different workloads.
+	if (Sdl->ConnectionType != Hidraw.ConnectionType || Sdl->DeviceType != Hidraw.DeviceType)
+	{
+		std::cerr << Hidraw.Path << " is " << connection_name(*Sdl) << " to SDL_hidapi but " << connection_name(Hidraw)
+		          << " to hidraw; the runs would not be comparable." << std::endl;
+		return 1;
+	}
+
+	std::cout << "Linux HID backend benchmark: " << DurationSeconds << "s per backend" << std::endl;
+	const bool bSdlOk = run_backend<linux_device_info>("SDL_hidapi", *Sdl, DurationSeconds, Writes);
+	const bool bHidrawOk = run_backend<linux_hidraw_device_info>("hidraw", Hidraw, DurationSeconds, Writes);
+	return (bSdlOk && bHidrawOk) ? 0 : 1;
+}
+#endif
@@ -0,0 +1,424 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Per-tick cost of driving many controllers with each Linux backend.
+// Every tick reads and writes every device, like a game loop would, and the benchmark reports
+// process CPU time, read/write syscalls (from /proc/self/io) and io_uring_enter() calls per tick
+// for 1..N controllers. With --spawn-emulator the controllers are uhid-gamepad-emulator devices,
+// and a second sweep runs them at 1000 Hz against a 16 ms tick in drain-to-latest mode, where a
+// backend that delivers fewer reports per tick than the pads send falls behind and input ages.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "GCore/Types/ECoreGamepad.h"
+#include "GCore/Types/Structs/Context/DeviceContext.h"
+#include "Platform/linux/linux_device_info.h"
+#include "Platform/linux/linux_hidraw_device_info.h"
+#if GAMEPAD_CORE_HAS_IO_URING
+#include "Platform/linux/linux_uring_device_info.h"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <spawn.h>
+#include <string>
+#include <string_view>
+#include <sys/wait.h>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+extern char** environ;
+
+using Clock = std::chrono::steady_clock;
+
+struct bench_options
+{
+	std::vector<std::uint32_t> Counts = {1, 2, 4, 8, 16, 32};
+	std::uint32_t Ticks = 2000;
+	std::uint32_t TickMicroseconds = 4000;
+	std::uint32_t EmulatorRateHz = 250;
+	std::string Backend = "all";
+	bool bSpawnEmulator = false;
+	bool bCoalesce = false;
+	std::string EmulatorPath;
+};
+
+struct tick_cost
+{
+	double CpuMicroseconds = 0.0;
+	double IoSyscalls = 0.0;
+	double RingEnters = 0.0;
+	double Reports = 0.0;
+	// Worst InputAgeUs over all devices, in milliseconds.
+	double MaxAgeMilliseconds = 0.0;
+};
+
+static double process_cpu_seconds()
+{
+	timespec Ts{};
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &Ts);
+	return static_cast<double>(Ts.tv_sec) + static_cast<double>(Ts.tv_nsec) * 1e-9;
+}
+
+// syscr + syscw: read- and write-class syscalls of the whole process. io_uring_enter and poll are not included.
+static std::uint64_t process_io_syscalls()
+{
+	FILE* File = std::fopen("/proc/self/io", "r");
+	if (!File)
+	{
+		return 0;
+	}
+
+	std::uint64_t Total = 0;
+	char Line[128];
+	unsigned long long Value = 0;
+	while (std::fgets(Line, sizeof(Line), File))
+	{
+		if (std::sscanf(Line, "syscr: %llu", &Value) == 1 || std::sscanf(Line, "syscw: %llu", &Value) == 1)
+		{
+			Total += Value;
+		}
+	}
+	std::fclose(File);
+	return Total;
+}
+
+static std::uint64_t ring_enters()
+{
+#if GAMEPAD_CORE_HAS_IO_URING
+	return linux_uring_device_info::get_uring_statistics().Submits;
+#else
+	return 0;
+#endif
+}
+
+static void end_tick([[maybe_unused]] bool bUring)
+{
+	linux_device_info::flush_outputs();
+#if GAMEPAD_CORE_HAS_IO_URING
+	if (bUring)
+	{
+		linux_uring_device_info::submit();
+	}
+#endif
+}
+
+template<typename TBackend>
+static bool run_backend(const bench_options& Options, std::uint32_t Count, bool bUring, tick_cost& OutCost)
+{
+	std::vector<FDeviceContext> Devices;
+	TBackend::detect(Devices);
+	if (Devices.size() < Count)
+	{
+		return false;
+	}
+	Devices.resize(Count);
+
+	for (FDeviceContext& Context : Devices)
+	{
+		if (!TBackend::create_handle(&Context))
+		{
+			std::cerr << "[Bench] Failed to open " << Context.Path << std::endl;
+			for (FDeviceContext& Opened : Devices)
+			{
+				if (Opened.Handle)
+				{
+					TBackend::invalidate_handle(&Opened);
+				}
+			}
+			return false;
+		}
+
+		unsigned char* Output = Context.GetRawOutputBuffer();
+		const bool bBluetooth = Context.ConnectionType == EDSDeviceConnection::Bluetooth;
+		if (Context.DeviceType == EDSDeviceType::DualShock4)
+		{
+			Output[0] = bBluetooth ? 0x11 : 0x05;
+		}
+		else
+		{
+			Output[0] = bBluetooth ? 0x31 : 0x02;
+		}
+	}
+
+	const auto TickInterval = std::chrono::microseconds(Options.TickMicroseconds);
+	const auto RunTicks = [&](std::uint32_t Ticks) {
+		Clock::time_point NextTick = Clock::now();
+		for (std::uint32_t Tick = 0; Tick < Ticks; ++Tick)
+		{
+			for (FDeviceContext& Context : Devices)
+			{
+				TBackend::read(&Context);
+				TBackend::write(&Context);
+			}
+			end_tick(bUring);
+
+			NextTick += TickInterval;
+			std::this_thread::sleep_until(NextTick);
+		}
+	};
+
+	// Warm-up: fills the kernel queues once and lets io_uring spawn its workers.
+	RunTicks(50);
+
+	std::uint64_t ReportsBefore = 0;
+	for (const FDeviceContext& Context : Devices)
+	{
+		ReportsBefore += linux_device_info::get_statistics(&Context).ReportsRead;
+	}
+	const double CpuBefore = process_cpu_seconds();
+	const std::uint64_t IoBefore = process_io_syscalls();
+	const std::uint64_t EntersBefore = ring_enters();
+
+	RunTicks(Options.Ticks);
+
+	const double CpuAfter = process_cpu_seconds();
+	const std::uint64_t IoAfter = process_io_syscalls();
+	const std::uint64_t EntersAfter = ring_enters();
+	std::uint64_t ReportsAfter = 0;
+	std::uint32_t MaxAgeUs = 0;
+	for (const FDeviceContext& Context : Devices)
+	{
+		const linux_device_statistics Stats = linux_device_info::get_statistics(&Context);
+		ReportsAfter += Stats.ReportsRead;
+		MaxAgeUs = std::max(MaxAgeUs, Stats.MaxInputAgeUs);
+	}
+
+	const double Ticks = static_cast<double>(Options.Ticks);
+	OutCost.CpuMicroseconds = (CpuAfter - CpuBefore) * 1e6 / Ticks;
+	OutCost.IoSyscalls = static_cast<double>(IoAfter - IoBefore) / Ticks;
+	OutCost.RingEnters = static_cast<double>(EntersAfter - EntersBefore) / Ticks;
+	OutCost.Reports = static_cast<double>(ReportsAfter - ReportsBefore) / Ticks;
+	OutCost.MaxAgeMilliseconds = MaxAgeUs / 1000.0;
+
+	for (FDeviceContext& Context : Devices)
+	{
+		TBackend::invalidate_handle(&Context);
+	}
+	return true;
+}
+
+static pid_t spawn_emulator(const bench_options& Options, std::uint32_t Count)
+{
+	std::vector<std::string> Args;
+	Args.push_back(Options.EmulatorPath);
+	for (std::uint32_t i = 0; i < Count; ++i)
+	{
+		Args.push_back("dualsense:usb:rate=" + std::to_string(Options.EmulatorRateHz));
+	}
+
+	std::vector<char*> Argv;
+	for (std::string& Arg : Args)
+	{
+		Argv.push_back(Arg.data());
+	}
+	Argv.push_back(nullptr);
+
+	pid_t Pid = -1;
+	if (posix_spawn(&Pid, Options.EmulatorPath.c_str(), nullptr, nullptr, Argv.data(), environ) != 0)
+	{
+		return -1;
+	}
+
+	// Wait for udev to create the hidraw nodes and fix their permissions.
+	const Clock::time_point Deadline = Clock::now() + std::chrono::seconds(5);
+	std::vector<FDeviceContext> Devices;
+	while (Clock::now() < Deadline)
+	{
+		linux_hidraw_device_info::detect(Devices);
+		if (Devices.size() >= Count)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+			return Pid;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	return Pid;
+}
+
+static void stop_emulator(pid_t Pid)
+{
+	if (Pid > 0)
+	{
+		kill(Pid, SIGTERM);
+		int Status = 0;
+		waitpid(Pid, &Status, 0);
+	}
+}
+
+static void print_row(const char* Backend, std::uint32_t Count, const tick_cost& Cost)
+{
+	std::cout << std::left << std::setw(12) << Backend << std::right
+	          << std::setw(8) << Count
+	          << std::fixed << std::setprecision(2)
+	          << std::setw(14) << Cost.CpuMicroseconds
+	          << std::setw(14) << Cost.CpuMicroseconds / Count
+	          << std::setw(14) << Cost.IoSyscalls
+	          << std::setw(14) << Cost.RingEnters
+	          << std::setw(12) << Cost.Reports
+	          << std::setw(12) << Cost.MaxAgeMilliseconds
+	          << std::defaultfloat << std::endl;
+}
+
+static std::vector<std::uint32_t> parse_counts(std::string_view Text)
+{
+	std::vector<std::uint32_t> Counts;
+	while (!Text.empty())
+	{
+		const std::size_t Comma = Text.find(',');
+		const std::string Item(Text.substr(0, Comma));
+		const unsigned long Value = std::strtoul(Item.c_str(), nullptr, 10);
+		if (Value > 0)
+		{
+			Counts.push_back(static_cast<std::uint32_t>(Value));
+		}
+		Text = (Comma == std::string_view::npos) ? std::string_view() : Text.substr(Comma + 1);
+	}
+	return Counts;
+}
+
+static void print_help()
+{
+	std::cout << "Usage: bench-linux-hid-scaling [options]\n"
+	          << "  --counts <list>      Controller counts to measure (default 1,2,4,8,16,32)\n"
+	          << "  --ticks <n>          Measured ticks per run (default 2000)\n"
+	          << "  --tick-us <us>       Tick period in microseconds (default 4000)\n"
+	          << "  --backend <name>     sdl, hidraw, uring or all (default all)\n"
+	          << "  --spawn-emulator     Start uhid-gamepad-emulator with the needed device count (needs /dev/uhid)\n"
+	          << "  --rate <hz>          Report rate of spawned emulator devices (default 250)\n"
+	          << "  --coalesce           Send outputs through the per-tick coalescing path\n"
+	          << "Without --spawn-emulator the first N detected controllers are used and larger counts are skipped.\n"
+	          << "With it, a second sweep drives 1000 Hz pads from a 16 ms tick in drain-to-latest mode; every\n"
+	          << "backend should then read ~16 reports per pad and tick and keep 'max age' near one tick.\n"
+	          << "'rd/wr sys' counts read()/write() syscalls; SDL_hidapi also issues one poll() per read, not shown." << std::endl;
+}
+
+static void run_sweep(const bench_options& Options)
+{
+	const auto Wants = [&Options](const char* Name) {
+		return Options.Backend == "all" || Options.Backend == Name;
+	};
+
+	std::cout << std::left << std::setw(12) << "backend" << std::right
+	          << std::setw(8) << "pads"
+	          << std::setw(14) << "cpu us/tick"
+	          << std::setw(14) << "cpu us/pad"
+	          << std::setw(14) << "rd/wr sys"
+	          << std::setw(14) << "ring enters"
+	          << std::setw(12) << "reports"
+	          << std::setw(12) << "max age ms" << std::endl;
+
+	for (std::uint32_t Count : Options.Counts)
+	{
+		const pid_t Emulator = Options.bSpawnEmulator ? spawn_emulator(Options, Count) : -1;
+		tick_cost Cost;
+		bool bAnyRun = false;
+
+		if (Wants("sdl") && run_backend<linux_device_info>(Options, Count, false, Cost))
+		{
+			print_row("sdl", Count, Cost);
+			bAnyRun = true;
+		}
+		if (Wants("hidraw") && run_backend<linux_hidraw_device_info>(Options, Count, false, Cost))
+		{
+			print_row("hidraw", Count, Cost);
+			bAnyRun = true;
+		}
+#if GAMEPAD_CORE_HAS_IO_URING
+		if (Wants("uring") && linux_uring_device_info::is_available() && run_backend<linux_uring_device_info>(Options, Count, true, Cost))
+		{
+			print_row("uring", Count, Cost);
+			bAnyRun = true;
+		}
+#endif
+
+		stop_emulator(Emulator);
+		if (!bAnyRun)
+		{
+			std::cout << "[Bench] Fewer than " << Count << " controllers available, stopping." << std::endl;
+			break;
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bench_options Options;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view Arg(argv[i]);
+		if (Arg == "--counts" && i + 1 < argc)
+		{
+			Options.Counts = parse_counts(argv[++i]);
+		}
+		else if (Arg == "--ticks" && i + 1 < argc)
+		{
+			Options.Ticks = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (Arg == "--tick-us" && i + 1 < argc)
+		{
+			Options.TickMicroseconds = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (Arg == "--backend" && i + 1 < argc)
+		{
+			Options.Backend = argv[++i];
+		}
+		else if (Arg == "--rate" && i + 1 < argc)
+		{
+			Options.EmulatorRateHz = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (Arg == "--spawn-emulator")
+		{
+			Options.bSpawnEmulator = true;
+		}
+		else if (Arg == "--coalesce")
+		{
+			Options.bCoalesce = true;
+		}
+		else
+		{
+			print_help();
+			return Arg == "--help" || Arg == "-h" ? 0 : 1;
+		}
+	}
+
+	if (Options.bSpawnEmulator)
+	{
+		const std::string Self(argv[0]);
+		const std::size_t Slash = Self.rfind('/');
+		Options.EmulatorPath = (Slash == std::string::npos ? std::string(".") : Self.substr(0, Slash)) + "/uhid-gamepad-emulator";
+	}
+
+	// Every tick writes the same report; keep it from being filtered so the transport cost is measured.
+	linux_device_config Config = linux_device_info::get_config();
+	Config.bSuppressUnchangedOutput = false;
+	Config.bCoalesceOutput = Options.bCoalesce;
+	Config.MaxOutputRateUsbHz = 0;
+	Config.MaxOutputRateBluetoothHz = 0;
+	// The benchmark opens what one detect() returns, so devices must not be held back for async open.
+	Config.bAsyncOpen = false;
+	linux_device_info::configure(Config);
+
+	run_sweep(Options);
+
+	if (Options.bSpawnEmulator)
+	{
+		// Report rate well above the tick rate: the kernel queue fills between ticks and only a
+		// backend that drains it keeps up.
+		bench_options Oversampled = Options;
+		Oversampled.EmulatorRateHz = 1000;
+		Oversampled.TickMicroseconds = 16000;
+		Oversampled.Ticks = std::min<std::uint32_t>(Options.Ticks, 500);
+		Config.ReadMode = EReadMode::DrainToLatest;
+		linux_device_info::configure(Config);
+		std::cout << "\n1000 Hz pads, 16 ms tick, drain-to-latest:" << std::endl;
+		run_sweep(Oversampled);
+	}
+	return 0;
+}
+#endif
@@ -15,7 +15,6 @@
 #include <memory>
 #include <mutex>
 #include "GCore/Utils/SoDefines.h"
-#include <queue>
 #include <thread>
 #include <vector>
 namespace fs = std::filesystem;
@@ -30,51 +29,9 @@ namespace fs = std::filesystem;
 #include "GCore/Types/Structs/Context/DeviceContext.h"
 #include "GImplementations/Utils/GamepadAudio.h"
 #include "test_utils.h"
-
-// ============================================================================
-// Audio Haptics Constants (Based on AudioHapticsListener)
-// ============================================================================
-constexpr float kLowPassAlpha = 1.0f;
-constexpr float kOneMinusAlpha = 1.0f - kLowPassAlpha;
-
-constexpr float kLowPassAlphaBt = 1.0f;
-constexpr float kOneMinusAlphaBt = 1.0f - kLowPassAlphaBt;
-
-// ============================================================================
-// Thread-safe queue for audio packets
-// ============================================================================
-template<typename T>
-class thread_safe_queue
-{
-public:
-	void push(const T& item)
-	{
-		gc_lock::lock_guard<gc_lock::mutex> lock(mMutex);
-		mQueue.push(item);
-	}
-
-	bool pop(T& item)
-	{
-		gc_lock::lock_guard<gc_lock::mutex> lock(mMutex);
-		if (mQueue.empty())
-		{
-			return false;
-		}
-		item = mQueue.front();
-		mQueue.pop();
-		return true;
-	}
-
-	bool empty()
-	{
-		gc_lock::lock_guard<gc_lock::mutex> lock(mMutex);
-		return mQueue.empty();
-	}
-
-private:
-	std::queue<T> mQueue;
-	gc_lock::mutex mMutex;
-};
+#include "Audio/haptic_asset.h"
+#include "Audio/haptic_processor.h"
+#include "Audio/wav_mapped_source.h"
 
 // ============================================================================
 // Global state for audio callback
@@ -86,23 +43,25 @@ struct audio_callback_data
 #else
 	void* pDecoder = nullptr;
 #endif
+	// Mapped WAV played in place of pDecoder when the file is a WAV at the device rate.
+	wav_mapped_source* pWav = nullptr;
 	bool bIsSystemAudio = false;
-	float LowPassStateLeft = 0.0f;
-	float LowPassStateRight = 0.0f;
 	std::atomic<bool> bFinished{false};
 	std::atomic<uint64_t> framesPlayed{0};
 	bool bIsWireless = false;
 
-	// Queues for haptics (like AudioHapticsListener)
-	thread_safe_queue<std::vector<uint8_t>> btPacketQueue;
-	thread_safe_queue<std::vector<int16_t>> usbSampleQueue;
+	// Filter and resampler state and the packet being filled live here, preallocated. The worker
+	// replaces it with one filtered for the connected controller before the device starts.
+	haptic_processor Haptics;
 
-	// Accumulator for Bluetooth - need 1024 frames to produce 64 resampled frames
-	std::vector<float> btAccumulator;
-	gc_lock::mutex btAccumulatorMutex;
+	// Wait-free rings: the audio callback must never block on the consumer.
+	haptic_bt_ring btPacketQueue;
+	haptic_usb_ring usbSampleQueue;
 };
 
-// Audio callback - plays audio on speakers and queues haptics data
+// Audio callback - plays audio on speakers and queues haptics data.
+// Runs on the realtime thread: haptics are computed straight from the device buffers and
+// nothing here allocates or locks.
 #if GAMEPAD_CORE_HAS_AUDIO
 void audio_data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
 {
@@ -112,33 +71,51 @@ void audio_data_callback(ma_device* pDevice, void* pOutput, const void* pInput,
 		return;
 	}
 
-	std::vector<float> tempBuffer(frameCount * 2);
+	const float* pSource = nullptr;
 	ma_uint64 framesRead = 0;
 
 	if (pData->bIsSystemAudio)
 	{
-		// Capture from system audio (loopback)
 		if (pInput == nullptr)
 		{
 			return;
 		}
 
-		// miniaudio already provides the captured audio in pInput
-		const float* pInputFloat = static_cast<const float*>(pInput);
-		std::memcpy(tempBuffer.data(), pInputFloat, frameCount * 2 * sizeof(float));
+		pSource = static_cast<const float*>(pInput);
 		framesRead = frameCount;
 
-		// If we are in duplex mode or playback, we might want to copy to pOutput to hear it
-		// But usually loopback capture is enough.
 		if (pOutput)
 		{
 			std::memcpy(pOutput, pInput, frameCount * 2 * sizeof(float));
 		}
 	}
+	else if (pData->pWav && pOutput)
+	{
+		// Frames come straight from the mapping when the file is float stereo, otherwise they are
+		// converted into the device buffer; haptics read them wherever they are.
+		auto* pOutputFloat = static_cast<float*>(pOutput);
+		std::size_t Frames = 0;
+		const float* pFrames = pData->pWav->read_f32_stereo(pOutputFloat, frameCount, Frames);
+		if (Frames == 0)
+		{
+			pData->bFinished = true;
+			std::memset(pOutput, 0, frameCount * 2 * sizeof(float));
+			return;
+		}
+		if (pFrames != pOutputFloat)
+		{
+			std::memcpy(pOutputFloat, pFrames, Frames * 2 * sizeof(float));
+		}
+		if (Frames < frameCount)
+		{
+			std::memset(&pOutputFloat[Frames * 2], 0, (frameCount - Frames) * 2 * sizeof(float));
+		}
+		pSource = pFrames;
+		framesRead = Frames;
+	}
 	else
 	{
-		// Read from decoder
-		if (!pData->pDecoder)
+		if (!pData->pDecoder || !pOutput)
 		{
 			if (pOutput)
 			{
@@ -147,170 +124,33 @@ void audio_data_callback(ma_device* pDevice, void* pOutput, const void* pInput,
 			return;
 		}
 
-		ma_result result = ma_decoder_read_pcm_frames(pData->pDecoder, tempBuffer.data(), frameCount, &framesRead);
+		// Decode straight into the device buffer (f32 stereo at 48kHz) and read haptics from there.
+		auto* pOutputFloat = static_cast<float*>(pOutput);
+		ma_result result = ma_decoder_read_pcm_frames(pData->pDecoder, pOutputFloat, frameCount, &framesRead);
 
 		if (result != MA_SUCCESS || framesRead == 0)
 		{
 			pData->bFinished = true;
-			if (pOutput)
-			{
-				std::memset(pOutput, 0, frameCount * pDevice->playback.channels * ma_get_bytes_per_sample(pDevice->playback.format));
-			}
+			std::memset(pOutput, 0, frameCount * pDevice->playback.channels * ma_get_bytes_per_sample(pDevice->playback.format));
 			return;
 		}
 
-		// Copy to output (for speakers) - audio plays at 48kHz
-		if (pOutput)
+		if (framesRead < frameCount)
 		{
-			auto* pOutputFloat = static_cast<float*>(pOutput);
-			std::memcpy(pOutputFloat, tempBuffer.data(), framesRead * 2 * sizeof(float));
-
-			if (framesRead < frameCount)
-			{
-				std::memset(&pOutputFloat[framesRead * 2], 0, (frameCount - framesRead) * 2 * sizeof(float));
-			}
+			std::memset(&pOutputFloat[framesRead * 2], 0, (frameCount - framesRead) * 2 * sizeof(float));
 		}
+		pSource = pOutputFloat;
 	}
 
-	// Process for haptics
 	if (!pData->bIsWireless)
 	{
-		// USB: Queue 16-bit stereo samples with high-pass filter
-		for (ma_uint64 i = 0; i < framesRead; ++i)
-		{
-			float inLeft = tempBuffer[i * 2];
-			float inRight = tempBuffer[i * 2 + 1];
-
-			pData->LowPassStateLeft = kOneMinusAlpha * inLeft + kLowPassAlpha * pData->LowPassStateLeft;
-			pData->LowPassStateRight = kOneMinusAlpha * inRight + kLowPassAlpha * pData->LowPassStateRight;
-
-			float outLeft = std::clamp(inLeft - pData->LowPassStateLeft, -1.0f, 1.0f);
-			float outRight = std::clamp(inRight - pData->LowPassStateRight, -1.0f, 1.0f);
-
-			std::vector<int16_t> stereoSample = {
-			    static_cast<int16_t>(outLeft * 32767.0f),
-			    static_cast<int16_t>(outRight * 32767.0f)};
-			pData->usbSampleQueue.push(stereoSample);
-		}
+		// USB: 16-bit stereo frames for the controller's audio interface
+		pData->Haptics.process_usb(pSource, framesRead, pData->usbSampleQueue);
 	}
 	else
 	{
-		// Bluetooth: Need to accumulate 1024 input frames to get 64 output frames at 3000Hz
-		// 1024 frames at 48kHz * (3000/48000) = 64 frames at 3000Hz
-
-		// Add current frames to accumulator
-		for (ma_uint64 i = 0; i < framesRead; ++i)
-		{
-			pData->btAccumulator.push_back(tempBuffer[i * 2]);     // Left
-			pData->btAccumulator.push_back(tempBuffer[i * 2 + 1]); // Right
-		}
-
-		// Process when we have at least 1024 frames (2048 samples)
-		const size_t requiredSamples = 1024 * 2; // 1024 frames * 2 channels
-
-		while (true)
-		{
-			std::vector<float> framesToProcess;
-
-			{
-  		gc_lock::lock_guard<gc_lock::mutex> lock(pData->btAccumulatorMutex);
-				if (pData->btAccumulator.size() < requiredSamples)
-				{
-					break; // Not enough data yet, exit loop but continue to update framesPlayed
-				}
-
-				// Extract 1024 frames from accumulator
-				framesToProcess.assign(pData->btAccumulator.begin(), pData->btAccumulator.begin() + requiredSamples);
-				pData->btAccumulator.erase(pData->btAccumulator.begin(), pData->btAccumulator.begin() + requiredSamples);
-			}
-
-			// Now resample 1024 frames to 64 frames
-			const float ratio = 3000.0f / 48000.0f; // 0.0625
-			const std::int32_t numInputFrames = 1024;
-
-			std::vector<float> resampledData(128, 0.0f); // 64 frames * 2 channels
-
-			for (std::int32_t outFrame = 0; outFrame < 64; ++outFrame)
-			{
-				float srcPos = static_cast<float>(outFrame) / ratio;
-				std::int32_t srcIndex = static_cast<std::int32_t>(srcPos);
-				float frac = srcPos - static_cast<float>(srcIndex);
-
-				if (srcIndex >= numInputFrames - 1)
-				{
-					srcIndex = numInputFrames - 2;
-					frac = 1.0f;
-				}
-				if (srcIndex < 0)
-				{
-					srcIndex = 0;
-				}
-
-				float left0 = framesToProcess[srcIndex * 2];
-				float left1 = framesToProcess[(srcIndex + 1) * 2];
-				float right0 = framesToProcess[srcIndex * 2 + 1];
-				float right1 = framesToProcess[(srcIndex + 1) * 2 + 1];
-
-				resampledData[outFrame * 2] = left0 + frac * (left1 - left0);
-				resampledData[outFrame * 2 + 1] = right0 + frac * (right1 - right0);
-			}
-
-			// Apply high-pass filter to all 64 frames
-			for (std::int32_t i = 0; i < 64; ++i)
-			{
-				const std::int32_t dataIndex = i * 2;
-
-				float inLeft = resampledData[dataIndex];
-				float inRight = resampledData[dataIndex + 1];
-
-				pData->LowPassStateLeft = kOneMinusAlphaBt * inLeft + kLowPassAlphaBt * pData->LowPassStateLeft;
-				pData->LowPassStateRight = kOneMinusAlphaBt * inRight + kLowPassAlphaBt * pData->LowPassStateRight;
-
-				resampledData[dataIndex] = inLeft - pData->LowPassStateLeft;
-				resampledData[dataIndex + 1] = inRight - pData->LowPassStateRight;
-			}
-
-			// Create Packet1: Frames 0-31 (64 bytes)
-			std::vector<std::int8_t> packet1(64, 0);
-
-			for (std::int32_t i = 0; i < 32; ++i)
-			{
-				const std::int32_t dataIndex = i * 2;
-
-				float leftSample = resampledData[dataIndex];
-				float rightSample = resampledData[dataIndex + 1];
-
-				std::int8_t leftInt8 = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(leftSample * 127.0f)), -128, 127));
-				std::int8_t rightInt8 = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(rightSample * 127.0f)), -128, 127));
-
-				packet1[dataIndex] = leftInt8;
-				packet1[dataIndex + 1] = rightInt8;
-			}
-
-			// Create Packet2: Frames 32-63 (64 bytes)
-			std::vector<std::int8_t> packet2(64, 0);
-			for (std::int32_t i = 0; i < 32; ++i)
-			{
-				const std::int32_t dataIndex = (i + 32) * 2;
-
-				float leftSample = resampledData[dataIndex];
-				float rightSample = resampledData[dataIndex + 1];
-
-				std::int8_t leftInt8 = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(leftSample * 127.0f)), -128, 127));
-				std::int8_t rightInt8 = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(rightSample * 127.0f)), -128, 127));
-
-				const std::int32_t packetIndex = i * 2;
-				packet2[packetIndex] = leftInt8;
-				packet2[packetIndex + 1] = rightInt8;
-			}
-
-			// Convert to uint8 and enqueue
-			std::vector<std::uint8_t> packet1Unsigned(packet1.begin(), packet1.end());
-			std::vector<std::uint8_t> packet2Unsigned(packet2.begin(), packet2.end());
-
-			pData->btPacketQueue.push(packet1Unsigned);
-			pData->btPacketQueue.push(packet2Unsigned);
-		}
+		// Bluetooth: streamed down to 3000Hz, one packet per 32 frames
+		pData->Haptics.process_bt(pSource, framesRead, pData->btPacketQueue);
 	}
 
 	pData->framesPlayed += framesRead;
@@ -322,9 +162,11 @@ void consume_haptics_queue(IGamepadAudioHaptics* AudioHaptics, audio_callback_da
 {
 	if (callbackData.bIsWireless)
 	{
+		haptic_bt_packet Packet;
 		std::vector<std::uint8_t> packet;
-		while (callbackData.btPacketQueue.pop(packet))
+		while (callbackData.btPacketQueue.try_pop(Packet))
 		{
+			packet.assign(Packet.Data, Packet.Data + haptic_bt_packet::kBytes);
 			AudioHaptics->AudioHapticUpdate(packet);
 		}
 	}
@@ -333,13 +175,13 @@ void consume_haptics_queue(IGamepadAudioHaptics* AudioHaptics, audio_callback_da
 		std::vector<std::int16_t> allSamples;
 		allSamples.reserve(2048 * 2);
 
-		std::vector<std::int16_t> stereoSample;
-		while (callbackData.usbSampleQueue.pop(stereoSample))
+		haptic_usb_frame Frames[512];
+		while (const std::size_t Count = callbackData.usbSampleQueue.pop(Frames, 512))
 		{
-			if (stereoSample.size() >= 2)
+			for (std::size_t i = 0; i < Count; ++i)
 			{
-				allSamples.push_back(stereoSample[0]);
-				allSamples.push_back(stereoSample[1]);
+				allSamples.push_back(Frames[i].Left);
+				allSamples.push_back(Frames[i].Right);
 			}
 		}
 
@@ -348,6 +190,7 @@ void consume_haptics_queue(IGamepadAudioHaptics* AudioHaptics, audio_callback_da
 			AudioHaptics->AudioHapticUpdate(allSamples);
 		}
 	}
+	test_utils::submit_io();
 }
 
 // ============================================================================
@@ -356,10 +199,11 @@ void consume_haptics_queue(IGamepadAudioHaptics* AudioHaptics, audio_callback_da
 class gamepad_audio_worker
 {
 public:
-	gamepad_audio_worker(ISonyGamepad* InGamepad, const std::string& InWavPath, bool InUseSystemAudio)
+	gamepad_audio_worker(ISonyGamepad* InGamepad, const std::string& InWavPath, bool InUseSystemAudio, const haptic_asset* InAsset = nullptr)
 	    : Gamepad(InGamepad)
 	    , WavFilePath(InWavPath)
 	    , bUseSystemAudio(InUseSystemAudio)
+	    , Asset(InAsset)
 	{
 		bFinished.store(false);
 	}
@@ -417,10 +261,17 @@ private:
 			}
 		}
 
+		if (Asset)
+		{
+			play_asset(AudioHaptics, Context ? Context->DeviceType : EDSDeviceType::DualSense, bIsWireless);
+			finish();
+			return;
+		}
+
 #if GAMEPAD_CORE_HAS_AUDIO
 		ma_decoder decoder;
-		ma_uint64 totalFrames = 0;
 #endif
+		wav_mapped_source Wav;
 		bool bDecoderInitialized = false;
 
 		if (!bUseSystemAudio)
@@ -436,19 +287,28 @@ private:
 				}
 			}
 
-#if GAMEPAD_CORE_HAS_AUDIO
-			ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, 2, 48000);
-			if (ma_decoder_init_file(WavFilePath.c_str(), &decoderConfig, &decoder) == MA_SUCCESS)
+			// A WAV at the device rate is played from a mapping; anything else goes through miniaudio,
+			// which converts and resamples.
+			if (Wav.open(WavFilePath) && Wav.format().SampleRate == 48000)
 			{
-				ma_decoder_get_length_in_pcm_frames(&decoder, &totalFrames);
-				bDecoderInitialized = true;
+				std::cout << "[Worker] Streaming mapped WAV: " << Wav.total_frames() << " frames" << (Wav.is_zero_copy() ? ", zero-copy" : "") << std::endl;
 			}
 			else
 			{
-				std::cerr << "[Worker Error] Failed to load WAV file: " << WavFilePath << std::endl;
-				return;
-			}
+				Wav.close();
+#if GAMEPAD_CORE_HAS_AUDIO
+				ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, 2, 48000);
+				if (ma_decoder_init_file(WavFilePath.c_str(), &decoderConfig, &decoder) == MA_SUCCESS)
+				{
+					bDecoderInitialized = true;
+				}
+				else
+				{
+					std::cerr << "[Worker Error] Failed to load WAV file: " << WavFilePath << std::endl;
+					return;
+				}
 #endif
+			}
 		}
 
 		// Setup callback data
@@ -458,8 +318,10 @@ private:
 #else
 		callbackData.pDecoder = nullptr;
 #endif
+		callbackData.pWav = Wav.is_open() ? &Wav : nullptr;
 		callbackData.bIsSystemAudio = bUseSystemAudio;
 		callbackData.bIsWireless = bIsWireless;
+		callbackData.Haptics = haptic_processor(haptic_processor_config::for_device(Context ? Context->DeviceType : EDSDeviceType::DualSense));
 
 		// Initialize playback device
 #if GAMEPAD_CORE_HAS_AUDIO
@@ -508,6 +370,7 @@ private:
 		// Main loop for this controller
 		while (!callbackData.bFinished && !bFinished.load() && Gamepad->IsConnected())
 		{
+			Wav.read_ahead();
 			consume_haptics_queue(AudioHaptics, callbackData);
 			std::this_thread::sleep_for(std::chrono::milliseconds(10));
 		}
@@ -521,6 +384,47 @@ private:
 		}
 #endif
 
+		finish();
+	}
+
+	// Pre-rendered haptics: no decoder, audio device or DSP, the stored packets go straight to
+	// AudioHapticUpdate at their native rate.
+	void play_asset(IGamepadAudioHaptics* AudioHaptics, EDSDeviceType DeviceType, bool bIsWireless)
+	{
+		const haptic_asset_transport Transport = bIsWireless ? haptic_asset_transport::Bluetooth : haptic_asset_transport::Usb;
+		const haptic_asset_stream* Stream = Asset->find(DeviceType, Transport);
+		if (!Stream)
+		{
+			std::cerr << "[Worker Error] Asset has no " << (bIsWireless ? "Bluetooth" : "USB") << " stream for this controller." << std::endl;
+			return;
+		}
+		std::cout << "[Worker] Playing pre-rendered asset: " << Stream->units() << (bIsWireless ? " packets" : " frames") << std::endl;
+
+		haptic_asset_player Player(*Stream);
+		std::vector<std::uint8_t> Packet;
+		std::vector<std::int16_t> Samples;
+		const auto Start = std::chrono::steady_clock::now();
+		while (!Player.finished() && !bFinished.load() && Gamepad->IsConnected())
+		{
+			const double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+			if (bIsWireless)
+			{
+				while (Player.pop_due_packet(Elapsed, Packet))
+				{
+					AudioHaptics->AudioHapticUpdate(Packet);
+				}
+			}
+			else if (Player.pop_due_frames(Elapsed, Samples) > 0)
+			{
+				AudioHaptics->AudioHapticUpdate(Samples);
+			}
+			test_utils::submit_io();
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	void finish()
+	{
 		if (Gamepad->IsConnected())
 		{
 			Gamepad->SetLightbar({0, 255, 0});
@@ -534,6 +438,7 @@ private:
 	ISonyGamepad* Gamepad;
 	std::string WavFilePath;
 	bool bUseSystemAudio;
+	const haptic_asset* Asset;
 	std::atomic<bool> bFinished;
 	std::thread WorkerThread;
 };
@@ -562,7 +467,7 @@ void print_help()
 	std::cout << "\n=======================================================" << std::endl;
 	std::cout << "        AUDIO HAPTICS INTEGRATION TEST                 " << std::endl;
 	std::cout << "=======================================================" << std::endl;
-	std::cout << " Usage: AudioHapticsTest <wav_file_path>" << std::endl;
+	std::cout << " Usage: AudioHapticsTest <wav_file_path | asset.ghap>" << std::endl;
 	std::cout << "" << std::endl;
 	std::cout << " This test plays a WAV file on your speakers" << std::endl;
 	std::cout << " and simultaneously sends haptic feedback to" << std::endl;
@@ -571,6 +476,7 @@ void print_help()
 	std::cout << " Supports both USB and Bluetooth!" << std::endl;
 	std::cout << " - USB: 48kHz haptics via audio device" << std::endl;
 	std::cout << " - Bluetooth: 3000Hz haptics via HID" << std::endl;
+	std::cout << " .ghap assets from haptic-asset-converter play without DSP." << std::endl;
 	std::cout << "=======================================================" << std::endl;
 }
 
@@ -601,11 +507,14 @@ int main(int argc, char* argv[])
 
 	std::cout << "[System] Audio Haptics Integration Test" << std::endl;
 
-#if GAMEPAD_CORE_HAS_AUDIO
-	ma_decoder decoder;
-	ma_uint64 totalFrames = 0;
-#endif
+	// The audio worker and the main loop both write to the controller; let one thread own the link.
+	if (test_utils::enable_async_writer())
+	{
+		std::cout << "[System] HID writes go through the async writer thread." << std::endl;
+	}
 
+	haptic_asset Asset;
+	bool bAsset = false;
 	if (!bUseSystemAudio)
 	{
 		fs::path p(WavFilePath);
@@ -619,29 +528,51 @@ int main(int argc, char* argv[])
 			}
 		}
 
-		std::cout << "[System] Loading WAV file: " << WavFilePath << std::endl;
-
-#if GAMEPAD_CORE_HAS_AUDIO
-		// Initialize decoder (output as float, stereo, 48kHz)
-		ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, 2, 48000);
-
-		if (ma_decoder_init_file(WavFilePath.c_str(), &decoderConfig, &decoder) != MA_SUCCESS)
+		if (fs::path(WavFilePath).extension() == ".ghap")
 		{
-			std::cerr << "[Error] Failed to load WAV file: " << WavFilePath << std::endl;
-			return 1;
+			std::string Error;
+			if (!Asset.load(WavFilePath, Error))
+			{
+				std::cerr << "[Error] Failed to load haptic asset: " << WavFilePath << " (" << Error << ")" << std::endl;
+				return 1;
+			}
+			bAsset = true;
+			std::cout << "[System] Loaded pre-rendered haptic asset: " << Asset.Streams.size() << " streams, "
+			          << static_cast<double>(Asset.SourceFrames) / std::max(Asset.SourceSampleRate, 1u) << " seconds" << std::endl;
 		}
+	}
 
-		ma_decoder_get_length_in_pcm_frames(&decoder, &totalFrames);
+	if (!bUseSystemAudio && !bAsset)
+	{
+		std::cout << "[System] Loading WAV file: " << WavFilePath << std::endl;
 
-		std::cout << "[WavReader] Loaded WAV file successfully:" << std::endl;
-		std::cout << "  - Sample Rate: " << decoder.outputSampleRate << " Hz" << std::endl;
-		std::cout << "  - Channels: " << decoder.outputChannels << std::endl;
-		std::cout << "  - Total Frames: " << totalFrames << std::endl;
-		std::cout << "  - Duration: " << (static_cast<float>(totalFrames) / decoder.outputSampleRate) << " seconds" << std::endl;
-		ma_decoder_uninit(&decoder);
+		// The length comes from the header; nothing is decoded here.
+		wav_mapped_source Wav;
+		if (Wav.open(WavFilePath))
+		{
+			std::cout << "[WavReader] Loaded WAV file successfully:" << std::endl;
+			std::cout << "  - Sample Rate: " << Wav.format().SampleRate << " Hz" << std::endl;
+			std::cout << "  - Channels: " << Wav.format().Channels << std::endl;
+			std::cout << "  - Total Frames: " << Wav.total_frames() << std::endl;
+			std::cout << "  - Duration: " << Wav.duration_seconds() << " seconds" << std::endl;
+		}
+		else
+		{
+#if GAMEPAD_CORE_HAS_AUDIO
+			// Not a WAV this can map; the workers will decode it with miniaudio.
+			ma_decoder decoder;
+			ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, 2, 48000);
+			if (ma_decoder_init_file(WavFilePath.c_str(), &decoderConfig, &decoder) != MA_SUCCESS)
+			{
+				std::cerr << "[Error] Failed to load WAV file: " << WavFilePath << " (" << Wav.error() << ")" << std::endl;
+				return 1;
+			}
+			std::cout << "[WavReader] " << Wav.error() << "; decoding with miniaudio." << std::endl;
+			ma_decoder_uninit(&decoder);
 #else
-		std::cout << "[System] Audio support disabled. WAV playback not available." << std::endl;
+			std::cout << "[System] Audio support disabled. WAV playback not available." << std::endl;
 #endif
+		}
 	}
 	else
 	{
@@ -650,11 +581,6 @@ int main(int argc, char* argv[])
 
 	// Initialize Hardware Layer
 	std::cout << "[System] Initializing Hardware Layer..." << std::endl;
-#if _WIN32
-	using platform_hardware = windows_platform::windows_hardware;
-#else
-	using platform_hardware = linux_platform::linux_hardware;
-#endif
 	auto HardwareImpl = std::make_unique<platform_hardware>();
 	IPlatformHardwareInfo::SetInstance(std::move(HardwareImpl));
 
@@ -665,11 +591,12 @@ int main(int argc, char* argv[])
 	std::cout << "[System] Press Ctrl+C to stop." << std::endl;
 
 	std::unordered_map<int32_t, std::unique_ptr<gamepad_audio_worker>> ActiveWorkers;
+	test_utils::frame_clock FrameClock;
 
 	while (true)
 	{
 		std::this_thread::sleep_for(std::chrono::milliseconds(16));
-		float DeltaTime = 0.016f;
+		const float DeltaTime = FrameClock.tick();
 
 		Registry->PlugAndPlay(DeltaTime);
 
@@ -699,7 +626,7 @@ int main(int argc, char* argv[])
 					}
 
 					std::cout << "[System] Creating worker for GamepadId: " << GamepadId << std::endl;
-					auto Worker = std::make_unique<gamepad_audio_worker>(Gamepad, WavFilePath, bUseSystemAudio);
+					auto Worker = std::make_unique<gamepad_audio_worker>(Gamepad, WavFilePath, bUseSystemAudio, bAsset ? &Asset : nullptr);
 					Worker->start();
 					ActiveWorkers[GamepadId] = std::move(Worker);
 				}
@@ -728,6 +655,9 @@ int main(int argc, char* argv[])
 			}
 		}
 
+		// Outputs the workers marked dirty go out from here, never from their own threads.
+		test_utils::end_tick();
+
 #ifdef AUTOMATED_TESTS
 		static auto StartTime = std::chrono::steady_clock::now();
 		auto Now = std::chrono::steady_clock::now();
@@ -15,7 +15,6 @@
 #include <memory>
 #include <mutex>
 #include "GCore/Utils/SoDefines.h"
-#include <queue>
 #include <thread>
 #include <vector>
 namespace fs = std::filesystem;
@@ -30,51 +29,8 @@ namespace fs = std::filesystem;
 #include "GCore/Types/Structs/Context/DeviceContext.h"
 #include "GImplementations/Utils/GamepadAudio.h"
 #include "test_utils.h"
-
-// ============================================================================
-// Audio Haptics Constants (Based on AudioHapticsListener)
-// ============================================================================
-constexpr float kLowPassAlpha = 1.0f;
-constexpr float kOneMinusAlpha = 1.0f - kLowPassAlpha;
-
-constexpr float kLowPassAlphaBt = 1.0f;
-constexpr float kOneMinusAlphaBt = 1.0f - kLowPassAlphaBt;
-
-// ============================================================================
-// Thread-safe queue for audio packets
-// ============================================================================
-template<typename T>
-class thread_safe_queue
-{
-public:
-	void push(const T& item)
-	{
-		gc_lock::lock_guard<gc_lock::mutex> lock(mMutex);
-		mQueue.push(item);
-	}
-
-	bool pop(T& item)
-	{
-		gc_lock::lock_guard<gc_lock::mutex> lock(mMutex);
-		if (mQueue.empty())
-		{
-			return false;
-		}
-		item = mQueue.front();
-		mQueue.pop();
-		return true;
-	}
-
-	bool empty()
-	{
-		gc_lock::lock_guard<gc_lock::mutex> lock(mMutex);
-		return mQueue.empty();
-	}
-
-private:
-	std::queue<T> mQueue;
-	gc_lock::mutex mMutex;
-};
+#include "Audio/haptic_processor.h"
+#include "Audio/wav_mapped_source.h"
 
 // ============================================================================
 // Global state for audio callback
@@ -86,23 +42,25 @@ struct audio_callback_data
 #else
 	void* pDecoder = nullptr;
 #endif
+	// Mapped WAV played in place of pDecoder when the file is a WAV at the device rate.
+	wav_mapped_source* pWav = nullptr;
 	bool bIsSystemAudio = false;
-	float LowPassStateLeft = 0.0f;
-	float LowPassStateRight = 0.0f;
 	std::atomic<bool> bFinished{false};
 	std::atomic<uint64_t> framesPlayed{0};
 	bool bIsWireless = false;
 
-	// Queues for haptics (like AudioHapticsListener)
-	thread_safe_queue<std::vector<uint8_t>> btPacketQueue;
-	thread_safe_queue<std::vector<int16_t>> usbSampleQueue;
+	// Filter and resampler state and the packet being filled live here, preallocated. The worker
+	// replaces it with one filtered for the connected controller before the device starts.
+	haptic_processor Haptics;
 
-	// Accumulator for Bluetooth - need 1024 frames to produce 64 resampled frames
-	std::vector<float> btAccumulator;
-	gc_lock::mutex btAccumulatorMutex;
+	// Wait-free rings: the audio callback must never block on the consumer.
+	haptic_bt_ring btPacketQueue;
+	haptic_usb_ring usbSampleQueue;
 };
 
-// Audio callback - plays audio on speakers and queues haptics data
+// Audio callback - plays audio on speakers and queues haptics data.
+// Runs on the realtime thread: haptics are computed straight from the device buffers and
+// nothing here allocates or locks.
 #if GAMEPAD_CORE_HAS_AUDIO
 void audio_data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
 {
@@ -112,7 +70,7 @@ void audio_data_callback(ma_device* pDevice, void* pOutput, const void* pInput,
 		return;
 	}
 
-	std::vector<float> tempBuffer(frameCount * 2);
+	const float* pSource = nullptr;
 	ma_uint64 framesRead = 0;
 
 	if (pData->bIsSystemAudio)
@@ -122,8 +80,7 @@ void audio_data_callback(ma_device* pDevice, void* pOutput, const void* pInput,
 			return;
 		}
 
-		const float* pInputFloat = static_cast<const float*>(pInput);
-		std::memcpy(tempBuffer.data(), pInputFloat, frameCount * 2 * sizeof(float));
+		pSource = static_cast<const float*>(pInput);
 		framesRead = frameCount;
 
 		if (pOutput)
@@ -131,9 +88,33 @@ void audio_data_callback(ma_device* pDevice, void* pOutput, const void* pInput,
 			std::memcpy(pOutput, pInput, frameCount * 2 * sizeof(float));
 		}
 	}
+	else if (pData->pWav && pOutput)
+	{
+		// Frames come straight from the mapping when the file is float stereo, otherwise they are
+		// converted into the device buffer; haptics read them wherever they are.
+		auto* pOutputFloat = static_cast<float*>(pOutput);
+		std::size_t Frames = 0;
+		const float* pFrames = pData->pWav->read_f32_stereo(pOutputFloat, frameCount, Frames);
+		if (Frames == 0)
+		{
+			pData->bFinished = true;
+			std::memset(pOutput, 0, frameCount * 2 * sizeof(float));
+			return;
+		}
+		if (pFrames != pOutputFloat)
+		{
+			std::memcpy(pOutputFloat, pFrames, Frames * 2 * sizeof(float));
+		}
+		if (Frames < frameCount)
+		{
+			std::memset(&pOutputFloat[Frames * 2], 0, (frameCount - Frames) * 2 * sizeof(float));
+		}
+		pSource = pFrames;
+		framesRead = Frames;
+	}
 	else
 	{
-		if (!pData->pDecoder)
+		if (!pData->pDecoder || !pOutput)
 		{
 			if (pOutput)
 			{
@@ -142,144 +123,33 @@ void audio_data_callback(ma_device* pDevice, void* pOutput, const void* pInput,
 			return;
 		}
 
-		ma_result result = ma_decoder_read_pcm_frames(pData->pDecoder, tempBuffer.data(), frameCount, &framesRead);
+		// Decode straight into the device buffer (f32 stereo at 48kHz) and read haptics from there.
+		auto* pOutputFloat = static_cast<float*>(pOutput);
+		ma_result result = ma_decoder_read_pcm_frames(pData->pDecoder, pOutputFloat, frameCount, &framesRead);
 
 		if (result != MA_SUCCESS || framesRead == 0)
 		{
 			pData->bFinished = true;
-			if (pOutput)
-			{
-				std::memset(pOutput, 0, frameCount * pDevice->playback.channels * ma_get_bytes_per_sample(pDevice->playback.format));
-			}
+			std::memset(pOutput, 0, frameCount * pDevice->playback.channels * ma_get_bytes_per_sample(pDevice->playback.format));
 			return;
 		}
 
-		if (pOutput)
+		if (framesRead < frameCount)
 		{
-			auto* pOutputFloat = static_cast<float*>(pOutput);
-			std::memcpy(pOutputFloat, tempBuffer.data(), framesRead * 2 * sizeof(float));
-
-			if (framesRead < frameCount)
-			{
-				std::memset(&pOutputFloat[framesRead * 2], 0, (frameCount - framesRead) * 2 * sizeof(float));
-			}
+			std::memset(&pOutputFloat[framesRead * 2], 0, (frameCount - framesRead) * 2 * sizeof(float));
 		}
+		pSource = pOutputFloat;
 	}
 
 	if (!pData->bIsWireless)
 	{
-		for (ma_uint64 i = 0; i < framesRead; ++i)
-		{
-			float inLeft = tempBuffer[i * 2];
-			float inRight = tempBuffer[i * 2 + 1];
-
-			pData->LowPassStateLeft = kOneMinusAlpha * inLeft + kLowPassAlpha * pData->LowPassStateLeft;
-			pData->LowPassStateRight = kOneMinusAlpha * inRight + kLowPassAlpha * pData->LowPassStateRight;
-
-			float outLeft = std::clamp(inLeft - pData->LowPassStateLeft, -1.0f, 1.0f);
-			float outRight = std::clamp(inRight - pData->LowPassStateRight, -1.0f, 1.0f);
-
-			std::vector<int16_t> stereoSample = {
-			    static_cast<int16_t>(outLeft * 32767.0f),
-			    static_cast<int16_t>(outRight * 32767.0f)};
-			pData->usbSampleQueue.push(stereoSample);
-		}
+		// USB: 16-bit stereo frames for the controller's audio interface
+		pData->Haptics.process_usb(pSource, framesRead, pData->usbSampleQueue);
 	}
 	else
 	{
-		for (ma_uint64 i = 0; i < framesRead; ++i)
-		{
-			pData->btAccumulator.push_back(tempBuffer[i * 2]);     // Left
-			pData->btAccumulator.push_back(tempBuffer[i * 2 + 1]); // Right
-		}
-
-		const size_t requiredSamples = 1024 * 2;
-
-		while (true)
-		{
-			std::vector<float> framesToProcess;
-
-			{
-  		gc_lock::lock_guard<gc_lock::mutex> lock(pData->btAccumulatorMutex);
-				if (pData->btAccumulator.size() < requiredSamples)
-				{
-					break;
-				}
-
-				framesToProcess.assign(pData->btAccumulator.begin(), pData->btAccumulator.begin() + requiredSamples);
-				pData->btAccumulator.erase(pData->btAccumulator.begin(), pData->btAccumulator.begin() + requiredSamples);
-			}
-
-			const float ratio = 3000.0f / 48000.0f;
-			const std::int32_t numInputFrames = 1024;
-
-			std::vector<float> resampledData(128, 0.0f);
-
-			for (std::int32_t outFrame = 0; outFrame < 64; ++outFrame)
-			{
-				float srcPos = static_cast<float>(outFrame) / ratio;
-				std::int32_t srcIndex = static_cast<std::int32_t>(srcPos);
-				float frac = srcPos - static_cast<float>(srcIndex);
-
-				if (srcIndex >= numInputFrames - 1)
-				{
-					srcIndex = numInputFrames - 2;
-					frac = 1.0f;
-				}
-				if (srcIndex < 0)
-				{
-					srcIndex = 0;
-				}
-
-				float left0 = framesToProcess[srcIndex * 2];
-				float left1 = framesToProcess[(srcIndex + 1) * 2];
-				float right0 = framesToProcess[srcIndex * 2 + 1];
-				float right1 = framesToProcess[(srcIndex + 1) * 2 + 1];
-
-				resampledData[outFrame * 2] = left0 + frac * (left1 - left0);
-				resampledData[outFrame * 2 + 1] = right0 + frac * (right1 - right0);
-			}
-
-			for (std::int32_t i = 0; i < 64; ++i)
-			{
-				const std::int32_t dataIndex = i * 2;
-
-				float inLeft = resampledData[dataIndex];
-				float inRight = resampledData[dataIndex + 1];
-
-				pData->LowPassStateLeft = kOneMinusAlphaBt * inLeft + kLowPassAlphaBt * pData->LowPassStateLeft;
-				pData->LowPassStateRight = kOneMinusAlphaBt * inRight + kLowPassAlphaBt * pData->LowPassStateRight;
-
-				resampledData[dataIndex] = inLeft - pData->LowPassStateLeft;
-				resampledData[dataIndex + 1] = inRight - pData->LowPassStateRight;
-			}
-
-			std::vector<std::int8_t> packet1(64, 0);
-			for (std::int32_t i = 0; i < 32; ++i)
-			{
-				const std::int32_t dataIndex = i * 2;
-				float leftSample = resampledData[dataIndex];
-				float rightSample = resampledData[dataIndex + 1];
-				packet1[dataIndex] = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(leftSample * 127.0f)), -128, 127));
-				packet1[dataIndex + 1] = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(rightSample * 127.0f)), -128, 127));
-			}
-
-			std::vector<std::int8_t> packet2(64, 0);
-			for (std::int32_t i = 0; i < 32; ++i)
-			{
-				const std::int32_t dataIndex = (i + 32) * 2;
-				float leftSample = resampledData[dataIndex];
-				float rightSample = resampledData[dataIndex + 1];
-				packet2[i * 2] = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(leftSample * 127.0f)), -128, 127));
-				packet2[i * 2 + 1] = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::round(rightSample * 127.0f)), -128, 127));
-			}
-
-			std::vector<std::uint8_t> packet1Unsigned(packet1.begin(), packet1.end());
-			std::vector<std::uint8_t> packet2Unsigned(packet2.begin(), packet2.end());
-
-			pData->btPacketQueue.push(packet1Unsigned);
-			pData->btPacketQueue.push(packet2Unsigned);
-		}
+		// Bluetooth: streamed down to 3000Hz, one packet per 32 frames
+		pData->Haptics.process_bt(pSource, framesRead, pData->btPacketQueue);
 	}
 
 	pData->framesPlayed += framesRead;
@@ -290,9 +160,11 @@ void consume_haptics_queue(IGamepadAudioHaptics* AudioHaptics, audio_callback_da
 {
 	if (callbackData.bIsWireless)
 	{
+		haptic_bt_packet Packet;
 		std::vector<std::uint8_t> packet;
-		while (callbackData.btPacketQueue.pop(packet))
+		while (callbackData.btPacketQueue.try_pop(Packet))
 		{
+			packet.assign(Packet.Data, Packet.Data + haptic_bt_packet::kBytes);
 			AudioHaptics->AudioHapticUpdate(packet);
 		}
 	}
@@ -301,13 +173,13 @@ void consume_haptics_queue(IGamepadAudioHaptics* AudioHaptics, audio_callback_da
 		std::vector<std::int16_t> allSamples;
 		allSamples.reserve(2048 * 2);
 
-		std::vector<int16_t> stereoSample;
-		while (callbackData.usbSampleQueue.pop(stereoSample))
+		haptic_usb_frame Frames[512];
+		while (const std::size_t Count = callbackData.usbSampleQueue.pop(Frames, 512))
 		{
-			if (stereoSample.size() >= 2)
+			for (std::size_t i = 0; i < Count; ++i)
 			{
-				allSamples.push_back(stereoSample[0]);
-				allSamples.push_back(stereoSample[1]);
+				allSamples.push_back(Frames[i].Left);
+				allSamples.push_back(Frames[i].Right);
 			}
 		}
 
@@ -316,6 +188,7 @@ void consume_haptics_queue(IGamepadAudioHaptics* AudioHaptics, audio_callback_da
 			AudioHaptics->AudioHapticUpdate(allSamples);
 		}
 	}
+	test_utils::submit_io();
 }
 
 class gamepad_audio_worker
@@ -373,6 +246,7 @@ private:
 #if GAMEPAD_CORE_HAS_AUDIO
 		ma_decoder decoder;
 #endif
+		wav_mapped_source Wav;
 		bool bDecoderInitialized = false;
 
 		if (!bUseSystemAudio)
@@ -388,18 +262,28 @@ private:
 				}
 			}
 
-#if GAMEPAD_CORE_HAS_AUDIO
-			ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, 2, 48000);
-			if (ma_decoder_init_file(WavFilePath.c_str(), &decoderConfig, &decoder) == MA_SUCCESS)
+			// A WAV at the device rate is played from a mapping; anything else goes through miniaudio,
+			// which converts and resamples.
+			if (Wav.open(WavFilePath) && Wav.format().SampleRate == 48000)
 			{
-				bDecoderInitialized = true;
+				std::cout << "[Worker] Streaming mapped WAV: " << Wav.total_frames() << " frames" << (Wav.is_zero_copy() ? ", zero-copy" : "") << std::endl;
 			}
 			else
 			{
-				std::cerr << "[Worker Error] Failed to load WAV file: " << WavFilePath << std::endl;
-				return;
-			}
+				Wav.close();
+#if GAMEPAD_CORE_HAS_AUDIO
+				ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, 2, 48000);
+				if (ma_decoder_init_file(WavFilePath.c_str(), &decoderConfig, &decoder) == MA_SUCCESS)
+				{
+					bDecoderInitialized = true;
+				}
+				else
+				{
+					std::cerr << "[Worker Error] Failed to load WAV file: " << WavFilePath << std::endl;
+					return;
+				}
 #endif
+			}
 		}
 
 		audio_callback_data callbackData;
@@ -408,8 +292,10 @@ private:
 #else
 		callbackData.pDecoder = nullptr;
 #endif
+		callbackData.pWav = Wav.is_open() ? &Wav : nullptr;
 		callbackData.bIsSystemAudio = bUseSystemAudio;
 		callbackData.bIsWireless = bIsWireless;
+		callbackData.Haptics = haptic_processor(haptic_processor_config::for_device(Context ? Context->DeviceType : EDSDeviceType::DualSense));
 
 #if GAMEPAD_CORE_HAS_AUDIO
 		ma_device_config deviceConfig;
@@ -454,6 +340,7 @@ private:
 
 		while (!callbackData.bFinished && !bFinished.load() && Gamepad->IsConnected())
 		{
+			Wav.read_ahead();
 			consume_haptics_queue(AudioHaptics, callbackData);
 			std::this_thread::sleep_for(std::chrono::milliseconds(10));
 		}
@@ -528,21 +415,23 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	// Every worker and the main loop write to the controllers; let one thread own the links.
+	if (test_utils::enable_async_writer())
+	{
+		std::cout << "[System] HID writes go through the async writer thread." << std::endl;
+	}
+
 	std::cout << "[System] Initializing Hardware..." << std::endl;
-#if _WIN32
-	using platform_hardware = windows_platform::windows_hardware;
-#else
-	using platform_hardware = linux_platform::linux_hardware;
-#endif
 	IPlatformHardwareInfo::SetInstance(std::make_unique<platform_hardware>());
 	auto Registry = std::make_unique<audio_test_device_registry>();
 
 	std::unordered_map<uint32_t, std::unique_ptr<gamepad_audio_worker>> ActiveWorkers;
+	test_utils::frame_clock FrameClock;
 
 	while (true)
 	{
 		std::this_thread::sleep_for(std::chrono::milliseconds(16));
-		Registry->PlugAndPlay(0.016f);
+		Registry->PlugAndPlay(FrameClock.tick());
 
 		{
    gc_lock::lock_guard<gc_lock::mutex> Lock(Registry->Policy.NewGamepadsMutex);
@@ -605,6 +494,9 @@ int main(int argc, char* argv[])
 			}
 		}
 
+		// Outputs the workers marked dirty go out from here, never from their own threads.
+		test_utils::end_tick();
+
 #ifdef AUTOMATED_TESTS
 		static auto StartTime = std::chrono::steady_clock::now();
 		if (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - StartTime).count() >= 30)
@@ -18,6 +18,11 @@ int main(int argc, char* argv[])
 	bool bLogAnalogs = false;
 	bool bLogTouch = false;
 	bool bLogSensors = false;
+	bool bDrain = false;
+	bool bDrainAll = false;
+	bool bAsyncWriter = false;
+	bool bCoalesce = false;
+	bool bCalibrationCache = false;
 
 	for (int i = 1; i < argc; ++i)
 	{
@@ -38,6 +43,26 @@ int main(int argc, char* argv[])
 		{
 			bLogSensors = true;
 		}
+		else if (arg == "--drain")
+		{
+			bDrain = true;
+		}
+		else if (arg == "--drain-all")
+		{
+			bDrainAll = true;
+		}
+		else if (arg == "--async-writer")
+		{
+			bAsyncWriter = true;
+		}
+		else if (arg == "--coalesce")
+		{
+			bCoalesce = true;
+		}
+		else if (arg == "--calibration-cache")
+		{
+			bCalibrationCache = true;
+		}
 	}
 
 	// Default behavior if no flags are provided (keep backward compatibility or minimal log)
@@ -48,6 +73,30 @@ int main(int argc, char* argv[])
 
 	std::cout << "--- Gamepad Input Test ---" << std::endl;
 
+#if defined(__linux__) && !defined(GAMEPAD_CORE_VIRTUAL_HID)
+	if (bDrain || bDrainAll)
+	{
+		// Consume the whole kernel queue every tick so input age stays bounded by one tick.
+		linux_device_config Config = linux_device_info::get_config();
+		Config.ReadMode = bDrainAll ? EReadMode::DrainAll : EReadMode::DrainToLatest;
+		linux_device_info::configure(Config);
+		std::cout << "[Test] Read mode: " << (bDrainAll ? "drain all" : "drain to latest") << std::endl;
+	}
+#endif
+
+	if (bAsyncWriter && test_utils::enable_async_writer())
+	{
+		std::cout << "[Test] Lightbar writes go through the async writer thread." << std::endl;
+	}
+	if (bCoalesce && test_utils::enable_output_coalescing())
+	{
+		std::cout << "[Test] Lightbar writes are coalesced into one report per tick." << std::endl;
+	}
+	if (bCalibrationCache && test_utils::enable_calibration_cache())
+	{
+		std::cout << "[Test] Calibration of known controllers is reused." << std::endl;
+	}
+
 	std::unique_ptr<IPlatformHardwareInfo> Hardware;
 	std::unique_ptr<test_utils::test_device_registry> Registry;
 	test_utils::initialize_test_environment(Hardware, Registry);
@@ -60,6 +109,17 @@ int main(int argc, char* argv[])
 	auto startTime = std::chrono::steady_clock::now();
 #endif
 
+	// Wake up as soon as the controller reports instead of sleeping a whole frame between reads;
+	// hot-plug handling and output feedback still run at the frame rate.
+	if (test_utils::enable_input_reactor())
+	{
+		std::cout << "[Test] Input reactor enabled." << std::endl;
+	}
+	const auto FrameInterval = std::chrono::milliseconds(16);
+	auto NextFrame = std::chrono::steady_clock::now();
+	test_utils::frame_clock InputClock;
+	test_utils::frame_clock PlugAndPlayClock;
+
 	std::cout << "Reading inputs. Press Ctrl+C to stop." << std::endl;
 	std::cout << std::fixed << std::setprecision(3);
 
@@ -80,8 +140,14 @@ int main(int argc, char* argv[])
 			break;
 		}
 #endif
-		float DeltaTime = 0.016f;
-		Registry->PlugAndPlay(DeltaTime);
+		const float DeltaTime = InputClock.tick();
+		const auto FrameNow = std::chrono::steady_clock::now();
+		const bool bFrameDue = FrameNow >= NextFrame;
+		if (bFrameDue)
+		{
+			NextFrame = (FrameNow - NextFrame > FrameInterval) ? FrameNow + FrameInterval : NextFrame + FrameInterval;
+			Registry->PlugAndPlay(PlugAndPlayClock.tick());
+		}
 
 		ISonyGamepad* Gamepad = Registry->GetLibrary(TargetDeviceId);
 
@@ -160,24 +226,43 @@ int main(int argc, char* argv[])
 					          << "Accel: [" << std::setw(6) << Input->Accelerometer.X << ", " << std::setw(6) << Input->Accelerometer.Y << ", " << std::setw(6) << Input->Accelerometer.Z << "] | ";
 				}
 
-				std::cout << std::flush;
-
-				// Keep some original logic for visual feedback on controller
-				if (Input->bCross)
+#if defined(__linux__) && !defined(GAMEPAD_CORE_VIRTUAL_HID)
+				if (bDrain || bDrainAll)
 				{
-					Gamepad->SetLightbar({255, 0, 0});
-					Gamepad->UpdateOutput();
+					const linux_device_statistics Stats = linux_device_info::get_statistics(Context);
+					std::cout << "Drained: " << std::setw(2) << Stats.LastBacklog << " Skipped: " << Stats.ReportsSkipped << " | ";
 				}
-				else if (Input->bCircle)
 				{
-					Gamepad->SetLightbar({0, 0, 255});
-					Gamepad->UpdateOutput();
+					const linux_input_timing Timing = linux_device_info::get_timing(Context);
+					const linux_device_statistics Stats = linux_device_info::get_statistics(Context);
+					std::cout << "Seq: " << std::setw(3) << Timing.DeviceSequence << " dT: " << std::setw(5) << Timing.DeviceDeltaUs << "us"
+					          << " Age: " << std::setw(5) << Timing.InputAgeUs << "us Dropped: " << Stats.DroppedReports
+					          << " Open: " << Stats.OpenLatencyUs / 1000 << "ms First input: " << Stats.TimeToFirstInputUs / 1000 << "ms | ";
 				}
-				else if (Input->bTriangle)
+#endif
+
+				std::cout << std::flush;
+
+				// Keep some original logic for visual feedback on controller.
+				// Outputs are refreshed once per frame, not on every input-driven wakeup.
+				if (bFrameDue)
 				{
-					Gamepad->SetVibration(0, 0);
-					Gamepad->SetLightbar({0, 0, 0});
-					Gamepad->UpdateOutput();
+					if (Input->bCross)
+					{
+						Gamepad->SetLightbar({255, 0, 0});
+						Gamepad->UpdateOutput();
+					}
+					else if (Input->bCircle)
+					{
+						Gamepad->SetLightbar({0, 0, 255});
+						Gamepad->UpdateOutput();
+					}
+					else if (Input->bTriangle)
+					{
+						Gamepad->SetVibration(0, 0);
+						Gamepad->SetLightbar({0, 0, 0});
+						Gamepad->UpdateOutput();
+					}
 				}
 			}
 		}
@@ -190,7 +275,8 @@ int main(int argc, char* argv[])
 			}
 		}
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(16));
+		test_utils::end_tick();
+		test_utils::wait_for_input(NextFrame);
 	}
 
 	return 0;
@@ -8,6 +8,7 @@
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <string_view>
 #include <thread>
 
 void print_controls_helper()
@@ -33,8 +34,21 @@ void print_controls_helper()
 	          << std::endl;
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view Arg(argv[i]);
+		if (Arg == "--coalesce" && test_utils::enable_output_coalescing())
+		{
+			std::cout << "[System] Output changes are coalesced into one report per tick." << std::endl;
+		}
+		else if (Arg == "--calibration-cache" && test_utils::enable_calibration_cache())
+		{
+			std::cout << "[System] Calibration of known controllers is reused." << std::endl;
+		}
+	}
+
 	std::cout << "[System] Initializing Hardware Layer..." << std::endl;
 
 	std::unique_ptr<IPlatformHardwareInfo> Hardware;
@@ -57,6 +71,7 @@ int main()
 
 	bool bControllerFound = false;
 	int MaxWaitIterations = 300;
+	test_utils::frame_clock FrameClock;
 
 	while (true)
 	{
@@ -76,7 +91,7 @@ int main()
 		}
 #endif
 		std::this_thread::sleep_for(std::chrono::milliseconds(16));
-		float DeltaTime = 0.016f;
+		const float DeltaTime = FrameClock.tick();
 
 		Registry->PlugAndPlay(DeltaTime);
 		ISonyGamepad* Gamepad = Registry->GetLibrary(TargetDeviceId);
@@ -278,7 +293,15 @@ int main()
 				Gamepad->UpdateOutput();
 			}
 
+#if defined(__linux__) && !defined(GAMEPAD_CORE_VIRTUAL_HID)
+			// The loop re-sends the same state every frame; most of those writes never reach the link.
+			const linux_device_statistics Stats = linux_device_info::get_statistics(Gamepad->GetMutableDeviceContext());
+			printf("\r[%s] Sent: %llu Coalesced: %llu Deferred: %llu Suppressed: %llu Keepalive: %llu", StatusText.c_str(),
+			       (unsigned long long)Stats.OutputsSent, (unsigned long long)Stats.OutputsCoalesced, (unsigned long long)Stats.OutputsDeferred,
+			       (unsigned long long)Stats.OutputsSuppressed, (unsigned long long)Stats.OutputKeepalives);
+#else
 			printf("\r[%s]", StatusText.c_str());
+#endif
 			fflush(stdout);
 		}
 		else
@@ -290,6 +313,8 @@ int main()
 				bWasConnected = false;
 			}
 		}
+
+		test_utils::end_tick();
 	}
 	return 0;
 }
@@ -0,0 +1,199 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Pre-rendered haptic assets: rendered streams against live haptic_processor output,
+// save/load round trips with and without compression, shared payloads, files from newer
+// versions, corrupt and truncated files, and playback pacing. Needs no hardware.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Audio/haptic_asset.h"
+#include "Audio/haptic_processor.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using test_utils::expect;
+
+static std::vector<std::uint8_t> read_file(const std::string& Path)
+{
+	std::ifstream File(Path, std::ios::binary);
+	return std::vector<std::uint8_t>((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+}
+
+static void write_file(const std::string& Path, const std::vector<std::uint8_t>& Bytes)
+{
+	std::ofstream(Path, std::ios::binary).write(reinterpret_cast<const char*>(Bytes.data()), static_cast<std::streamsize>(Bytes.size()));
+}
+
+// Live playback: the processor fed in callback-sized blocks, BT packets collected as they complete.
+static std::vector<std::uint8_t> live_bt(const std::vector<float>& Clip, std::uint32_t SampleRate, EDSDeviceType DeviceType)
+{
+	haptic_processor_config Config = haptic_processor_config::for_device(DeviceType);
+	Config.InputSampleRate = SampleRate;
+	auto Processor = std::make_unique<haptic_processor>(Config);
+	auto Ring = std::make_unique<haptic_bt_ring>();
+	std::vector<std::uint8_t> Out;
+	haptic_bt_packet Packet;
+	const std::size_t Frames = Clip.size() / 2;
+	for (std::size_t First = 0; First < Frames; First += 480)
+	{
+		Processor->process_bt(&Clip[First * 2], std::min<std::size_t>(480, Frames - First), *Ring);
+		while (Ring->try_pop(Packet))
+		{
+			Out.insert(Out.end(), std::begin(Packet.Data), std::end(Packet.Data));
+		}
+	}
+	return Out;
+}
+
+static std::vector<std::int16_t> live_usb(const std::vector<float>& Clip, EDSDeviceType DeviceType)
+{
+	auto Processor = std::make_unique<haptic_processor>(haptic_processor_config::for_device(DeviceType));
+	auto Ring = std::make_unique<haptic_usb_ring>();
+	std::vector<std::int16_t> Out;
+	std::vector<haptic_usb_frame> Frames(480);
+	for (std::size_t First = 0; First < Clip.size() / 2; First += 480)
+	{
+		Processor->process_usb(&Clip[First * 2], std::min<std::size_t>(480, Clip.size() / 2 - First), *Ring);
+		for (std::size_t i = 0, Popped = Ring->pop(Frames.data(), Frames.size()); i < Popped; ++i)
+		{
+			Out.push_back(Frames[i].Left);
+			Out.push_back(Frames[i].Right);
+		}
+	}
+	return Out;
+}
+
+int main()
+{
+	// A 40 Hz burst followed by silence, the shape of most canned effects.
+	constexpr std::uint32_t kRate = 48000;
+	std::vector<float> Clip(kRate / 2 * 2, 0.0f);
+	for (std::size_t i = 0; i < kRate / 10; ++i)
+	{
+		const float Value = 0.8f * static_cast<float>(std::sin(2.0 * 3.14159265358979323846 * 40.0 * static_cast<double>(i) / kRate));
+		Clip[i * 2] = Value;
+		Clip[i * 2 + 1] = -Value;
+	}
+	const std::size_t ClipFrames = Clip.size() / 2;
+
+	// Rendering is live playback, done ahead of time.
+	const haptic_asset_stream Bt = haptic_asset_render(Clip.data(), ClipFrames, kRate, EDSDeviceType::DualSense, haptic_asset_transport::Bluetooth);
+	const std::vector<std::uint8_t> LiveBt = live_bt(Clip, kRate, EDSDeviceType::DualSense);
+	expect(Bt.Payload.size() % haptic_bt_packet::kBytes == 0 && Bt.units() > LiveBt.size() / haptic_bt_packet::kBytes,
+	       "Bluetooth render includes the partial last packet");
+	expect(std::equal(LiveBt.begin(), LiveBt.end(), Bt.Payload.begin()), "Bluetooth render matches live processor packets");
+
+	const haptic_asset_stream Usb = haptic_asset_render(Clip.data(), ClipFrames, kRate, EDSDeviceType::DualSense, haptic_asset_transport::Usb);
+	const std::vector<std::int16_t> LiveUsb = live_usb(Clip, EDSDeviceType::DualSense);
+	bool bUsbMatches = Usb.units() == LiveUsb.size() / 2;
+	for (std::size_t i = 0; bUsbMatches && i < LiveUsb.size(); ++i)
+	{
+		bUsbMatches = static_cast<std::int16_t>(Usb.Payload[i * 2] | Usb.Payload[i * 2 + 1] << 8) == LiveUsb[i];
+	}
+	expect(bUsbMatches, "USB render matches live processor frames");
+	expect(haptic_asset_render(Clip.data(), ClipFrames, 44100, EDSDeviceType::DualSense, haptic_asset_transport::Usb).Payload.empty(),
+	       "USB render refuses rates other than 48 kHz");
+	const haptic_asset_stream Bt44 = haptic_asset_render(Clip.data(), ClipFrames, 44100, EDSDeviceType::DualSense, haptic_asset_transport::Bluetooth);
+	expect(Bt44.units() >= ClipFrames * 3000 / 44100 / 32, "Bluetooth render resamples other rates");
+
+	haptic_asset Asset;
+	Asset.SourceSampleRate = kRate;
+	Asset.SourceFrames = ClipFrames;
+	Asset.Streams.push_back(Bt);
+	Asset.Streams.push_back(Usb);
+	Asset.Streams.push_back(haptic_asset_render(Clip.data(), ClipFrames, kRate, EDSDeviceType::DualSenseEdge, haptic_asset_transport::Bluetooth));
+	Asset.Streams.push_back(haptic_asset_render(Clip.data(), ClipFrames, kRate, EDSDeviceType::DualShock4, haptic_asset_transport::Bluetooth));
+
+	const std::string Plain = (fs::temp_directory_path() / "gamepad_core_plain.ghap").string();
+	const std::string Packed = (fs::temp_directory_path() / "gamepad_core_packed.ghap").string();
+	const std::string Broken = (fs::temp_directory_path() / "gamepad_core_broken.ghap").string();
+	std::string Error;
+	expect(Asset.save(Plain, false, Error) && Asset.save(Packed, true, Error), "saves with and without compression");
+
+	const std::size_t RawBytes = Bt.Payload.size() + Usb.Payload.size() + Asset.Streams[3].Payload.size();
+	expect(Asset.Streams[2].Payload == Bt.Payload && read_file(Plain).size() < RawBytes + 24 + 4 * 32 + 1,
+	       "DualSense and Edge share one payload");
+	expect(read_file(Packed).size() < read_file(Plain).size(), "compression shrinks a clip with silence");
+
+	for (const std::string& Path : {Plain, Packed})
+	{
+		haptic_asset Loaded;
+		bool bSame = Loaded.load(Path, Error) && Loaded.SourceSampleRate == kRate && Loaded.SourceFrames == ClipFrames &&
+		             Loaded.Streams.size() == Asset.Streams.size();
+		for (std::size_t s = 0; bSame && s < Loaded.Streams.size(); ++s)
+		{
+			bSame = Loaded.Streams[s].DeviceType == Asset.Streams[s].DeviceType && Loaded.Streams[s].Transport == Asset.Streams[s].Transport &&
+			        Loaded.Streams[s].Payload == Asset.Streams[s].Payload;
+		}
+		expect(bSame, "round trip of " + fs::path(Path).filename().string());
+		expect(Loaded.find(EDSDeviceType::DualSenseEdge, haptic_asset_transport::Bluetooth) != nullptr &&
+		           Loaded.find(EDSDeviceType::DualShock4, haptic_asset_transport::Usb) == nullptr,
+		       "find by controller and transport");
+	}
+
+	// Files this build must refuse, each with a reason.
+	haptic_asset Rejected;
+	std::vector<std::uint8_t> Bytes = read_file(Plain);
+	Bytes[4] = haptic_asset::kVersion + 1;
+	write_file(Broken, Bytes);
+	expect(!Rejected.load(Broken, Error) && Error.find("newer") != std::string::npos, "rejects a newer format version");
+	Bytes = read_file(Packed);
+	Bytes[Bytes.size() - 1] ^= 0x5A;
+	write_file(Broken, Bytes);
+	expect(!Rejected.load(Broken, Error) && !Error.empty(), "rejects a corrupt payload");
+	Bytes = read_file(Plain);
+	Bytes.resize(Bytes.size() / 2);
+	write_file(Broken, Bytes);
+	expect(!Rejected.load(Broken, Error), "rejects a truncated file");
+	Bytes.resize(40);
+	write_file(Broken, Bytes);
+	expect(!Rejected.load(Broken, Error), "rejects a truncated stream table");
+	expect(!Rejected.load(Broken + ".missing", Error), "reports a missing file");
+
+	// Unknown controllers from a newer converter are skipped, not fatal.
+	Bytes = read_file(Plain);
+	Bytes[24 + 3 * 32] = 0x7F;
+	write_file(Broken, Bytes);
+	expect(Rejected.load(Broken, Error) && Rejected.Streams.size() == 3, "skips streams for unknown controllers");
+
+	// Playback pacing: 93.75 packets/s on Bluetooth, 48000 frames/s on USB.
+	haptic_asset_player BtPlayer(Bt);
+	std::vector<std::uint8_t> Packet;
+	std::size_t Packets = 0;
+	while (BtPlayer.pop_due_packet(0.1, Packet))
+	{
+		++Packets;
+	}
+	expect(Packets == 9 && Packet.size() == haptic_bt_packet::kBytes, "Bluetooth packets are due at 3000 Hz / 32");
+	expect(!BtPlayer.pop_due_packet(0.1, Packet) && BtPlayer.pop_due_packet(0.11, Packet), "no packet before its time");
+	while (BtPlayer.pop_due_packet(1000.0, Packet))
+	{
+	}
+	expect(BtPlayer.finished(), "Bluetooth playback finishes");
+
+	haptic_asset_player UsbPlayer(Usb);
+	std::vector<std::int16_t> Samples;
+	expect(UsbPlayer.pop_due_frames(0.01, Samples) == 480 && Samples.size() == 960 && Samples[2] == LiveUsb[2], "USB frames are due at 48 kHz");
+	expect(UsbPlayer.pop_due_frames(0.01, Samples) == 0 && Samples.empty(), "USB frames are handed out once");
+	expect(UsbPlayer.pop_due_frames(1000.0, Samples) == ClipFrames - 480 && UsbPlayer.finished(), "USB playback finishes");
+	expect(!UsbPlayer.pop_due_packet(1000.0, Packet), "a USB stream yields no Bluetooth packets");
+
+	for (const std::string& File : {Plain, Packed, Broken})
+	{
+		std::error_code Ignored;
+		fs::remove(File, Ignored);
+	}
+
+	return test_utils::finish_checks();
+}
+#endif
@@ -0,0 +1,191 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Frequency response of the haptic biquad presets at the USB and Bluetooth rates,
+// the vectorized cascade against a double-precision reference, channel independence and call-size
+// invariance, and the per-controller filters haptic_processor picks. Needs no hardware.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Audio/haptic_biquad.h"
+#include "Audio/haptic_processor.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using test_utils::expect;
+
+static constexpr double kPi = 3.14159265358979323846;
+
+// Gain in dB of a unit sine through a fresh bank, measured on the left channel after two seconds
+// of settling.
+static double gain_db(const haptic_filter_preset& Preset, float SampleRate, double Frequency)
+{
+	haptic_biquad_bank Bank(Preset, SampleRate);
+	const std::size_t Frames = static_cast<std::size_t>(SampleRate) * 4;
+	std::vector<float> Samples(Frames * 2);
+	for (std::size_t i = 0; i < Frames; ++i)
+	{
+		Samples[i * 2] = static_cast<float>(std::sin(2.0 * kPi * Frequency * static_cast<double>(i) / SampleRate));
+	}
+	Bank.process(Samples.data(), Frames);
+
+	double Energy = 0.0;
+	for (std::size_t i = Frames / 2; i < Frames; ++i)
+	{
+		Energy += static_cast<double>(Samples[i * 2]) * Samples[i * 2];
+	}
+	return 20.0 * std::log10(std::max(std::sqrt(Energy / static_cast<double>(Frames / 2)) / std::sqrt(0.5), 1e-9));
+}
+
+static bool near(double Value, double Expected, double Tolerance)
+{
+	return std::abs(Value - Expected) <= Tolerance;
+}
+
+// Straightforward double-precision cascade of the same RBJ designs, one channel.
+static std::vector<double> reference(const haptic_filter_preset& Preset, double SampleRate, const std::vector<float>& Interleaved, std::size_t Channel)
+{
+	std::vector<double> Signal(Interleaved.size() / 2);
+	for (std::size_t i = 0; i < Signal.size(); ++i)
+	{
+		Signal[i] = Interleaved[i * 2 + Channel];
+	}
+	for (std::size_t s = 0; s < Preset.Count; ++s)
+	{
+		const haptic_filter_stage& Stage = Preset.Stages[s];
+		const double Omega = 2.0 * kPi * Stage.Frequency / SampleRate;
+		const double Alpha = std::sin(Omega) / (2.0 * Stage.Q);
+		const double Cos = std::cos(Omega);
+		double B0 = Alpha, B1 = 0.0, B2 = -Alpha;
+		if (Stage.Kind == haptic_filter_kind::HighPass)
+		{
+			B0 = B2 = (1.0 + Cos) / 2.0;
+			B1 = -(1.0 + Cos);
+		}
+		else if (Stage.Kind == haptic_filter_kind::LowPass)
+		{
+			B0 = B2 = (1.0 - Cos) / 2.0;
+			B1 = 1.0 - Cos;
+		}
+		const double A0 = 1.0 + Alpha;
+		double X1 = 0.0, X2 = 0.0, Y1 = 0.0, Y2 = 0.0;
+		for (double& Sample : Signal)
+		{
+			const double Y = (B0 * Sample + B1 * X1 + B2 * X2 + 2.0 * Cos * Y1 - (1.0 - Alpha) * Y2) / A0;
+			X2 = X1;
+			X1 = Sample;
+			Y2 = Y1;
+			Y1 = Y;
+			Sample = Y;
+		}
+	}
+	return Signal;
+}
+
+int main()
+{
+	std::cout << "Biquad cascade: " << haptic_biquad_bank::simd_path() << std::endl;
+
+	const auto HighPass = haptic_filter_preset::high_pass(30.0f);
+	const auto LowPass = haptic_filter_preset::low_pass(1000.0f);
+	haptic_filter_preset Peak;
+	Peak.Stages[0] = {haptic_filter_kind::BandPass, 200.0f, 2.0f};
+	Peak.Count = 1;
+
+	std::cout << std::fixed << std::setprecision(2);
+	const double HighPassCorner = gain_db(HighPass, 48000.0f, 30.0);
+	const double HighPassStop = gain_db(HighPass, 48000.0f, 3.0);
+	const double HighPassPass = gain_db(HighPass, 48000.0f, 300.0);
+	std::cout << "high-pass 30 Hz @ 48 kHz: 3 Hz " << HighPassStop << " dB, 30 Hz " << HighPassCorner << " dB, 300 Hz " << HighPassPass << " dB" << std::endl;
+	expect(near(HighPassCorner, -3.01, 0.2) && HighPassStop < -35.0 && near(HighPassPass, 0.0, 0.1), "high-pass: -3 dB at the corner, 40 dB/decade below, flat above");
+
+	const double LowPassCorner = gain_db(LowPass, 3000.0f, 1000.0);
+	const double LowPassPass = gain_db(LowPass, 3000.0f, 100.0);
+	const double LowPassStop = gain_db(LowPass, 3000.0f, 1400.0);
+	std::cout << "low-pass 1 kHz @ 3 kHz: 100 Hz " << LowPassPass << " dB, 1 kHz " << LowPassCorner << " dB, 1.4 kHz " << LowPassStop << " dB" << std::endl;
+	expect(near(LowPassCorner, -3.01, 0.2) && near(LowPassPass, 0.0, 0.1) && LowPassStop < -15.0, "low-pass designed for the Bluetooth rate");
+
+	const double PeakCenter = gain_db(Peak, 48000.0f, 200.0);
+	const double PeakSide = gain_db(Peak, 48000.0f, 20.0);
+	std::cout << "band-pass 200 Hz Q 2 @ 48 kHz: 20 Hz " << PeakSide << " dB, 200 Hz " << PeakCenter << " dB" << std::endl;
+	std::cout << std::defaultfloat;
+	expect(near(PeakCenter, 0.0, 0.1) && PeakSide < -20.0, "band-pass peaks at 0 dB on its center");
+
+	// Different noise on each channel, through the four-stage DualSense-style cascade.
+	haptic_filter_preset Cascade = haptic_filter_preset::band_pass(30.0f, 1000.0f);
+	Cascade.Stages[2] = {haptic_filter_kind::BandPass, 160.0f, 0.9f};
+	Cascade.Stages[3] = {haptic_filter_kind::LowPass, 1200.0f, 1.2f};
+	Cascade.Count = 4;
+	std::vector<float> Noise(6000 * 2);
+	std::uint32_t Seed = 12345;
+	for (float& Sample : Noise)
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		Sample = static_cast<float>(Seed >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f;
+	}
+	std::vector<float> Whole = Noise;
+	haptic_biquad_bank WholeBank(Cascade, 3000.0f);
+	WholeBank.process(Whole.data(), Whole.size() / 2);
+
+	double MaxError = 0.0;
+	for (std::size_t Channel = 0; Channel < 2; ++Channel)
+	{
+		const std::vector<double> Expected = reference(Cascade, 3000.0, Noise, Channel);
+		for (std::size_t i = 0; i < Expected.size(); ++i)
+		{
+			MaxError = std::max(MaxError, std::abs(Expected[i] - Whole[i * 2 + Channel]));
+		}
+	}
+	expect(WholeBank.stages() == 4 && MaxError < 1e-4, "cascade matches a double-precision reference on both channels");
+
+	// Silence on the right must stay silence whatever the left does.
+	std::vector<float> LeftOnly = Noise;
+	for (std::size_t i = 0; i < LeftOnly.size(); i += 2)
+	{
+		LeftOnly[i + 1] = 0.0f;
+	}
+	haptic_biquad_bank LeftBank(Cascade, 3000.0f);
+	LeftBank.process(LeftOnly.data(), LeftOnly.size() / 2);
+	bool bIndependent = true;
+	for (std::size_t i = 0; i < LeftOnly.size(); i += 2)
+	{
+		bIndependent = bIndependent && LeftOnly[i] == Whole[i] && LeftOnly[i + 1] == 0.0f;
+	}
+	expect(bIndependent, "channels are filtered independently");
+
+	std::vector<float> Split = Noise;
+	haptic_biquad_bank SplitBank(Cascade, 3000.0f);
+	for (std::size_t First = 0, Count = 1; First < Split.size() / 2; First += Count, Count = Count * 3 % 331 + 1)
+	{
+		Count = std::min(Count, Split.size() / 2 - First);
+		SplitBank.process(&Split[First * 2], Count);
+	}
+	expect(Split == Whole, "output does not depend on call sizes");
+
+	std::vector<float> Untouched = Noise;
+	haptic_biquad_bank Flat(haptic_filter_preset::flat(), 48000.0f);
+	Flat.process(Untouched.data(), Untouched.size() / 2);
+	expect(Flat.empty() && Untouched == Noise, "flat bank leaves samples untouched");
+
+	// The DualSense filters remove a DC offset on USB; DualShock 4 has no audio haptics to filter.
+	std::vector<float> Offset(48000 * 2, 0.5f);
+	auto Processor = std::make_unique<haptic_processor>(haptic_processor_config::for_device(EDSDeviceType::DualSense));
+	auto UsbRing = std::make_unique<haptic_usb_ring>();
+	Processor->process_usb(Offset.data(), 4096, *UsbRing);
+	UsbRing->clear();
+	Processor->process_usb(Offset.data(), 4096, *UsbRing);
+	haptic_usb_frame Last{};
+	while (UsbRing->try_pop(Last))
+	{
+	}
+	expect(std::abs(Last.Left) <= 1 && std::abs(Last.Right) <= 1, "DualSense preset blocks DC on USB");
+	expect(haptic_processor_config::for_device(EDSDeviceType::DualShock4).UsbFilter.Count == 0, "DualShock 4 preset is flat");
+
+	return test_utils::finish_checks();
+}
+#endif
@@ -0,0 +1,123 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Frequency response of the 48 kHz -> 3 kHz Bluetooth haptics path, anti-aliased
+// haptic_fir_decimator against the linear haptic_resampler it replaces. Tones in the haptic band
+// must pass unchanged and tones above 1.5 kHz, which alias back into it, must be stopped. Also
+// checks the vectorized filter against a plain double-precision convolution. Needs no hardware.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Audio/haptic_fir_decimator.h"
+#include "Audio/haptic_resampler.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using test_utils::expect;
+
+static constexpr double kPi = 3.14159265358979323846;
+static constexpr std::size_t kInputRate = 48000;
+
+static std::vector<float> make_sine(double Frequency, std::size_t Frames)
+{
+	std::vector<float> Samples(Frames * 2);
+	for (std::size_t i = 0; i < Frames; ++i)
+	{
+		Samples[i * 2] = static_cast<float>(std::sin(2.0 * kPi * Frequency * static_cast<double>(i) / kInputRate));
+		Samples[i * 2 + 1] = Samples[i * 2];
+	}
+	return Samples;
+}
+
+// Gain in dB of a unit sine after resampling, measured on the left channel past the filter warm-up.
+template<typename FResampler>
+static double gain_db(FResampler& Resampler, double Frequency)
+{
+	const std::vector<float> Input = make_sine(Frequency, kInputRate);
+	std::vector<float> Output(Resampler.max_output(kInputRate) * 2);
+	const std::size_t Frames = Resampler.process(Input.data(), kInputRate, Output.data());
+
+	constexpr std::size_t kWarmup = 64;
+	double Energy = 0.0;
+	for (std::size_t i = kWarmup; i < Frames; ++i)
+	{
+		Energy += static_cast<double>(Output[i * 2]) * Output[i * 2];
+	}
+	const double Rms = std::sqrt(Energy / static_cast<double>(Frames - kWarmup));
+	return 20.0 * std::log10(std::max(Rms / std::sqrt(0.5), 1e-9));
+}
+
+int main()
+{
+	std::cout << "FIR dot product: " << haptic_fir_decimator::simd_path() << std::endl;
+	std::cout << std::setw(10) << "Hz" << std::setw(12) << "linear dB" << std::setw(12) << "fir dB" << std::endl;
+
+	double WorstPassband = 0.0;
+	double QuietestLinearStopband = 0.0;
+	double WorstFirStopband = -200.0;
+	for (const double Frequency : {50.0, 200.0, 500.0, 800.0, 2000.0, 2900.0, 4100.0, 6100.0, 9500.0, 15100.0, 23000.0})
+	{
+		haptic_resampler Linear(kInputRate, 3000);
+		haptic_fir_decimator Fir(kInputRate / 3000);
+		const double LinearGain = gain_db(Linear, Frequency);
+		const double FirGain = gain_db(Fir, Frequency);
+		std::cout << std::fixed << std::setprecision(1) << std::setw(10) << Frequency << std::setw(12) << LinearGain << std::setw(12) << FirGain
+		          << std::defaultfloat << std::endl;
+
+		if (Frequency < 1000.0)
+		{
+			WorstPassband = std::max(WorstPassband, std::abs(FirGain));
+		}
+		else
+		{
+			QuietestLinearStopband = std::min(QuietestLinearStopband, LinearGain);
+			WorstFirStopband = std::max(WorstFirStopband, FirGain);
+		}
+	}
+	expect(WorstPassband < 0.5, "decimator passes 50-800 Hz within 0.5 dB");
+	expect(WorstFirStopband < -80.0, "decimator stops tones that alias into the haptic band by 80 dB");
+	expect(QuietestLinearStopband > -3.0, "linear interpolation aliases the same tones at nearly full level");
+
+	// The vectorized dot product must match a straightforward convolution of the same coefficients.
+	haptic_fir_decimator Fir(16);
+	std::vector<float> Noise(4000 * 2);
+	std::uint32_t Seed = 12345;
+	for (float& Sample : Noise)
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		Sample = static_cast<float>(Seed >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f;
+	}
+	std::vector<float> Output(Fir.max_output(4000) * 2);
+	const std::size_t Frames = Fir.process(Noise.data(), 4000, Output.data());
+	double MaxError = 0.0;
+	for (std::size_t k = 0; k < Frames; ++k)
+	{
+		// Output k is taken right after input frame 16k, over the taps() frames ending there.
+		const std::ptrdiff_t Last = static_cast<std::ptrdiff_t>(k * 16);
+		double Expected = 0.0;
+		for (std::size_t t = 0; t < Fir.taps(); ++t)
+		{
+			const std::ptrdiff_t Frame = Last - static_cast<std::ptrdiff_t>(Fir.taps() - 1 - t);
+			Expected += Frame < 0 ? 0.0 : static_cast<double>(Fir.coefficients()[t]) * Noise[Frame * 2 + 1];
+		}
+		MaxError = std::max(MaxError, std::abs(Expected - Output[k * 2 + 1]));
+	}
+	expect(Frames == 250 && MaxError < 1e-5, "vectorized filter matches a scalar double-precision convolution");
+
+	// Splitting the input must not change anything.
+	haptic_fir_decimator Split(16);
+	std::vector<float> SplitOutput(Output.size());
+	std::size_t SplitFrames = 0;
+	for (std::size_t First = 0, Count = 1; First < 4000; First += Count, Count = Count * 3 % 997 + 1)
+	{
+		Count = std::min<std::size_t>(Count, 4000 - First);
+		SplitFrames += Split.process(&Noise[First * 2], Count, &SplitOutput[SplitFrames * 2]);
+	}
+	expect(SplitFrames == Frames && std::equal(Output.begin(), Output.begin() + Frames * 2, SplitOutput.begin()), "output does not depend on call sizes");
+
+	return test_utils::finish_checks();
+}
+#endif
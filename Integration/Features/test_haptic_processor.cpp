@@ -0,0 +1,168 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Runs haptic_processor the way the audio callback does, with the callback sizes
+// miniaudio backends actually use, and asserts that steady-state processing never touches the
+// heap. Also checks frame counts and sample conversion for USB and Bluetooth, that the Bluetooth
+// resampler is continuous across calls and that clearing the transport ring drops exactly what
+// was queued. Needs no hardware.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Audio/haptic_processor.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+static std::atomic<std::uint64_t> GAllocations{0};
+
+void* operator new(std::size_t Size)
+{
+	GAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* Memory = std::malloc(Size ? Size : 1))
+	{
+		return Memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* Memory) noexcept
+{
+	std::free(Memory);
+}
+
+void operator delete(void* Memory, std::size_t) noexcept
+{
+	std::free(Memory);
+}
+
+using test_utils::expect;
+
+// Period sizes seen from WASAPI, PulseAudio and ALSA at 48 kHz, including odd ones.
+static constexpr std::size_t kCallbackFrames[] = {480, 441, 1024, 128, 960, 4096, 37, 512};
+static constexpr std::size_t kCallbacks = 2000;
+
+int main()
+{
+	// Input with a constant 0.5 on the left and -0.25 on the right, larger than any callback.
+	std::vector<float> Input(4096 * 2);
+	for (std::size_t i = 0; i < Input.size(); i += 2)
+	{
+		Input[i] = 0.5f;
+		Input[i + 1] = -0.25f;
+	}
+
+	auto Processor = std::make_unique<haptic_processor>();
+	auto UsbRing = std::make_unique<haptic_usb_ring>();
+	auto BtRing = std::make_unique<haptic_bt_ring>();
+	haptic_usb_frame UsbFrames[512];
+	haptic_bt_packet Packet;
+
+	std::uint64_t UsbIn = 0;
+	std::uint64_t UsbOut = 0;
+	bool bUsbValues = true;
+	const std::uint64_t UsbAllocationsBefore = GAllocations.load(std::memory_order_relaxed);
+	for (std::size_t i = 0; i < kCallbacks; ++i)
+	{
+		const std::size_t Frames = kCallbackFrames[i % std::size(kCallbackFrames)];
+		Processor->process_usb(Input.data(), Frames, *UsbRing);
+		UsbIn += Frames;
+		while (const std::size_t Count = UsbRing->pop(UsbFrames, 512))
+		{
+			UsbOut += Count;
+			bUsbValues = bUsbValues && UsbFrames[0].Left == 16384 && UsbFrames[Count - 1].Right == -8192;
+		}
+	}
+	const std::uint64_t UsbAllocations = GAllocations.load(std::memory_order_relaxed) - UsbAllocationsBefore;
+	expect(UsbAllocations == 0, "USB processing does not allocate");
+	expect(UsbOut == UsbIn && UsbRing->dropped() == 0, "USB emits one frame per input frame");
+	expect(bUsbValues, "USB frames are scaled and rounded to int16");
+
+	Processor->reset();
+	std::uint64_t BtIn = 0;
+	std::uint64_t BtPackets = 0;
+	bool bBtValues = true;
+	const std::uint64_t BtAllocationsBefore = GAllocations.load(std::memory_order_relaxed);
+	for (std::size_t i = 0; i < kCallbacks; ++i)
+	{
+		const std::size_t Frames = kCallbackFrames[i % std::size(kCallbackFrames)];
+		Processor->process_bt(Input.data(), Frames, *BtRing);
+		BtIn += Frames;
+		while (BtRing->try_pop(Packet))
+		{
+			// The first packet holds the anti-aliasing filter's warm-up; off by one is rounding.
+			if (++BtPackets > 1)
+			{
+				bBtValues = bBtValues && std::abs(static_cast<std::int8_t>(Packet.Data[0]) - 64) <= 1 &&
+				            std::abs(static_cast<std::int8_t>(Packet.Data[haptic_bt_packet::kBytes - 1]) + 32) <= 1;
+			}
+		}
+	}
+	const std::uint64_t BtAllocations = GAllocations.load(std::memory_order_relaxed) - BtAllocationsBefore;
+	expect(BtAllocations == 0, "Bluetooth processing does not allocate");
+	// The decimator emits on input frames 0, 16, 32...; the linear resampler emits output k, which
+	// sits on input frame 16k, once the frame after it arrives.
+	const std::uint64_t BtOutputFrames = Processor->bt_anti_aliasing() ? (BtIn + 15) / 16 : (BtIn - 2) / 16 + 1;
+	expect(BtPackets == BtOutputFrames / haptic_bt_packet::kFrames && BtRing->dropped() == 0, "Bluetooth emits one packet per 32 frames at 3000 Hz");
+	expect(bBtValues, "Bluetooth packets are scaled to int8");
+
+	// A 44.1 kHz sine split into odd-sized calls must resample exactly as in one call, with no seams.
+	std::vector<float> Sine(44100 * 2);
+	for (std::size_t i = 0; i < Sine.size() / 2; ++i)
+	{
+		Sine[i * 2] = static_cast<float>(std::sin(2.0 * 3.14159265358979 * 40.0 * static_cast<double>(i) / 44100.0));
+		Sine[i * 2 + 1] = -Sine[i * 2];
+	}
+	haptic_resampler Whole(44100, 3000);
+	std::vector<float> WholeOut(Whole.max_output(Sine.size() / 2) * 2);
+	const std::size_t WholeFrames = Whole.process(Sine.data(), Sine.size() / 2, WholeOut.data());
+
+	haptic_resampler Split(44100, 3000);
+	std::vector<float> SplitOut(WholeOut.size());
+	std::size_t SplitFrames = 0;
+	for (std::size_t First = 0, i = 0; First < Sine.size() / 2; ++i)
+	{
+		const std::size_t Count = std::min(kCallbackFrames[i % std::size(kCallbackFrames)], Sine.size() / 2 - First);
+		SplitFrames += Split.process(&Sine[First * 2], Count, &SplitOut[SplitFrames * 2]);
+		First += Count;
+	}
+	expect(SplitFrames == WholeFrames && std::equal(WholeOut.begin(), WholeOut.begin() + WholeFrames * 2, SplitOut.begin()), "resampler output does not depend on call sizes");
+
+	// 40 Hz at 3000 Hz moves at most 2*pi*40/3000 ~ 0.084 per frame; a seam would jump further.
+	float MaxStep = 0.0f;
+	for (std::size_t i = 1; i < WholeFrames; ++i)
+	{
+		MaxStep = std::max(MaxStep, std::abs(WholeOut[i * 2] - WholeOut[(i - 1) * 2]));
+	}
+	expect(WholeFrames == 3000 && MaxStep < 0.09f, "resampled sine is continuous");
+
+	// clear() runs when playback restarts; the consumer's cached view of the tail must move with it
+	// or the next pop counts the distance back to the stale tail as queued items.
+	spsc_ring<std::uint32_t, 16> Ring;
+	std::uint32_t Items[16] = {};
+	for (std::uint32_t i = 0; i < 10; ++i)
+	{
+		Ring.try_push(i);
+	}
+	Ring.pop(Items, 5);
+	for (std::uint32_t i = 10; i < 20; ++i)
+	{
+		Ring.try_push(i);
+	}
+	Ring.clear();
+	const std::size_t AfterClear = Ring.pop(Items, 4);
+	Ring.try_push(100);
+	Ring.try_push(101);
+	const std::size_t AfterPush = Ring.pop(Items, 16);
+	expect(AfterClear == 0 && AfterPush == 2 && Items[0] == 100 && Items[1] == 101 && Ring.approximate_size() == 0,
+	       "ring is empty after clear and delivers only newer items");
+
+	return test_utils::finish_checks();
+}
+#endif
@@ -0,0 +1,105 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Checks the float -> int8/int16 haptic quantizers: rounding and saturation against a
+// plain per-sample reference, vector and scalar paths agreeing bit for bit with and without dither,
+// and the dither being bounded and unbiased. Needs no hardware.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Audio/haptic_quantize.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using test_utils::expect;
+
+static int reference(float Sample, float Scale, int Min, int Max)
+{
+	return std::clamp(static_cast<int>(std::nearbyint(std::clamp(Sample, -1.0f, 1.0f) * Scale)), Min, Max);
+}
+
+// Runs Kernel over In in calls of Step samples; Step < 8 never reaches the vector loop.
+template<typename TSample, typename FKernel>
+static std::vector<TSample> quantize_in_steps(FKernel Kernel, const std::vector<float>& In, std::size_t Step, haptic_dither* Dither)
+{
+	std::vector<TSample> Out(In.size());
+	for (std::size_t First = 0; First < In.size(); First += Step)
+	{
+		Kernel(&In[First], std::min(Step, In.size() - First), &Out[First], Dither);
+	}
+	return Out;
+}
+
+int main()
+{
+	std::cout << "Quantize kernels: " << haptic_quantize_simd_path() << std::endl;
+
+	// Noise beyond full scale, exact ties and the end points; an odd count leaves a tail.
+	std::vector<float> Input(4099);
+	std::uint32_t Seed = 12345;
+	for (float& Sample : Input)
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		Sample = static_cast<float>(Seed >> 8) / static_cast<float>(1u << 24) * 3.0f - 1.5f;
+	}
+	const float Edges[] = {1.0f, -1.0f, 0.0f, 0.5f / 127.0f, 1.5f / 127.0f, -2.5f / 127.0f, 0.5f, -0.25f, 1e9f, -1e9f};
+	std::copy(std::begin(Edges), std::end(Edges), Input.begin());
+
+	std::vector<std::int8_t> Int8(Input.size());
+	std::vector<std::int16_t> Int16(Input.size());
+	haptic_quantize_int8(Input.data(), Input.size(), Int8.data());
+	haptic_quantize_int16(Input.data(), Input.size(), Int16.data());
+	bool bInt8 = true;
+	bool bInt16 = true;
+	for (std::size_t i = 0; i < Input.size(); ++i)
+	{
+		bInt8 = bInt8 && Int8[i] == reference(Input[i], 127.0f, -128, 127);
+		bInt16 = bInt16 && Int16[i] == reference(Input[i], 32767.0f, -32768, 32767);
+	}
+	expect(bInt8, "int8 rounds to nearest and saturates like the per-sample reference");
+	expect(bInt16, "int16 rounds to nearest and saturates like the per-sample reference");
+	expect(Int8[0] == 127 && Int8[1] == -127 && Int8[8] == 127 && Int8[9] == -127 && Int16[6] == 16384 && Int16[7] == -8192, "full scale and known values");
+
+	// Split at multiples of four samples the dither lanes stay aligned, so a scalar-only run must
+	// reproduce the vector one exactly.
+	haptic_dither VectorDither(7);
+	haptic_dither ScalarDither(7);
+	const auto Vector8 = quantize_in_steps<std::int8_t>(haptic_quantize_int8, Input, Input.size(), &VectorDither);
+	const auto Scalar8 = quantize_in_steps<std::int8_t>(haptic_quantize_int8, Input, 4, &ScalarDither);
+	const auto Vector16 = quantize_in_steps<std::int16_t>(haptic_quantize_int16, Input, Input.size(), &VectorDither);
+	const auto Scalar16 = quantize_in_steps<std::int16_t>(haptic_quantize_int16, Input, 4, &ScalarDither);
+	expect(Vector8 == Scalar8 && Vector16 == Scalar16, "vector and scalar paths agree with dither");
+	expect(quantize_in_steps<std::int8_t>(haptic_quantize_int8, Input, 4, nullptr) == Int8, "vector and scalar paths agree without dither");
+
+	// NaN reaches both paths as -1: 17 samples cover the int8 vector loop plus a scalar tail.
+	const std::vector<float> Nans(17, std::nanf(""));
+	const auto AllEqual = [](const auto& Out, int Expected) { return std::all_of(Out.begin(), Out.end(), [Expected](int Sample) { return Sample == Expected; }); };
+	expect(AllEqual(quantize_in_steps<std::int8_t>(haptic_quantize_int8, Nans, Nans.size(), nullptr), -127) &&
+	           AllEqual(quantize_in_steps<std::int8_t>(haptic_quantize_int8, Nans, 4, nullptr), -127) &&
+	           AllEqual(quantize_in_steps<std::int16_t>(haptic_quantize_int16, Nans, Nans.size(), nullptr), -32767) &&
+	           AllEqual(quantize_in_steps<std::int16_t>(haptic_quantize_int16, Nans, 4, nullptr), -32767),
+	       "NaN quantizes to negative full scale on every path");
+
+	// TPDF dither moves each sample by less than one step and leaves the average where it was.
+	constexpr float kLevel = 10.3f;
+	std::vector<float> Quiet(100000, kLevel / 127.0f);
+	std::vector<std::int8_t> Dithered(Quiet.size());
+	haptic_dither Dither;
+	haptic_quantize_int8(Quiet.data(), Quiet.size(), Dithered.data(), &Dither);
+	double Sum = 0.0;
+	bool bBounded = true;
+	for (const std::int8_t Sample : Dithered)
+	{
+		Sum += Sample;
+		bBounded = bBounded && Sample >= 9 && Sample <= 11;
+	}
+	const double Mean = Sum / static_cast<double>(Dithered.size());
+	expect(bBounded, "dither stays within one step of the signal");
+	expect(std::abs(Mean - kLevel) < 0.02, "dithered mean matches the undithered level (" + std::to_string(Mean) + ")");
+
+	return test_utils::finish_checks();
+}
+#endif
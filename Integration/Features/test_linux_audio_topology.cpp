@@ -0,0 +1,123 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Matches hidraw nodes and sound server sinks to ALSA cards through linux_audio_topology
+// on a fake sysfs tree: two identical USB controllers, each with its own card, two Bluetooth
+// controllers behind an adapter with a card of its own and one unrelated USB sound card. Needs no hardware.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Platform/linux/linux_audio_topology.h"
+#include "test_utils.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+using test_utils::expect;
+
+static void write_file(const fs::path& Path, const std::string& Content)
+{
+	fs::create_directories(Path.parent_path());
+	std::ofstream(Path) << Content << "\n";
+}
+
+// <root>/devices/<DevicePath> plus the <root>/class/<Class>/<Name> link to it.
+static void add_class_device(const fs::path& Root, const std::string& Class, const std::string& Name, const std::string& DevicePath)
+{
+	const fs::path Device = Root / "devices" / DevicePath;
+	fs::create_directories(Device);
+	fs::create_directories(Root / "class" / Class);
+	fs::create_symlink(fs::relative(Device, Root / "class" / Class), Root / "class" / Class / Name);
+}
+
+static void add_usb_device(const fs::path& Root, const std::string& DevicePath, const std::string& Vendor)
+{
+	write_file(Root / "devices" / DevicePath / "idVendor", Vendor);
+}
+
+int main()
+{
+	char Template[] = "/tmp/gamepad-core-sysfs-XXXXXX";
+	if (!mkdtemp(Template))
+	{
+		std::cerr << "Cannot create a temporary directory" << std::endl;
+		return 1;
+	}
+	const fs::path Root(Template);
+
+	// Two DualSense on USB: HID on interface 3, audio on interface 0 of the same USB device.
+	const std::string PadA = "pci0000:00/0000:00:14.0/usb1/1-2";
+	const std::string PadB = "pci0000:00/0000:00:14.0/usb1/1-3";
+	add_usb_device(Root, PadA, "054c");
+	add_usb_device(Root, PadB, "054c");
+	for (const std::string& Pad : {PadA, PadB})
+	{
+		write_file(Root / "devices" / Pad / "manufacturer", "Sony Interactive Entertainment");
+		write_file(Root / "devices" / Pad / "product", "DualSense Wireless Controller");
+	}
+	add_class_device(Root, "hidraw", "hidraw3", PadA + "/1-2:1.3/0003:054C:0CE6.0001/hidraw/hidraw3");
+	add_class_device(Root, "hidraw", "hidraw4", PadB + "/1-3:1.3/0003:054C:0CE6.0002/hidraw/hidraw4");
+	add_class_device(Root, "sound", "card2", PadA + "/1-2:1.0/sound/card2");
+	add_class_device(Root, "sound", "card3", PadB + "/1-3:1.0/sound/card3");
+	write_file(Root / "devices" / PadA / "1-2:1.0/sound/card2/id", "Controller");
+	write_file(Root / "devices" / PadB / "1-3:1.0/sound/card3/id", "Controller_1");
+	write_file(Root / "devices" / PadA / "1-2:1.0/bInterfaceNumber", "00");
+	write_file(Root / "devices" / PadB / "1-3:1.0/bInterfaceNumber", "00");
+
+	// Two Bluetooth DualSense behind a USB adapter that happens to have a card of its own.
+	const std::string Adapter = "pci0000:00/0000:00:14.0/usb1/1-9";
+	add_usb_device(Root, Adapter, "8087");
+	add_class_device(Root, "hidraw", "hidraw5", Adapter + "/1-9:1.0/bluetooth/hci0/hci0:256/0005:054C:0CE6.0003/hidraw/hidraw5");
+	add_class_device(Root, "hidraw", "hidraw6", Adapter + "/1-9:1.0/bluetooth/hci0/hci0:512/0005:054C:0CE6.0004/hidraw/hidraw6");
+	add_class_device(Root, "sound", "card4", Adapter + "/1-9:1.2/sound/card4");
+	write_file(Root / "devices" / Adapter / "1-9:1.2/sound/card4/id", "Adapter");
+
+	// An unrelated USB headset.
+	add_usb_device(Root, "pci0000:00/0000:00:14.0/usb1/1-4", "046d");
+	add_class_device(Root, "sound", "card1", "pci0000:00/0000:00:14.0/usb1/1-4/1-4:1.0/sound/card1");
+	write_file(Root / "devices/pci0000:00/0000:00:14.0/usb1/1-4/1-4:1.0/sound/card1/id", "Headset");
+	write_file(Root / "devices/pci0000:00/0000:00:14.0/usb1/1-4/1-4:1.0/bInterfaceNumber", "00");
+	write_file(Root / "devices/pci0000:00/0000:00:14.0/usb1/1-4/manufacturer", "Logitech");
+	write_file(Root / "devices/pci0000:00/0000:00:14.0/usb1/1-4/product", "USB Headset");
+
+	linux_audio_topology Topology(Root.string());
+	Topology.rebuild();
+	expect(Topology.cards().size() == 4, "four cards indexed");
+
+	const std::string ContainerA = Topology.container_for_hid("/dev/hidraw3");
+	const std::string ContainerB = Topology.container_for_hid("hidraw4");
+	expect(!ContainerA.empty() && ContainerA != ContainerB, "identical controllers resolve to different containers");
+	expect(Topology.card_for_container(ContainerA) == 2, "first controller owns card 2");
+	expect(Topology.card_for_container(ContainerB) == 3, "second controller owns card 3");
+	expect(Topology.container_for_card(3) == ContainerB, "card 3 resolves back to the second controller");
+
+	const std::string ContainerBt = Topology.container_for_hid("/dev/hidraw5");
+	expect(!ContainerBt.empty(), "Bluetooth controller has a container");
+	expect(ContainerBt != Topology.container_for_hid("/dev/hidraw6"), "Bluetooth controllers do not share the adapter");
+	expect(Topology.card_for_container(ContainerBt) == -1, "Bluetooth controller has no card, not the adapter's");
+
+	expect(Topology.card_for_alsa_id("hw:3,0") == 3, "hw:N,M");
+	expect(Topology.card_for_alsa_id(":2,0") == 2, "miniaudio's :N,M");
+	expect(Topology.card_for_alsa_id("plughw:2") == 2, "plughw:N");
+	expect(Topology.card_for_alsa_id("front:CARD=Controller_1,DEV=0") == 3, "CARD=<id>");
+	expect(Topology.card_for_alsa_id("sysdefault:CARD=Headset") == 1, "CARD=<id> without DEV");
+	expect(Topology.card_for_alsa_id("default") == -1, "default has no card");
+	expect(Topology.card_for_alsa_id("hw:CARD=Missing,DEV=0") == -1, "unknown card id");
+	expect(Topology.container_for_hid("/dev/hidraw9").empty(), "missing node");
+
+	expect(Topology.card_for_sink_name("alsa_output.pci-0000_00_14.0-usb-0_2_1.0.analog-stereo") == 2, "sink named after ID_PATH");
+	expect(Topology.card_for_sink_name("alsa_output.pci-0000_00_14.0-usb-0_3_1.0.analog-stereo") == 3, "ID_PATH tells identical controllers apart");
+	expect(Topology.card_for_sink_name("alsa_output.usb-Logitech_USB_Headset-00.analog-stereo") == 1, "sink named after ID_ID");
+	expect(Topology.card_for_sink_name("alsa_output.usb-Sony_Interactive_Entertainment_DualSense_Wireless_Controller-00.analog-stereo") == -1,
+	       "ID_ID shared by identical controllers matches neither");
+	expect(Topology.card_for_sink_name("alsa_output.pci-0000_00_1f.3.analog-stereo") == -1, "onboard sink has no card here");
+
+	std::error_code Error;
+	fs::remove_all(Root, Error);
+
+	return test_utils::finish_checks();
+}
+#endif
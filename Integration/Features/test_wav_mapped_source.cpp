@@ -0,0 +1,161 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Writes small WAV files in the formats haptic clips come in and plays them back
+// through wav_mapped_source: length from the header, zero-copy float stereo, conversion of
+// integer and mono files, chunks before the data, files cut short and files that are not WAV.
+// Needs no hardware.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Audio/wav_mapped_source.h"
+#include "test_utils.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using test_utils::expect;
+
+static void put_u16(std::vector<std::uint8_t>& Out, std::uint16_t Value)
+{
+	Out.push_back(static_cast<std::uint8_t>(Value));
+	Out.push_back(static_cast<std::uint8_t>(Value >> 8));
+}
+
+static void put_u32(std::vector<std::uint8_t>& Out, std::uint32_t Value)
+{
+	put_u16(Out, static_cast<std::uint16_t>(Value));
+	put_u16(Out, static_cast<std::uint16_t>(Value >> 16));
+}
+
+static void put_tag(std::vector<std::uint8_t>& Out, const char* Tag)
+{
+	Out.insert(Out.end(), Tag, Tag + 4);
+}
+
+// A WAV with Samples as the data chunk, optionally a LIST chunk before it and a data size that
+// claims more than the file holds.
+static std::vector<std::uint8_t> make_wav(std::uint16_t Encoding, std::uint16_t Channels, std::uint16_t Bits, const std::vector<std::uint8_t>& Samples,
+                                          bool bExtraChunk = false, bool bOversizedData = false)
+{
+	std::vector<std::uint8_t> Wav;
+	put_tag(Wav, "RIFF");
+	put_u32(Wav, 0);
+	put_tag(Wav, "WAVE");
+	put_tag(Wav, "fmt ");
+	put_u32(Wav, 16);
+	put_u16(Wav, Encoding);
+	put_u16(Wav, Channels);
+	put_u32(Wav, 48000);
+	put_u32(Wav, 48000u * Channels * (Bits / 8));
+	put_u16(Wav, static_cast<std::uint16_t>(Channels * (Bits / 8)));
+	put_u16(Wav, Bits);
+	if (bExtraChunk)
+	{
+		// Odd-sized, so the pad byte has to be skipped too.
+		put_tag(Wav, "LIST");
+		put_u32(Wav, 5);
+		Wav.insert(Wav.end(), {'I', 'N', 'F', 'O', 'x', 0});
+	}
+	put_tag(Wav, "data");
+	put_u32(Wav, bOversizedData ? 0xFFFFFFFFu : static_cast<std::uint32_t>(Samples.size()));
+	Wav.insert(Wav.end(), Samples.begin(), Samples.end());
+	const std::uint32_t RiffSize = static_cast<std::uint32_t>(Wav.size() - 8);
+	std::memcpy(&Wav[4], &RiffSize, 4);
+	return Wav;
+}
+
+static std::string write_file(const std::string& Name, const std::vector<std::uint8_t>& Bytes)
+{
+	const fs::path Path = fs::temp_directory_path() / ("gamepad_core_" + Name);
+	std::ofstream(Path, std::ios::binary).write(reinterpret_cast<const char*>(Bytes.data()), static_cast<std::streamsize>(Bytes.size()));
+	return Path.string();
+}
+
+template<typename T>
+static std::vector<std::uint8_t> bytes_of(const std::vector<T>& Values)
+{
+	std::vector<std::uint8_t> Bytes(Values.size() * sizeof(T));
+	std::memcpy(Bytes.data(), Values.data(), Bytes.size());
+	return Bytes;
+}
+
+int main()
+{
+	std::vector<std::string> Files;
+
+	// Float stereo: played from the mapping, in callback-sized reads.
+	std::vector<float> Stereo(1000 * 2);
+	for (std::size_t i = 0; i < Stereo.size(); ++i)
+	{
+		Stereo[i] = std::sin(static_cast<float>(i) * 0.01f) * (i % 2 ? -0.5f : 0.5f);
+	}
+	Files.push_back(write_file("float.wav", make_wav(3, 2, 32, bytes_of(Stereo))));
+	wav_mapped_source Float;
+	expect(Float.open(Files.back()), "opens a float stereo WAV");
+	expect(Float.total_frames() == 1000 && Float.format().SampleRate == 48000 && Float.is_zero_copy(), "length and format come from the header");
+
+	std::vector<float> Buffer(480 * 2);
+	std::vector<float> Played;
+	bool bFromMapping = true;
+	std::size_t Frames = 0;
+	for (const float* Span = Float.read_f32_stereo(Buffer.data(), 480, Frames); Frames > 0; Span = Float.read_f32_stereo(Buffer.data(), 480, Frames))
+	{
+		bFromMapping = bFromMapping && Span != Buffer.data();
+		Played.insert(Played.end(), Span, Span + Frames * 2);
+	}
+	expect(bFromMapping && Played == Stereo, "float stereo frames are handed out without copying");
+	Float.read_ahead();
+	Float.seek(990);
+	Float.read_f32_stereo(Buffer.data(), 480, Frames);
+	expect(Frames == 10 && Float.position() == 1000, "seek and end of data");
+
+	// 16-bit mono with a LIST chunk first: converted and duplicated to both channels.
+	const std::vector<std::int16_t> Mono = {0, 16384, -32768, 32767, -16384};
+	Files.push_back(write_file("int16_mono.wav", make_wav(1, 1, 16, bytes_of(Mono), true)));
+	wav_mapped_source Int16;
+	expect(Int16.open(Files.back()) && !Int16.is_zero_copy() && Int16.total_frames() == Mono.size(), "opens 16-bit mono past a LIST chunk");
+	const float* Converted = Int16.read_f32_stereo(Buffer.data(), 480, Frames);
+	bool bInt16 = Converted == Buffer.data() && Frames == Mono.size();
+	for (std::size_t i = 0; bInt16 && i < Frames; ++i)
+	{
+		const float Expected = static_cast<float>(Mono[i]) / 32768.0f;
+		bInt16 = Converted[i * 2] == Expected && Converted[i * 2 + 1] == Expected;
+	}
+	expect(bInt16, "16-bit mono converts to float stereo");
+
+	// 24-bit stereo whose data size is a streaming placeholder: length is what the file holds.
+	const std::vector<std::uint8_t> Packed24 = {0x00, 0x00, 0x40, 0x00, 0x00, 0x80, 0xFF, 0xFF, 0x7F, 0x01, 0x00, 0x00, 0x00, 0x00};
+	Files.push_back(write_file("int24.wav", make_wav(1, 2, 24, Packed24, false, true)));
+	wav_mapped_source Int24;
+	expect(Int24.open(Files.back()) && Int24.total_frames() == 2, "placeholder data size is clipped to the file");
+	Converted = Int24.read_f32_stereo(Buffer.data(), 480, Frames);
+	expect(Frames == 2 && Converted[0] == 0.5f && Converted[1] == -1.0f && Converted[2] == 8388607.0f / 8388608.0f && Converted[3] == 1.0f / 8388608.0f,
+	       "24-bit samples are sign-extended and scaled");
+
+	// Things that must be refused with a reason.
+	Files.push_back(write_file("text.wav", std::vector<std::uint8_t>(64, 'x')));
+	wav_mapped_source Bad;
+	expect(!Bad.open(Files.back()) && !Bad.is_open() && !Bad.error().empty(), "rejects a file that is not RIFF/WAVE");
+	std::vector<std::uint8_t> Truncated = make_wav(3, 2, 32, bytes_of(Stereo));
+	Truncated.resize(30);
+	Files.push_back(write_file("truncated.wav", Truncated));
+	expect(!Bad.open(Files.back()), "rejects a header cut short");
+	Files.push_back(write_file("adpcm.wav", make_wav(2, 2, 16, bytes_of(Mono))));
+	expect(!Bad.open(Files.back()) && Bad.error().find("unsupported") != std::string::npos, "rejects compressed encodings");
+	expect(!Bad.open((fs::temp_directory_path() / "gamepad_core_missing.wav").string()), "reports a missing file");
+
+	for (const std::string& File : Files)
+	{
+		std::error_code Ignored;
+		fs::remove(File, Ignored);
+	}
+
+	return test_utils::finish_checks();
+}
+#endif
@@ -0,0 +1,166 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Offline converter from a WAV clip to a pre-rendered haptic asset (.ghap).
+// Runs the clip through the same haptic_processor chain as live playback, once per controller
+// and transport, so the game only copies packets into AudioHapticUpdate at runtime.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Audio/haptic_asset.h"
+#include "Audio/wav_mapped_source.h"
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static void print_help()
+{
+	std::cout << "\n=======================================================" << std::endl;
+	std::cout << "        HAPTIC ASSET CONVERTER                         " << std::endl;
+	std::cout << "=======================================================" << std::endl;
+	std::cout << " Usage: haptic-asset-converter [options] <in.wav> <out.ghap>" << std::endl;
+	std::cout << "" << std::endl;
+	std::cout << " Options:" << std::endl;
+	std::cout << "   --devices <list>    dualsense,edge,ds4 (default: dualsense,edge)" << std::endl;
+	std::cout << "   --transport <list>  bt,usb (default: bt,usb)" << std::endl;
+	std::cout << "   --compress          Zero-run compress streams where it helps" << std::endl;
+	std::cout << "" << std::endl;
+	std::cout << " USB streams need a 48 kHz clip; Bluetooth takes any rate." << std::endl;
+	std::cout << " Play the result with AudioHapticsTest <out.ghap>." << std::endl;
+	std::cout << "=======================================================" << std::endl;
+}
+
+static std::vector<std::string> split_list(const std::string& List)
+{
+	std::vector<std::string> Items;
+	std::stringstream Stream(List);
+	for (std::string Item; std::getline(Stream, Item, ',');)
+	{
+		if (!Item.empty())
+		{
+			Items.push_back(Item);
+		}
+	}
+	return Items;
+}
+
+static bool parse_device(const std::string& Name, EDSDeviceType& Out)
+{
+	if (Name == "dualsense")
+	{
+		Out = EDSDeviceType::DualSense;
+	}
+	else if (Name == "edge")
+	{
+		Out = EDSDeviceType::DualSenseEdge;
+	}
+	else if (Name == "ds4")
+	{
+		Out = EDSDeviceType::DualShock4;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> Positional;
+	std::string Devices = "dualsense,edge";
+	std::string Transports = "bt,usb";
+	bool bCompress = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view Arg(argv[i]);
+		if (Arg == "--devices" && i + 1 < argc)
+		{
+			Devices = argv[++i];
+		}
+		else if (Arg == "--transport" && i + 1 < argc)
+		{
+			Transports = argv[++i];
+		}
+		else if (Arg == "--compress")
+		{
+			bCompress = true;
+		}
+		else if (Arg == "--help" || Arg == "-h")
+		{
+			print_help();
+			return 0;
+		}
+		else
+		{
+			Positional.emplace_back(Arg);
+		}
+	}
+	if (Positional.size() != 2)
+	{
+		print_help();
+		return 1;
+	}
+
+	wav_mapped_source Wav;
+	if (!Wav.open(Positional[0]))
+	{
+		std::cerr << "[Converter Error] " << Wav.error() << std::endl;
+		return 1;
+	}
+	std::vector<float> Clip(static_cast<std::size_t>(Wav.total_frames()) * 2);
+	std::size_t Frames = 0;
+	const float* Span = Wav.read_f32_stereo(Clip.data(), Clip.size() / 2, Frames);
+	if (Span != Clip.data())
+	{
+		Clip.assign(Span, Span + Frames * 2);
+	}
+	const std::uint32_t SampleRate = Wav.format().SampleRate;
+	std::cout << "[Converter] " << Positional[0] << ": " << Frames << " frames at " << SampleRate << " Hz" << std::endl;
+
+	haptic_asset Asset;
+	Asset.SourceSampleRate = SampleRate;
+	Asset.SourceFrames = Frames;
+	for (const std::string& DeviceName : split_list(Devices))
+	{
+		EDSDeviceType DeviceType;
+		if (!parse_device(DeviceName, DeviceType))
+		{
+			std::cerr << "[Converter Error] Unknown device: " << DeviceName << std::endl;
+			return 1;
+		}
+		for (const std::string& TransportName : split_list(Transports))
+		{
+			if (TransportName != "bt" && TransportName != "usb")
+			{
+				std::cerr << "[Converter Error] Unknown transport: " << TransportName << std::endl;
+				return 1;
+			}
+			const haptic_asset_transport Transport = TransportName == "bt" ? haptic_asset_transport::Bluetooth : haptic_asset_transport::Usb;
+			if (Transport == haptic_asset_transport::Usb && SampleRate != 48000)
+			{
+				std::cerr << "[Converter] Skipping " << DeviceName << ":usb, the clip is not 48 kHz." << std::endl;
+				continue;
+			}
+			Asset.Streams.push_back(haptic_asset_render(Clip.data(), Frames, SampleRate, DeviceType, Transport));
+			std::cout << "[Converter] " << DeviceName << ":" << TransportName << " -> " << Asset.Streams.back().Payload.size() << " bytes" << std::endl;
+		}
+	}
+	if (Asset.Streams.empty())
+	{
+		std::cerr << "[Converter Error] Nothing to write." << std::endl;
+		return 1;
+	}
+
+	std::string Error;
+	if (!Asset.save(Positional[1], bCompress, Error))
+	{
+		std::cerr << "[Converter Error] " << Error << std::endl;
+		return 1;
+	}
+	std::cout << "[Converter] Wrote " << Positional[1] << " (" << Asset.Streams.size() << " streams)" << std::endl;
+	return 0;
+}
+#endif
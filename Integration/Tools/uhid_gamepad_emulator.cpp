@@ -0,0 +1,578 @@
+// Copyright (c) 2025 Rafael Valoto. All Rights Reserved.
+// Project: GamepadCore
+// Description: Kernel-level DualSense / DualSense Edge / DS4 emulator built on /dev/uhid.
+// Each emulated controller shows up as a real hidraw node with Sony's VID/PID, streams input
+// reports at a fixed rate and records every output and audio-haptic report written by the host.
+
+#ifdef BUILD_GAMEPAD_CORE_TESTS
+#include "Platform/linux/linux_device_info.h"
+#include "Platform/virtual/virtual_device_info.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <linux/uhid.h>
+#include <map>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+using virtual_platform::virtual_device_info;
+using virtual_platform::virtual_device_script;
+using virtual_platform::virtual_hid_bus;
+
+static std::atomic<bool> GStop{false};
+
+static void on_signal(int)
+{
+	GStop.store(true);
+}
+
+static std::uint64_t monotonic_ns()
+{
+	timespec Ts{};
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return static_cast<std::uint64_t>(Ts.tv_sec) * 1000000000ull + static_cast<std::uint64_t>(Ts.tv_nsec);
+}
+
+// ============================================================================
+// Report descriptor
+// ============================================================================
+// The descriptor is a vendor-page collection that declares the same report IDs and sizes
+// as the real pads. hid-playstation binds by VID/PID and only checks report sizes, and
+// hidraw passes reports through untouched, so the layout inside each report is free-form.
+struct report_decl
+{
+	std::uint8_t Id;
+	std::uint16_t Size; // Including the report ID byte.
+};
+
+struct emulator_profile
+{
+	std::string Name;
+	std::uint16_t ProductId = 0;
+	std::vector<report_decl> Inputs;
+	std::vector<report_decl> Outputs;
+	std::vector<report_decl> Features;
+};
+
+static void append_reports(std::vector<std::uint8_t>& Rd, std::uint8_t MainItem, const std::vector<report_decl>& Reports)
+{
+	for (const report_decl& Report : Reports)
+	{
+		const std::uint16_t Payload = static_cast<std::uint16_t>(Report.Size - 1);
+		const std::uint8_t Items[] = {
+		    0x85, Report.Id,                                                                  // Report ID
+		    0x09, Report.Id,                                                                  // Usage
+		    0x96, static_cast<std::uint8_t>(Payload & 0xFF), static_cast<std::uint8_t>(Payload >> 8), // Report Count
+		    MainItem, 0x02};                                                                  // Data, Var, Abs
+		Rd.insert(Rd.end(), std::begin(Items), std::end(Items));
+	}
+}
+
+static std::vector<std::uint8_t> build_descriptor(const emulator_profile& Profile)
+{
+	std::vector<std::uint8_t> Rd = {
+	    0x06, 0x00, 0xFF, // Usage Page (Vendor Defined 0xFF00)
+	    0x09, 0x01,       // Usage (0x01)
+	    0xA1, 0x01,       // Collection (Application)
+	    0x15, 0x00,       // Logical Minimum (0)
+	    0x26, 0xFF, 0x00, // Logical Maximum (255)
+	    0x75, 0x08};      // Report Size (8)
+	append_reports(Rd, 0x81, Profile.Inputs);
+	append_reports(Rd, 0x91, Profile.Outputs);
+	append_reports(Rd, 0xB1, Profile.Features);
+	Rd.push_back(0xC0); // End Collection
+	return Rd;
+}
+
+// Bluetooth pads declare nine report IDs from FirstId on, in both directions, 78 to 547 bytes long.
+// Only the first carries the controller state; hosts use the longer ones for audio-haptic data.
+static std::vector<report_decl> bluetooth_reports(std::uint8_t FirstId)
+{
+	static constexpr std::uint16_t kSizes[] = {78, 142, 206, 270, 334, 398, 462, 526, 547};
+	std::vector<report_decl> Reports;
+	for (std::uint8_t i = 0; i < std::size(kSizes); ++i)
+	{
+		Reports.push_back({static_cast<std::uint8_t>(FirstId + i), kSizes[i]});
+	}
+	return Reports;
+}
+
+static emulator_profile make_profile(EDSDeviceType DeviceType, EDSDeviceConnection ConnectionType)
+{
+	const bool bBluetooth = ConnectionType == EDSDeviceConnection::Bluetooth;
+	emulator_profile Profile;
+
+	if (DeviceType == EDSDeviceType::DualShock4)
+	{
+		Profile.Name = "Sony Interactive Entertainment Wireless Controller";
+		Profile.ProductId = DUALSHOCK4_PID_V2;
+		if (bBluetooth)
+		{
+			Profile.Inputs = bluetooth_reports(0x11);
+			Profile.Inputs.insert(Profile.Inputs.begin(), {0x01, 10});
+			Profile.Outputs = bluetooth_reports(0x11);
+			Profile.Features = {{0x05, 41}, {0xA3, 49}};
+		}
+		else
+		{
+			Profile.Inputs = {{0x01, 64}};
+			Profile.Outputs = {{0x05, 32}};
+			Profile.Features = {{0x02, 37}, {0x12, 16}, {0x81, 7}, {0xA3, 49}};
+		}
+		return Profile;
+	}
+
+	const bool bEdge = DeviceType == EDSDeviceType::DualSenseEdge;
+	Profile.Name = bEdge ? "Sony Interactive Entertainment DualSense Edge Wireless Controller" : "Sony Interactive Entertainment DualSense Wireless Controller";
+	Profile.ProductId = bEdge ? DUALSENSE_EDGE_PID : DUALSENSE_PID;
+	if (bBluetooth)
+	{
+		Profile.Inputs = bluetooth_reports(0x31);
+		Profile.Inputs.insert(Profile.Inputs.begin(), {0x01, 10});
+		Profile.Outputs = bluetooth_reports(0x31);
+	}
+	else
+	{
+		Profile.Inputs = {{0x01, 64}};
+		Profile.Outputs = {{0x02, 48}};
+	}
+	Profile.Features = {{0x05, 41}, {0x09, 20}, {0x20, 64}};
+	return Profile;
+}
+
+// ============================================================================
+// Emulated device
+// ============================================================================
+struct output_counter
+{
+	std::uint64_t Count = 0;
+	std::uint64_t Bytes = 0;
+};
+
+struct emulated_device
+{
+	std::uint32_t Index = 0;
+	virtual_device_script Script;
+	emulator_profile Profile;
+	int Fd = -1;
+	bool bStarted = false;
+	bool bOpened = false;
+
+	std::uint64_t PeriodNs = 0;
+	std::uint64_t NextInputNs = 0;
+	std::uint64_t Sequence = 0;
+	std::uint64_t StartNs = 0;
+
+	std::uint64_t InputsSent = 0;
+	std::uint64_t InputsLate = 0;
+	std::uint64_t FeatureRequests = 0;
+	std::uint64_t AudioReports = 0;
+	std::uint64_t AudioBytes = 0;
+	std::map<std::uint8_t, output_counter> Outputs;
+};
+
+static bool uhid_write(int Fd, const uhid_event& Event)
+{
+	const ssize_t Written = write(Fd, &Event, sizeof(Event));
+	return Written == static_cast<ssize_t>(sizeof(Event));
+}
+
+static bool create_device(emulated_device& Device)
+{
+	Device.Fd = open("/dev/uhid", O_RDWR | O_CLOEXEC | O_NONBLOCK);
+	if (Device.Fd < 0)
+	{
+		std::perror("[Emulator] open /dev/uhid");
+		return false;
+	}
+
+	const std::vector<std::uint8_t> Descriptor = build_descriptor(Device.Profile);
+
+	uhid_event Event{};
+	Event.type = UHID_CREATE2;
+	std::snprintf(reinterpret_cast<char*>(Event.u.create2.name), sizeof(Event.u.create2.name), "%s", Device.Profile.Name.c_str());
+	std::snprintf(reinterpret_cast<char*>(Event.u.create2.phys), sizeof(Event.u.create2.phys), "gamepad-core-uhid/%u", Device.Index);
+	std::snprintf(reinterpret_cast<char*>(Event.u.create2.uniq), sizeof(Event.u.create2.uniq), "a0:5a:5d:00:00:%02x", Device.Index & 0xFF);
+	Event.u.create2.rd_size = static_cast<std::uint16_t>(Descriptor.size());
+	Event.u.create2.bus = (Device.Script.ConnectionType == EDSDeviceConnection::Bluetooth) ? BUS_BLUETOOTH : BUS_USB;
+	Event.u.create2.vendor = SONY_VENDOR_ID;
+	Event.u.create2.product = Device.Profile.ProductId;
+	Event.u.create2.version = 0x0100;
+	Event.u.create2.country = 0;
+	std::memcpy(Event.u.create2.rd_data, Descriptor.data(), Descriptor.size());
+
+	if (!uhid_write(Device.Fd, Event))
+	{
+		std::perror("[Emulator] UHID_CREATE2");
+		close(Device.Fd);
+		Device.Fd = -1;
+		return false;
+	}
+	return true;
+}
+
+static void destroy_device(emulated_device& Device)
+{
+	if (Device.Fd < 0)
+	{
+		return;
+	}
+
+	uhid_event Event{};
+	Event.type = UHID_DESTROY;
+	uhid_write(Device.Fd, Event);
+	close(Device.Fd);
+	Device.Fd = -1;
+}
+
+static void answer_get_report(emulated_device& Device, const uhid_get_report_req& Request)
+{
+	uhid_event Reply{};
+	Reply.type = UHID_GET_REPORT_REPLY;
+	Reply.u.get_report_reply.id = Request.id;
+	Reply.u.get_report_reply.err = EIO;
+	++Device.FeatureRequests;
+
+	for (const report_decl& Feature : Device.Profile.Features)
+	{
+		if (Feature.Id != Request.rnum)
+		{
+			continue;
+		}
+
+		unsigned char* Data = Reply.u.get_report_reply.data;
+		Data[0] = Feature.Id;
+		const bool bBluetooth = Device.Script.ConnectionType == EDSDeviceConnection::Bluetooth;
+		const bool bCalibration = Feature.Id == 0x05 || (Feature.Id == 0x02 && Device.Script.DeviceType == EDSDeviceType::DualShock4);
+		if (bCalibration)
+		{
+			virtual_device_info::synthesize_calibration(Device.Script.DeviceType, Device.Script.ConnectionType, Data);
+		}
+		else if (Feature.Id == 0x09 || Feature.Id == 0x81 || Feature.Id == 0x12)
+		{
+			// Pairing info: MAC address stored little-endian right after the report ID.
+			const unsigned char Mac[6] = {static_cast<unsigned char>(Device.Index & 0xFF), 0x00, 0x00, 0x5d, 0x5a, 0xa0};
+			std::memcpy(Data + 1, Mac, sizeof(Mac));
+		}
+
+		if (bBluetooth)
+		{
+			virtual_device_info::write_report_crc32(0xA3, Data, Feature.Size);
+		}
+
+		Reply.u.get_report_reply.err = 0;
+		Reply.u.get_report_reply.size = Feature.Size;
+		break;
+	}
+
+	uhid_write(Device.Fd, Reply);
+}
+
+static void record_output(emulated_device& Device, const uhid_output_req& Output, FILE* Log)
+{
+	if (Output.size == 0)
+	{
+		return;
+	}
+
+	const std::uint8_t ReportId = Output.data[0];
+	output_counter& Counter = Device.Outputs[ReportId];
+	++Counter.Count;
+	Counter.Bytes += Output.size;
+
+	// Over Bluetooth only the first declared output report at its declared size carries the
+	// controller state; any other report the host writes is audio-haptic data.
+	const report_decl& StateReport = Device.Profile.Outputs.front();
+	if (Device.Script.ConnectionType == EDSDeviceConnection::Bluetooth && (ReportId != StateReport.Id || Output.size != StateReport.Size))
+	{
+		++Device.AudioReports;
+		Device.AudioBytes += Output.size;
+	}
+
+	if (Log)
+	{
+		// Record layout: u64 monotonic ns, u32 device index, u16 size, payload.
+		const std::uint64_t Now = monotonic_ns();
+		const std::uint32_t Index = Device.Index;
+		const std::uint16_t Size = Output.size;
+		std::fwrite(&Now, sizeof(Now), 1, Log);
+		std::fwrite(&Index, sizeof(Index), 1, Log);
+		std::fwrite(&Size, sizeof(Size), 1, Log);
+		std::fwrite(Output.data, 1, Output.size, Log);
+	}
+}
+
+static void pump_events(emulated_device& Device, FILE* Log)
+{
+	uhid_event Event{};
+	while (read(Device.Fd, &Event, sizeof(Event)) > 0)
+	{
+		switch (Event.type)
+		{
+			case UHID_START:
+				Device.bStarted = true;
+				break;
+			case UHID_STOP:
+				Device.bStarted = false;
+				break;
+			case UHID_OPEN:
+				Device.bOpened = true;
+				break;
+			case UHID_CLOSE:
+				Device.bOpened = false;
+				break;
+			case UHID_OUTPUT:
+				record_output(Device, Event.u.output, Log);
+				break;
+			case UHID_GET_REPORT:
+				answer_get_report(Device, Event.u.get_report);
+				break;
+			case UHID_SET_REPORT:
+			{
+				uhid_event Reply{};
+				Reply.type = UHID_SET_REPORT_REPLY;
+				Reply.u.set_report_reply.id = Event.u.set_report.id;
+				Reply.u.set_report_reply.err = 0;
+				uhid_write(Device.Fd, Reply);
+				break;
+			}
+			default:
+				break;
+		}
+	}
+}
+
+static void send_due_inputs(emulated_device& Device, std::uint64_t Now)
+{
+	if (!Device.bStarted || Now < Device.NextInputNs)
+	{
+		return;
+	}
+
+	// A late wakeup sends only the newest report, exactly like a real pad that missed a poll.
+	if (Now - Device.NextInputNs >= Device.PeriodNs)
+	{
+		const std::uint64_t Missed = (Now - Device.NextInputNs) / Device.PeriodNs;
+		Device.InputsLate += Missed;
+		Device.Sequence += Missed;
+		Device.NextInputNs += Missed * Device.PeriodNs;
+	}
+
+	uhid_event Event{};
+	Event.type = UHID_INPUT2;
+	const std::uint64_t TimestampUs = (Device.NextInputNs - Device.StartNs) / 1000;
+	virtual_device_info::synthesize_report(Device.Script, Device.Sequence, TimestampUs, Event.u.input2.data, sizeof(Event.u.input2.data));
+	Event.u.input2.size = static_cast<std::uint16_t>(virtual_device_info::input_report_length(Device.Script.DeviceType, Device.Script.ConnectionType));
+	if (uhid_write(Device.Fd, Event))
+	{
+		++Device.InputsSent;
+	}
+
+	++Device.Sequence;
+	Device.NextInputNs += Device.PeriodNs;
+}
+
+static void print_statistics(const std::vector<emulated_device>& Devices, double Seconds)
+{
+	for (const emulated_device& Device : Devices)
+	{
+		std::cout << "[Emulator] #" << Device.Index << " " << Device.Profile.Name
+		          << (Device.Script.ConnectionType == EDSDeviceConnection::Bluetooth ? " (BT)" : " (USB)")
+		          << " | in: " << Device.InputsSent << " (" << std::fixed << std::setprecision(1) << (Seconds > 0.0 ? Device.InputsSent / Seconds : 0.0) << "/s, late " << Device.InputsLate << ")"
+		          << " | features: " << Device.FeatureRequests
+		          << " | audio: " << Device.AudioReports << " (" << Device.AudioBytes << " B)";
+		for (const auto& [ReportId, Counter] : Device.Outputs)
+		{
+			std::cout << " | out 0x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(ReportId) << std::dec << std::setfill(' ')
+			          << ": " << Counter.Count << " (" << Counter.Bytes << " B)";
+		}
+		std::cout << std::endl;
+	}
+}
+
+static void print_help()
+{
+	std::cout << "\n=======================================================" << std::endl;
+	std::cout << "        UHID GAMEPAD EMULATOR                          " << std::endl;
+	std::cout << "=======================================================" << std::endl;
+	std::cout << " Usage: uhid-gamepad-emulator [options] <device> [<device> ...]" << std::endl;
+	std::cout << "" << std::endl;
+	std::cout << " <device> uses the GAMEPAD_CORE_VIRTUAL_HID syntax:" << std::endl;
+	std::cout << "   dualsense:usb   edge:bt:rate=500   ds4:usb" << std::endl;
+	std::cout << " Input reports default to 250 Hz (4 ms interval), the stock" << std::endl;
+	std::cout << " rate of both pads on USB and of the full BT report mode." << std::endl;
+	std::cout << "" << std::endl;
+	std::cout << " Options:" << std::endl;
+	std::cout << "   --duration <s>  Stop after <s> seconds (default: until Ctrl+C)" << std::endl;
+	std::cout << "   --log <file>    Append every output report to a binary log" << std::endl;
+	std::cout << "" << std::endl;
+	std::cout << " Needs write access to /dev/uhid (root or a udev rule)." << std::endl;
+	std::cout << "=======================================================" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<emulated_device> Devices;
+	double DurationSeconds = 0.0;
+	std::string LogPath;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view Arg(argv[i]);
+		if (Arg == "--duration" && i + 1 < argc)
+		{
+			DurationSeconds = std::strtod(argv[++i], nullptr);
+		}
+		else if (Arg == "--log" && i + 1 < argc)
+		{
+			LogPath = argv[++i];
+		}
+		else if (Arg == "--help" || Arg == "-h")
+		{
+			print_help();
+			return 0;
+		}
+		else
+		{
+			emulated_device Device;
+			if (!virtual_hid_bus::parse_script(std::string(Arg), Device.Script))
+			{
+				std::cerr << "[Emulator Error] Invalid device spec: " << Arg << std::endl;
+				print_help();
+				return 1;
+			}
+			Device.Index = static_cast<std::uint32_t>(Devices.size());
+			Device.Profile = make_profile(Device.Script.DeviceType, Device.Script.ConnectionType);
+			Device.PeriodNs = 1000000000ull / Device.Script.ReportRateHz;
+			Devices.push_back(std::move(Device));
+		}
+	}
+
+	if (Devices.empty())
+	{
+		virtual_device_script DefaultScript;
+		emulated_device Device;
+		Device.Script = DefaultScript;
+		Device.Profile = make_profile(DefaultScript.DeviceType, DefaultScript.ConnectionType);
+		Device.PeriodNs = 1000000000ull / DefaultScript.ReportRateHz;
+		Devices.push_back(std::move(Device));
+	}
+
+	FILE* Log = nullptr;
+	if (!LogPath.empty())
+	{
+		Log = std::fopen(LogPath.c_str(), "ab");
+		if (!Log)
+		{
+			std::perror("[Emulator] open log");
+			return 1;
+		}
+	}
+
+	std::signal(SIGINT, on_signal);
+	std::signal(SIGTERM, on_signal);
+
+	for (emulated_device& Device : Devices)
+	{
+		if (!create_device(Device))
+		{
+			for (emulated_device& Created : Devices)
+			{
+				destroy_device(Created);
+			}
+			return 1;
+		}
+		std::cout << "[Emulator] Created #" << Device.Index << ": " << Device.Profile.Name << " (PID 0x" << std::hex << Device.Profile.ProductId << std::dec
+		          << ", " << (Device.Script.ConnectionType == EDSDeviceConnection::Bluetooth ? "BT" : "USB") << ", " << Device.Script.ReportRateHz << " Hz)" << std::endl;
+	}
+
+	const std::uint64_t StartNs = monotonic_ns();
+	for (emulated_device& Device : Devices)
+	{
+		Device.StartNs = StartNs;
+		Device.NextInputNs = StartNs;
+	}
+
+	std::vector<pollfd> PollFds(Devices.size());
+	for (std::size_t i = 0; i < Devices.size(); ++i)
+	{
+		PollFds[i].fd = Devices[i].Fd;
+		PollFds[i].events = POLLIN;
+	}
+
+	std::uint64_t NextStatsNs = StartNs + 1000000000ull;
+	while (!GStop.load())
+	{
+		std::uint64_t Now = monotonic_ns();
+		if (DurationSeconds > 0.0 && Now - StartNs >= static_cast<std::uint64_t>(DurationSeconds * 1e9))
+		{
+			break;
+		}
+
+		std::uint64_t WakeNs = NextStatsNs;
+		for (const emulated_device& Device : Devices)
+		{
+			if (Device.bStarted && Device.NextInputNs < WakeNs)
+			{
+				WakeNs = Device.NextInputNs;
+			}
+		}
+
+		timespec Timeout{};
+		if (WakeNs > Now)
+		{
+			Timeout.tv_sec = static_cast<time_t>((WakeNs - Now) / 1000000000ull);
+			Timeout.tv_nsec = static_cast<long>((WakeNs - Now) % 1000000000ull);
+		}
+
+		if (ppoll(PollFds.data(), PollFds.size(), &Timeout, nullptr) > 0)
+		{
+			for (std::size_t i = 0; i < Devices.size(); ++i)
+			{
+				if (PollFds[i].revents & POLLIN)
+				{
+					pump_events(Devices[i], Log);
+				}
+			}
+		}
+
+		Now = monotonic_ns();
+		for (emulated_device& Device : Devices)
+		{
+			send_due_inputs(Device, Now);
+		}
+
+		if (Now >= NextStatsNs)
+		{
+			NextStatsNs += 1000000000ull;
+			print_statistics(Devices, static_cast<double>(Now - StartNs) / 1e9);
+		}
+	}
+
+	std::cout << "\n[Emulator] Final statistics:" << std::endl;
+	print_statistics(Devices, static_cast<double>(monotonic_ns() - StartNs) / 1e9);
+
+	for (emulated_device& Device : Devices)
+	{
+		destroy_device(Device);
+	}
+
+	if (Log)
+	{
+		std::fclose(Log);
+	}
+	return 0;
+}
+#endif